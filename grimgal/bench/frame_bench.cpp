@@ -0,0 +1,192 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Qt
+#include <QColor>
+#include <QImage>
+#include <QLineF>
+#include <QPainter>
+#include <QPen>
+#include <QRect>
+
+// Own
+#include "bench/frame_bench.h"
+#include "data/configuration.h"
+#include "data/event_index.h"
+#include "data/measurement.h"
+#include "render/frame_renderer.h"
+#include "render/tile_loader.h"
+#include <rlib/common/event_data.h>
+
+// StdLib
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+    constexpr int WIDTH = 1920;
+    constexpr int HEIGHT = 1080;
+    constexpr size_t SENSORS = 8;
+    constexpr int REPETITIONS = 9;
+
+    // Median wall time of f in milliseconds
+    double measure(std::function< void() > f)
+    {
+        std::vector< double > times;
+        for (int i = 0; i < REPETITIONS; ++i) {
+            auto begin = std::chrono::steady_clock::now();
+            f();
+            auto end = std::chrono::steady_clock::now();
+            times.push_back(
+                std::chrono::duration< double, std::milli >(end - begin)
+                    .count());
+        }
+        std::sort(times.begin(), times.end());
+        return times[ times.size() / 2 ];
+    }
+
+    // Events spread over the visible time range, a quarter of them global
+    std::vector< rlib::common::event_data > generate_events(
+        const render::View& view, size_t count)
+    {
+        std::mt19937 random(42);
+        std::uniform_real_distribution< double > time(
+            view.xToTime(view.leftWindow()), view.xToTime(view.rightWindow()));
+        std::uniform_int_distribution< int > origin(
+            -1, static_cast< int >(SENSORS) * 3 - 1);
+
+        std::vector< rlib::common::event_data > events(count);
+        for (auto& e : events) {
+            e.time = time(random);
+            e.origin = std::max(-1, origin(random) / 3);
+        }
+        std::sort(events.begin(), events.end(),
+            [](const rlib::common::event_data& a,
+                const rlib::common::event_data& b) { return a.time < b.time; });
+        return events;
+    }
+
+    QPen event_pen(std::shared_ptr< Configuration > configuration,
+        std::shared_ptr< Measurement > m, const rlib::common::event_data& e,
+        qreal penWidth, double& eventTime)
+    {
+        eventTime = e.time;
+        QPen pen(configuration->color[ COLOR_CFG::EVENT ], penWidth);
+        if (e.origin >= 0) {
+            pen.setColor(m->color.at(static_cast< size_t >(e.origin)));
+            eventTime += m->offsetX.at(static_cast< size_t >(e.origin));
+        }
+        return pen;
+    }
+}
+
+void bench::frame_events(std::ostream& out)
+{
+    auto configuration = std::make_shared< Configuration >();
+    auto renderer = std::make_shared< render::FrameRenderer >(
+        std::make_shared< render::TileLoader >());
+    renderer->setConfiguration(configuration);
+
+    render::View view;
+    {
+        view.size = QSize(WIDTH, HEIGHT);
+        view.center = QPointF(WIDTH / 2, 0.0);
+    }
+    renderer->setView(view);
+
+    auto m = std::make_shared< Measurement >();
+    for (size_t i = 0; i < SENSORS; ++i) {
+        m->color.push_back(
+            QColor::fromHsv(static_cast< int >(i * 45), 255, 255));
+        m->offsetX.push_back(0.0);
+    }
+
+    QImage image(WIDTH, HEIGHT, QImage::Format_ARGB32_Premultiplied);
+    auto penWidth = view.penWidth();
+
+    out << "# frame time [ms] against event count (" << WIDTH << "x" << HEIGHT
+        << ", median of " << REPETITIONS << ")\n";
+    out << std::setw(10) << "events" << std::setw(20) << "painter_per_event"
+        << std::setw(16) << "pen_per_event" << std::setw(12) << "batched"
+        << std::setw(12) << "indexed" << "\n";
+
+    for (size_t count : std::vector< size_t >{ 100, 1000, 10000, 100000 }) {
+        auto events = generate_events(view, count);
+
+        // Before: a fresh, configured painter per event
+        auto painterPerEvent = measure([&]() {
+            image.fill(Qt::black);
+            for (auto& e : events) {
+                QPainter painter(&image);
+                renderer->configure(painter);
+                double eventTime = 0.0;
+                painter.setPen(
+                    event_pen(configuration, m, e, penWidth, eventTime));
+                auto xpos = view.timeToX(eventTime);
+                painter.drawLine(QLineF(
+                    xpos, view.upperBound(), xpos, view.lowerBound()));
+            }
+        });
+
+        // Shared painter, but still a pen change and draw call per event
+        auto penPerEvent = measure([&]() {
+            image.fill(Qt::black);
+            QPainter painter(&image);
+            renderer->configure(painter);
+            for (auto& e : events) {
+                double eventTime = 0.0;
+                painter.setPen(
+                    event_pen(configuration, m, e, penWidth, eventTime));
+                auto xpos = view.timeToX(eventTime);
+                painter.drawLine(QLineF(
+                    xpos, view.upperBound(), xpos, view.lowerBound()));
+            }
+        });
+
+        // After: one drawLines() per color
+        auto batched = measure([&]() {
+            image.fill(Qt::black);
+            QPainter painter(&image);
+            renderer->configure(painter);
+            renderer->drawEvents(painter, m, events);
+        });
+
+        // Now: one marker per pixel column from the event index
+        m->events = std::make_shared< EventIndex >(events);
+        auto indexed = measure([&]() {
+            image.fill(Qt::black);
+            QPainter painter(&image);
+            renderer->configure(painter);
+            renderer->drawEvents(painter, m, QRect(0, 0, WIDTH, HEIGHT));
+        });
+
+        out << std::fixed << std::setprecision(3) << std::setw(10) << count
+            << std::setw(20) << painterPerEvent << std::setw(16) << penPerEvent
+            << std::setw(12) << batched << std::setw(12) << indexed << "\n";
+    }
+}
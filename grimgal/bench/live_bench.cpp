@@ -0,0 +1,86 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Qt
+
+// Own
+#include "bench/live_bench.h"
+#include "data/live_reader.h"
+#include "data/loopback_reader.h"
+#include "data/sample_pyramid.h"
+
+// StdLib
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+    constexpr size_t SENSORS = 8;
+    constexpr auto DURATION = std::chrono::seconds(2);
+    // Interval at which the latency is probed, like the GUI polls
+    constexpr auto PROBE_INTERVAL = std::chrono::milliseconds(5);
+}
+
+void bench::live_stream(std::ostream& out)
+{
+    out << "# live ingest of " << SENSORS << " sensors from the loopback ("
+        << DURATION.count() << " s each), latency from sample availability "
+        << "to the ring [ms]\n";
+    out << std::setw(10) << "rate" << std::setw(16) << "samples_per_s"
+        << std::setw(12) << "behind" << std::setw(12) << "latency_p50"
+        << std::setw(12) << "latency_max" << "\n";
+
+    for (double rate : std::vector< double >{ 1e3, 1e4, 1e5, 1e6 }) {
+        auto source = std::make_shared< LoopbackReader >(
+            "bench.loopback", SENSORS, rate);
+        auto live = std::make_shared< LiveReader >(source);
+        auto pyramid = SamplePyramid::live(live);
+        live->start(pyramid);
+
+        std::vector< double > latency;
+        auto begin = std::chrono::steady_clock::now();
+        while (std::chrono::steady_clock::now() - begin < DURATION) {
+            std::this_thread::sleep_for(PROBE_INTERVAL);
+            auto newest = live->newest();
+            if (newest) {
+                latency.push_back((source->elapsed() - *newest) * 1000.0);
+            }
+        }
+        auto elapsed = source->elapsed();
+        auto received = live->revision();
+        // Samples available at the source but not yet in the ring
+        auto behind = std::max(0.0, elapsed * rate - double(received));
+
+        std::sort(latency.begin(), latency.end());
+        auto median = latency.empty() ? 0.0 : latency[ latency.size() / 2 ];
+        auto worst = latency.empty() ? 0.0 : latency.back();
+        out << std::fixed << std::setprecision(3) << std::setw(10) << rate
+            << std::setw(16) << double(received) / elapsed << std::setw(12)
+            << behind << std::setw(12) << median << std::setw(12) << worst
+            << "\n";
+    }
+}
@@ -0,0 +1,131 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Qt
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QGuiApplication>
+#include <QJsonDocument>
+#include <QStringList>
+
+// Own
+#include "bench/frame_bench.h"
+#include "bench/live_bench.h"
+#include "bench/trace_bench.h"
+#include "bench/transform_bench.h"
+
+// StdLib
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace {
+    // Comma separated list of numbers, scientific notation (1e6) allowed
+    template < typename T >
+    std::vector< T > numbers(const QString& list)
+    {
+        std::vector< T > result;
+        for (auto& item : list.split(',', QString::SkipEmptyParts)) {
+            bool ok = false;
+            auto value = item.trimmed().toDouble(&ok);
+            if (ok && value > 0.0) {
+                result.push_back(static_cast< T >(value));
+            }
+        }
+        return result;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    // Fonts and the raster paint engine need a gui application
+    QGuiApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Grimgal benchmarks");
+    parser.addHelpOption();
+    parser.addPositionalArgument("bench",
+        "Benchmarks to run: events, live, transform, traces (default: all)",
+        "[bench...]");
+    QCommandLineOption jsonOption("json",
+        "Write the results of the trace benchmark to <file>.", "file",
+        "grimgal_bench.json");
+    QCommandLineOption labelOption(
+        "label", "Label stored with the results, e.g. the commit.", "label");
+    QCommandLineOption samplesOption("samples",
+        "Samples per sensor of the traces, comma separated.", "list");
+    QCommandLineOption sensorsOption(
+        "sensors", "Sensors of the traces, comma separated.", "list");
+    QCommandLineOption maxValuesOption("max-values",
+        "Skip traces with more samples times sensors.", "count");
+    QCommandLineOption directoryOption("directory",
+        "Where the traces are written (default: temporary).", "path");
+    parser.addOptions({ jsonOption, labelOption, samplesOption,
+        sensorsOption, maxValuesOption, directoryOption });
+    parser.process(app);
+
+    auto benches = parser.positionalArguments();
+    auto selected = [&benches](const QString& name) {
+        return benches.isEmpty() || benches.contains(name);
+    };
+
+    if (selected("events")) {
+        bench::frame_events(std::cout);
+    }
+    if (selected("live")) {
+        bench::live_stream(std::cout);
+    }
+    if (selected("transform")) {
+        bench::transform_columns(std::cout);
+    }
+    if (selected("traces")) {
+        bench::TraceOptions options;
+        if (parser.isSet(samplesOption)) {
+            options.samples =
+                numbers< uint64_t >(parser.value(samplesOption));
+        }
+        if (parser.isSet(sensorsOption)) {
+            options.sensors = numbers< size_t >(parser.value(sensorsOption));
+        }
+        if (parser.isSet(maxValuesOption)) {
+            auto maxValues =
+                numbers< uint64_t >(parser.value(maxValuesOption));
+            if (!maxValues.empty()) {
+                options.max_values = maxValues.front();
+            }
+        }
+        options.directory = parser.value(directoryOption);
+        options.label = parser.value(labelOption);
+
+        auto results = bench::traces(options, std::cout);
+        auto path = parser.value(jsonOption);
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly) ||
+            file.write(QJsonDocument(results).toJson()) < 0) {
+            std::cerr << "Can not write " << path.toStdString() << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
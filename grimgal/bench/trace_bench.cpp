@@ -0,0 +1,552 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Qt
+#include <QEventLoop>
+#include <QFile>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QModelIndex>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLFunctions>
+#include <QOpenGLPaintDevice>
+#include <QPainter>
+#include <QRect>
+#include <QSize>
+#include <QTemporaryDir>
+#include <QTimer>
+#include <QVariant>
+
+// Own
+#include "bench/trace_bench.h"
+#include "data/configuration.h"
+#include "data/event_index.h"
+#include "data/grimcache.h"
+#include "data/measurement.h"
+#include "data/probe.h"
+#include "data/project.h"
+#include "data/sample_block.h"
+#include "data/sample_pyramid.h"
+#include "model/probetablemodel.h"
+#include "model/statistictablemodel.h"
+#include "render/frame_renderer.h"
+#include "render/gl_trace_renderer.h"
+#include "render/tile_loader.h"
+#include <rlib/common/reader.h>
+
+// StdLib
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    constexpr int WIDTH = 1920;
+    constexpr int HEIGHT = 1080;
+    constexpr int REPETITIONS = 9;
+    // Sampling rate of the generated traces
+    constexpr double RATE = 1000.0;
+    // One event every EVENT_INTERVAL samples
+    constexpr uint64_t EVENT_INTERVAL = 10000;
+    constexpr size_t PROBES = 16;
+    // Tile requests per zoom level
+    constexpr int TILE_REQUESTS = 9;
+    // Milliseconds a table may take to compute all of its cells
+    constexpr int FILL_TIMEOUT = 600000;
+
+    // Trace computed on request, so even 10^9 samples take no memory. Like a
+    // file reader it hands out rlib samples, i.e. the reader wrapping is
+    // part of every measurement.
+    class SyntheticReader : public rlib::common::reader {
+        private:
+        std::string _filename;
+        uint64_t _samples;
+        size_t _sensors;
+
+        double value(size_t sensor, uint64_t index) const
+        {
+            // Sine per sensor plus some hashed noise, so min, max and mean
+            // of a bucket all differ
+            auto noise = (index * 2654435761u + sensor * 40503u) % 1024;
+            return std::sin(double(index) * 0.001 * double(sensor + 1)) +
+                   double(noise) / 10240.0;
+        }
+
+        rlib::common::sample at(uint64_t index) const
+        {
+            rlib::common::sample result;
+            result.time = double(index) / RATE;
+            result.values.resize(this->_sensors);
+            for (size_t s = 0; s < this->_sensors; ++s) {
+                result.values[ s ] = this->value(s, index);
+            }
+            return result;
+        }
+
+        public:
+        SyntheticReader(std::string filename, uint64_t samples, size_t sensors)
+            : _filename(filename)
+            , _samples(samples)
+            , _sensors(sensors)
+        {
+        }
+
+        virtual std::string filename() override
+        {
+            return this->_filename;
+        }
+
+        virtual std::vector< rlib::common::sensor > sensors() override
+        {
+            std::vector< rlib::common::sensor > result(this->_sensors);
+            for (size_t s = 0; s < this->_sensors; ++s) {
+                result[ s ].name = "Sensor " + std::to_string(s);
+                result[ s ].unit = "V";
+                result[ s ].sampling_interval = 1.0 / RATE;
+            }
+            return result;
+        }
+
+        virtual std::vector< rlib::common::sample > samples(
+            double begin, double end, int_fast32_t resolution) override
+        {
+            std::vector< rlib::common::sample > result;
+            if (end < 0.0 || begin > end) {
+                return result;
+            }
+            auto first = static_cast< uint64_t >(
+                std::ceil(std::max(begin, 0.0) * RATE));
+            auto last = std::min(this->_samples,
+                static_cast< uint64_t >(std::floor(end * RATE)) + 1);
+            for (auto index = first; index < last; ++index) {
+                result.push_back(this->at(index));
+            }
+            return result;
+        }
+
+        virtual rlib::common::sample sample(
+            double time, int_fast32_t resolution) override
+        {
+            auto index = static_cast< uint64_t >(
+                std::floor(std::max(time, 0.0) * RATE));
+            return this->at(std::min(index, this->_samples - 1));
+        }
+
+        virtual std::vector< rlib::common::event_data > events(
+            double begin, double end) override
+        {
+            // An end before the begin asks for all events
+            if (end < begin) {
+                begin = 0.0;
+                end = double(this->_samples) / RATE;
+            }
+            std::vector< rlib::common::event_data > result;
+            auto first = static_cast< uint64_t >(
+                std::ceil(std::max(begin, 0.0) * RATE / EVENT_INTERVAL));
+            for (auto k = first; k * EVENT_INTERVAL < this->_samples; ++k) {
+                auto time = double(k * EVENT_INTERVAL) / RATE;
+                if (time > end) {
+                    break;
+                }
+                rlib::common::event_data event;
+                event.time = time;
+                event.origin = static_cast< int >(k % this->_sensors);
+                event.event_level = rlib::common::event_data_level::DEBUG;
+                event.message = "Event " + std::to_string(k);
+                result.push_back(event);
+            }
+            return result;
+        }
+
+        virtual std::vector< std::experimental::optional< double > >
+            statistic(rlib::common::statistic_data data) override
+        {
+            return std::vector< std::experimental::optional< double > >(
+                this->_sensors);
+        }
+    };
+
+    double milliseconds(std::chrono::steady_clock::time_point begin)
+    {
+        return std::chrono::duration< double, std::milli >(
+            std::chrono::steady_clock::now() - begin)
+            .count();
+    }
+
+    // Wall time of f in milliseconds
+    double once(std::function< void() > f)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        f();
+        return milliseconds(begin);
+    }
+
+    // Median wall time of f in milliseconds
+    double measure(std::function< void() > f)
+    {
+        std::vector< double > times;
+        for (int i = 0; i < REPETITIONS; ++i) {
+            times.push_back(once(f));
+        }
+        std::sort(times.begin(), times.end());
+        return times[ times.size() / 2 ];
+    }
+
+    // Cells of the model which are still being computed ("...")
+    int pending(const QAbstractItemModel& model)
+    {
+        int count = 0;
+        for (int r = 0; r < model.rowCount(); ++r) {
+            for (int c = 0; c < model.columnCount(); ++c) {
+                if (model.data(model.index(r, c), Qt::DisplayRole) ==
+                    QVariant("...")) {
+                    ++count;
+                }
+            }
+        }
+        return count;
+    }
+
+    // Reads every cell of the model, as a view showing all of it would, and
+    // waits until the workers of the model delivered all of them. Sets
+    // left to the cells still pending after FILL_TIMEOUT.
+    double fill(const QAbstractItemModel& model, int& left)
+    {
+        return once([&model, &left]() {
+            QEventLoop loop;
+            // Results arrive through the event loop, as dataChanged()
+            QObject::connect(&model, &QAbstractItemModel::dataChanged, &loop,
+                &QEventLoop::quit);
+            QTimer timeout;
+            timeout.setSingleShot(true);
+            QObject::connect(
+                &timeout, &QTimer::timeout, &loop, &QEventLoop::quit);
+            timeout.start(FILL_TIMEOUT);
+            while ((left = pending(model)) > 0 && timeout.isActive()) {
+                loop.exec();
+            }
+        });
+    }
+
+    // Pixels whose channels differ by more than this count as differing,
+    // covers the rounding of the blending
+    constexpr int PIXEL_TOLERANCE = 8;
+
+    // Share of the pixels of a and b which differ
+    double differing(const QImage& a, const QImage& b)
+    {
+        auto left = a.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+        auto right = b.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+        if (left.size() != right.size()) {
+            return 1.0;
+        }
+        uint64_t count = 0;
+        for (int y = 0; y < left.height(); ++y) {
+            auto l = reinterpret_cast< const QRgb* >(left.constScanLine(y));
+            auto r = reinterpret_cast< const QRgb* >(right.constScanLine(y));
+            for (int x = 0; x < left.width(); ++x) {
+                if (std::abs(qRed(l[ x ]) - qRed(r[ x ])) > PIXEL_TOLERANCE ||
+                    std::abs(qGreen(l[ x ]) - qGreen(r[ x ])) >
+                        PIXEL_TOLERANCE ||
+                    std::abs(qBlue(l[ x ]) - qBlue(r[ x ])) >
+                        PIXEL_TOLERANCE) {
+                    ++count;
+                }
+            }
+        }
+        return double(count) / double(left.width() * left.height());
+    }
+
+    // Offscreen paint of the layer with the solid traces drawn by the
+    // GlTraceRenderer, as the widget does. Sets ms and image, returns false
+    // if no OpenGL context is available (e.g. no display).
+    bool gl_paint(render::FrameRenderer& renderer, const Project& project,
+        const QRect& area, double& ms, QImage& image)
+    {
+        QOffscreenSurface surface;
+        surface.create();
+        QOpenGLContext context;
+        if (!surface.isValid() || !context.create() ||
+            !context.makeCurrent(&surface)) {
+            return false;
+        }
+
+        bool valid = false;
+        {
+            QOpenGLFramebufferObject fbo(area.size());
+            render::GlTraceRenderer gl;
+            valid = fbo.isValid() && gl.initialize();
+            if (valid) {
+                fbo.bind();
+                QOpenGLPaintDevice device(area.size());
+                renderer.setDrawSolidTraces(false);
+                ms = measure([&]() {
+                    QPainter painter(&device);
+                    renderer.drawLayer(painter, area);
+                    painter.beginNativePainting();
+                    gl.draw(renderer, project, 1.0);
+                    painter.endNativePainting();
+                    painter.end();
+                    context.functions()->glFinish();
+                });
+                renderer.setDrawSolidTraces(true);
+                image = fbo.toImage();
+                fbo.release();
+            }
+        }
+        context.doneCurrent();
+        return valid;
+    }
+
+    // View showing the whole trace
+    render::View whole_view(double duration)
+    {
+        render::View view;
+        view.size = QSize(WIDTH, HEIGHT);
+        view.time_per_square = duration * view.square.x() / double(WIDTH);
+        view.center = QPointF(view.timeToX(duration / 2.0), 0.0);
+        return view;
+    }
+
+    QJsonObject trace(const QString& directory, uint64_t samples,
+        size_t sensors, std::ostream& out)
+    {
+        QJsonObject result;
+        result[ "samples" ] = double(samples);
+        result[ "sensors" ] = double(sensors);
+        auto duration = double(samples) / RATE;
+
+        // The sidecar is only valid next to a source file, its content does
+        // not matter to the synthetic reader
+        auto path = QString("%1/trace_%2x%3.synthetic")
+                        .arg(directory)
+                        .arg(samples)
+                        .arg(sensors);
+        {
+            QFile file(path);
+            file.open(QIODevice::WriteOnly);
+            file.write(QString("%1 %2\n").arg(samples).arg(sensors).toUtf8());
+        }
+        auto synthetic = std::make_shared< SyntheticReader >(
+            path.toStdString(), samples, sensors);
+
+        // First open: pyramid and statistics in one pass, written to the
+        // sidecar on the way
+        std::shared_ptr< SamplePyramid > pyramid;
+        result[ "open_ms" ] = once([&]() {
+            pyramid = std::make_shared< SamplePyramid >(
+                synthetic, grimcache::Writer::create(path, synthetic));
+            while (pyramid->building()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+
+        // Later opens: mapped sidecar
+        std::shared_ptr< rlib::common::reader > reader = synthetic;
+        std::shared_ptr< grimcache::Reader > cache;
+        result[ "reopen_ms" ] = once([&]() {
+            cache = grimcache::Reader::open(path);
+            if (cache) {
+                pyramid = std::make_shared< SamplePyramid >(
+                    cache, cache->levels(), cache->statistics());
+            }
+        });
+        result[ "sidecar" ] = bool(cache);
+        if (cache) {
+            reader = cache;
+        }
+
+        auto m = std::make_shared< Measurement >();
+        m->setReader(reader, pyramid);
+        auto project = std::make_shared< Project >();
+        project->measurements.push_back(m);
+
+        // Tile requests per zoom level, from raw samples to the coarsest
+        // resolution whose tile still covers less than the whole trace
+        QJsonArray zoom;
+        std::vector< size_t > channels(sensors);
+        for (size_t s = 0; s < sensors; ++s) {
+            channels[ s ] = s;
+        }
+        for (auto resolution = static_cast< int_fast32_t >(RATE);
+             resolution > 0 &&
+             render::TileLoader::tileDuration(resolution) < duration;
+             resolution /= 4) {
+            auto tileDuration = render::TileLoader::tileDuration(resolution);
+            auto tiles = static_cast< int64_t >(duration / tileDuration);
+            int request = 0;
+            auto ms = measure([&]() {
+                // Spread over the trace, so no request hits a warm chunk
+                auto index = tiles * (request++ % TILE_REQUESTS) /
+                             TILE_REQUESTS;
+                auto begin = double(index) * tileDuration;
+                auto data = pyramid->samples(
+                    begin, begin + tileDuration, resolution, channels);
+                if (!data) {
+                    data = readSamples(*reader, begin, begin + tileDuration,
+                        resolution, channels);
+                }
+            });
+            QJsonObject level;
+            level[ "resolution" ] = double(resolution);
+            level[ "ms" ] = ms;
+            zoom.append(level);
+        }
+        result[ "tile_ms" ] = zoom;
+
+        // Offscreen paint of the whole trace, first until every tile is
+        // resident, then with all tiles cached
+        auto configuration = std::make_shared< Configuration >();
+        auto renderer = std::make_shared< render::FrameRenderer >(
+            std::make_shared< render::TileLoader >());
+        renderer->setConfiguration(configuration);
+        renderer->setProject(project);
+        auto view = whole_view(duration);
+        renderer->setView(view);
+        QRect area(0, 0, WIDTH, HEIGHT);
+        result[ "paint_cold_ms" ] = once([&]() {
+            for (bool missing = true; missing;) {
+                int64_t firstTile = 0;
+                auto tiles = renderer->tiles(m, area, firstTile);
+                missing = std::find(tiles.begin(), tiles.end(), nullptr) !=
+                          tiles.end();
+                if (missing) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+        });
+        QImage image(WIDTH, HEIGHT, QImage::Format_ARGB32_Premultiplied);
+        result[ "paint_ms" ] = measure([&]() {
+            QPainter painter(&image);
+            renderer->drawLayer(painter, area);
+        });
+
+        // Same paint with the OpenGL traces, compared against the QPainter
+        // image. Null if there is no OpenGL context.
+        double glMs = 0.0;
+        QImage glImage;
+        if (gl_paint(*renderer, *project, area, glMs, glImage)) {
+            result[ "gl_paint_ms" ] = glMs;
+            result[ "gl_differing" ] = differing(image, glImage);
+        }
+        else {
+            result[ "gl_paint_ms" ] = QJsonValue();
+            result[ "gl_differing" ] = QJsonValue();
+        }
+
+        // Probe table, every probe against every sensor
+        for (size_t p = 0; p < PROBES; ++p) {
+            auto probe = std::make_shared< Probe >();
+            probe->time = duration * (double(p) + 0.5) / double(PROBES);
+            project->probes.push_back(probe);
+        }
+        {
+            ProbeTableModel model(configuration, project);
+            model.setResolution(view.drawResolution());
+            int left = 0;
+            result[ "probe_table_ms" ] = fill(model, left);
+            result[ "probe_table_pending" ] = left;
+        }
+
+        // Statistics table, whole file figures and the range between the
+        // first and the last probe
+        {
+            StatisticTableModel model(configuration, project);
+            model.setWindow(0.0, duration);
+            int left = 0;
+            result[ "statistics_ms" ] = fill(model, left);
+            result[ "statistics_pending" ] = left;
+        }
+
+        out << std::fixed << std::setprecision(3) << std::setw(12) << samples
+            << std::setw(8) << sensors << std::setw(12)
+            << result[ "open_ms" ].toDouble() << std::setw(12)
+            << result[ "reopen_ms" ].toDouble() << std::setw(12)
+            << result[ "paint_cold_ms" ].toDouble() << std::setw(12)
+            << result[ "paint_ms" ].toDouble() << std::setw(12);
+        if (result[ "gl_paint_ms" ].isNull()) {
+            out << "n/a" << std::setw(12) << "n/a";
+        }
+        else {
+            out << result[ "gl_paint_ms" ].toDouble() << std::setw(12)
+                << result[ "gl_differing" ].toDouble();
+        }
+        out << std::setw(12) << result[ "probe_table_ms" ].toDouble()
+            << std::setw(12) << result[ "statistics_ms" ].toDouble() << "\n";
+        auto left = result[ "probe_table_pending" ].toInt() +
+                    result[ "statistics_pending" ].toInt();
+        if (left > 0) {
+            out << "# " << left << " table cells still pending\n";
+        }
+
+        QFile::remove(path);
+        for (auto& sidecar : grimcache::sidecarPaths(path)) {
+            QFile::remove(sidecar);
+        }
+        return result;
+    }
+}
+
+QJsonObject bench::traces(const TraceOptions& options, std::ostream& out)
+{
+    QTemporaryDir temporary;
+    auto directory =
+        options.directory.isEmpty() ? temporary.path() : options.directory;
+
+    out << "# synthetic traces at " << RATE << " Hz, times in ms ("
+        << WIDTH << "x" << HEIGHT << ", median of " << REPETITIONS << ")\n";
+    out << std::setw(12) << "samples" << std::setw(8) << "sensors"
+        << std::setw(12) << "open" << std::setw(12) << "reopen"
+        << std::setw(12) << "paint_cold" << std::setw(12) << "paint"
+        << std::setw(12) << "gl_paint" << std::setw(12) << "gl_differing"
+        << std::setw(12) << "probe_table" << std::setw(12) << "statistics"
+        << "\n";
+
+    QJsonArray traces;
+    for (auto samples : options.samples) {
+        for (auto sensors : options.sensors) {
+            if (samples == 0 || sensors == 0 ||
+                samples * sensors > options.max_values) {
+                continue;
+            }
+            traces.append(trace(directory, samples, sensors, out));
+        }
+    }
+
+    QJsonObject result;
+    result[ "label" ] = options.label;
+    result[ "rate" ] = RATE;
+    result[ "width" ] = WIDTH;
+    result[ "height" ] = HEIGHT;
+    result[ "traces" ] = traces;
+    return result;
+}
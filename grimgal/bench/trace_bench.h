@@ -0,0 +1,61 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#ifndef BENCH_TRACEBENCH_H
+#define BENCH_TRACEBENCH_H
+
+// Qt
+#include <QJsonObject>
+#include <QString>
+
+// StdLib
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace bench {
+    struct TraceOptions {
+        // Samples per sensor and number of sensors of the generated traces,
+        // every combination is measured
+        std::vector< uint64_t > samples = { 10000, 100000, 1000000, 10000000 };
+        std::vector< size_t > sensors = { 1, 16, 256 };
+        // Combinations with more values (samples times sensors) are skipped,
+        // their sidecars would not fit a regular run
+        uint64_t max_values = 10000000;
+        // Where the traces and their sidecars are written, a temporary
+        // directory if empty
+        QString directory;
+        // Stored with the results, e.g. the commit
+        QString label;
+    };
+
+    // Generates synthetic traces and measures the stages a file goes
+    // through: first open (pyramid build and sidecar), reopen from the
+    // sidecar, tile requests per zoom level, probe table fill, statistics
+    // table fill and offscreen paint, the latter also with the OpenGL
+    // traces and compared against the QPainter image. A summary is written
+    // to out, the returned document holds all figures.
+    QJsonObject traces(const TraceOptions& options, std::ostream& out);
+}
+
+#endif // BENCH_TRACEBENCH_H
@@ -0,0 +1,147 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Qt
+#include <QPointF>
+#include <QVector>
+
+// Own
+#include "bench/transform_bench.h"
+#include "util/transform.h"
+
+// StdLib
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+    // Rows transformed per measurement, repeated on smaller columns
+    constexpr size_t ROWS_PER_RUN = 1 << 24;
+    constexpr int RUNS = 5;
+
+    typedef size_t (*Kernel)(const util::ColumnTransform&, const double*,
+        const double*, size_t, QPointF*);
+
+    // The loop FrameRenderer used before, one push_back per point
+    size_t appending(const util::ColumnTransform& transform,
+        const double* time, const double* values, size_t rows, QPointF*)
+    {
+        static QVector< QPointF > polyline;
+        polyline.clear();
+        for (size_t r = 0; r < rows; ++r) {
+            if (std::isnan(values[ r ])) {
+                continue;
+            }
+            double x = (time[ r ] + transform.offsetX) * transform.xScale;
+            double y =
+                (values[ r ] * transform.unitFactor + transform.offsetY) *
+                transform.yScale;
+            polyline.push_back(QPointF(x, y));
+        }
+        return static_cast< size_t >(polyline.size());
+    }
+
+    // Rows per second of the fastest run
+    double throughput(Kernel kernel, const util::ColumnTransform& transform,
+        const std::vector< double >& time, const std::vector< double >& values,
+        std::vector< QPointF >& points)
+    {
+        auto repeat = std::max< size_t >(1, ROWS_PER_RUN / time.size());
+        double best = std::numeric_limits< double >::infinity();
+        for (int run = 0; run < RUNS; ++run) {
+            auto begin = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < repeat; ++i) {
+                kernel(transform, time.data(), values.data(), time.size(),
+                    points.data());
+            }
+            std::chrono::duration< double > elapsed =
+                std::chrono::steady_clock::now() - begin;
+            best = std::min(best, elapsed.count());
+        }
+        return double(repeat * time.size()) / best;
+    }
+}
+
+void bench::transform_columns(std::ostream& out)
+{
+    out << "# column transform, kernel " << util::transform_kernel()
+        << " against the scalar loop and the former per point push_back "
+        << "[million rows/s]\n";
+    out << std::setw(10) << "rows" << std::setw(8) << "gaps" << std::setw(12)
+        << "push_back" << std::setw(12) << "scalar" << std::setw(12)
+        << "kernel" << std::setw(10) << "speedup" << std::setw(12)
+        << "max_error" << "\n";
+
+    // Scale of a typical view, offsets like a shifted sensor
+    util::ColumnTransform transform{ 12.5, 128.0, 1000.0, -3.25, 0.015625 };
+    std::mt19937 generator(1);
+    std::normal_distribution< double > noise(0.0, 1.0);
+    std::uniform_real_distribution< double > chance(0.0, 1.0);
+
+    for (size_t rows : std::vector< size_t >{ 1024, 65536, 1 << 20 }) {
+        for (double gaps : std::vector< double >{ 0.0, 0.01 }) {
+            std::vector< double > time(rows);
+            std::vector< double > values(rows);
+            for (size_t r = 0; r < rows; ++r) {
+                time[ r ] = double(r) * 1e-4;
+                values[ r ] = chance(generator) < gaps
+                                  ? std::numeric_limits< double >::quiet_NaN()
+                                  : noise(generator);
+            }
+
+            // Both must produce the same points
+            std::vector< QPointF > expected(rows);
+            std::vector< QPointF > points(rows);
+            auto expectedCount = util::transform_columns_scalar(transform,
+                time.data(), values.data(), rows, expected.data());
+            auto count = util::transform_columns(
+                transform, time.data(), values.data(), rows, points.data());
+            double error = count == expectedCount
+                               ? 0.0
+                               : std::numeric_limits< double >::infinity();
+            for (size_t i = 0; i < std::min(count, expectedCount); ++i) {
+                error = std::max(error,
+                    std::max(std::abs(points[ i ].x() - expected[ i ].x()),
+                        std::abs(points[ i ].y() - expected[ i ].y())));
+            }
+
+            auto previous =
+                throughput(appending, transform, time, values, points);
+            auto scalar = throughput(util::transform_columns_scalar,
+                transform, time, values, points);
+            auto kernel = throughput(
+                util::transform_columns, transform, time, values, points);
+            out << std::fixed << std::setprecision(2) << std::setw(10)
+                << rows << std::setw(8) << gaps << std::setw(12)
+                << previous / 1e6 << std::setw(12) << scalar / 1e6
+                << std::setw(12) << kernel / 1e6 << std::setw(10)
+                << kernel / scalar << std::setw(12) << std::scientific
+                << std::setprecision(1) << error << "\n";
+        }
+    }
+}
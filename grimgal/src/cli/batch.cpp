@@ -0,0 +1,391 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Qt
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QSize>
+
+// Own
+#include "cli/batch.h"
+#include "cli/batch_render.h"
+#include "cli/batch_statistics.h"
+#include "data/live_reader.h"
+#include "data/reader_registry.h"
+#include "data/sample_exporter.h"
+
+// StdLib
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <experimental/optional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace {
+    double since(std::chrono::steady_clock::time_point begin)
+    {
+        return std::chrono::duration< double >(
+            std::chrono::steady_clock::now() - begin)
+            .count();
+    }
+
+    bool write(const QString& path, const QJsonObject& document)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly) ||
+            file.write(QJsonDocument(document).toJson()) < 0) {
+            std::cerr << QObject::tr("Could not write ").toStdString()
+                      << path.toStdString() << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    int writeStatistics(const ReaderRegistry& registry,
+        const QStringList& files, bool useSidecarCache, const QString& path)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        auto results = cli::statistics(registry, files, useSidecarCache);
+        auto seconds = since(begin);
+
+        int failed = 0;
+        uint64_t samples = 0;
+        QJsonArray entries;
+        for (auto& result : results) {
+            if (!result.error.isEmpty()) {
+                ++failed;
+                std::cerr << QObject::tr("Could not load file ").toStdString()
+                          << result.filename.toStdString()
+                          << QObject::tr(" Reason: ").toStdString()
+                          << result.error.toStdString() << std::endl;
+            }
+            samples += result.samples();
+            entries.append(result.toJson());
+        }
+
+        QJsonObject document;
+        document[ "files" ] = entries;
+        document[ "seconds" ] = seconds;
+        document[ "files_per_second" ] = double(results.size()) / seconds;
+        document[ "samples_per_second" ] = double(samples) / seconds;
+        if (!write(path, document)) {
+            return 1;
+        }
+
+        std::cout << results.size() << QObject::tr(" files, ").toStdString()
+                  << samples << QObject::tr(" samples in ").toStdString()
+                  << seconds << " s: " << double(results.size()) / seconds
+                  << QObject::tr(" files/s, ").toStdString()
+                  << double(samples) / seconds
+                  << QObject::tr(" samples/s").toStdString() << std::endl;
+        return failed == 0 ? 0 : 1;
+    }
+
+    // "begin:end" in seconds
+    bool parseRange(const QString& text, std::pair< double, double >& range)
+    {
+        auto parts = text.split(':');
+        bool beginOk = false;
+        bool endOk = false;
+        if (parts.size() == 2) {
+            range.first = parts[ 0 ].toDouble(&beginOk);
+            range.second = parts[ 1 ].toDouble(&endOk);
+        }
+        return beginOk && endOk && range.first < range.second;
+    }
+
+    // "WIDTHxHEIGHT" in pixel
+    bool parseSize(const QString& text, QSize& size)
+    {
+        auto match = QRegularExpression("^(\\d+)x(\\d+)$").match(text);
+        if (!match.hasMatch()) {
+            return false;
+        }
+        size = QSize(match.captured(1).toInt(), match.captured(2).toInt());
+        return !size.isEmpty();
+    }
+
+    // "0,2,3"
+    bool parseSensors(const QString& text, std::vector< size_t >& sensors)
+    {
+        for (auto& part : text.split(',')) {
+            bool ok = false;
+            auto sensor = part.toUInt(&ok);
+            if (!ok) {
+                return false;
+            }
+            sensors.push_back(sensor);
+        }
+        return true;
+    }
+
+    // One file per measurement and range, named like the images
+    int writeExports(const ReaderRegistry& registry, const QStringList& files,
+        bool useSidecarCache, const QString& directory,
+        const QStringList& ranges, const QString& sensors,
+        const QString& format)
+    {
+        SampleExporter::Options options;
+        if (!sensors.isEmpty() && !parseSensors(sensors, options.sensors)) {
+            std::cerr << QObject::tr("Invalid sensors ").toStdString()
+                      << sensors.toStdString() << std::endl;
+            return 2;
+        }
+        if (format != "csv" && format != "bin") {
+            std::cerr << QObject::tr("Invalid format ").toStdString()
+                      << format.toStdString() << std::endl;
+            return 2;
+        }
+        options.format = format == "csv" ? SampleExporter::FORMAT::CSV
+                                         : SampleExporter::FORMAT::BINARY;
+        std::vector< std::pair< double, double > > times;
+        for (auto& text : ranges) {
+            std::pair< double, double > range;
+            if (!parseRange(text, range)) {
+                std::cerr << QObject::tr("Invalid range ").toStdString()
+                          << text.toStdString() << std::endl;
+                return 2;
+            }
+            times.push_back(range);
+        }
+        // The whole recording, samples before t = 0 included
+        if (times.empty()) {
+            times.push_back({ -std::numeric_limits< double >::infinity(),
+                std::numeric_limits< double >::infinity() });
+        }
+        QDir().mkpath(directory);
+
+        // One file at a time, each export already keeps reading, encoding
+        // and writing busy
+        int failed = 0;
+        uint64_t bytes = 0;
+        auto begin = std::chrono::steady_clock::now();
+        for (auto& file : files) {
+            auto reader = registry.reader(file, useSidecarCache);
+            if (!reader || std::dynamic_pointer_cast< LiveReader >(reader)) {
+                ++failed;
+                std::cerr << QObject::tr("Could not load file ").toStdString()
+                          << file.toStdString()
+                          << QObject::tr(" Reason: No reader found")
+                                 .toStdString()
+                          << std::endl;
+                continue;
+            }
+            auto name = QFileInfo(file).completeBaseName();
+            for (size_t k = 0; k < times.size(); ++k) {
+                options.begin = times[ k ].first;
+                options.end = times[ k ].second;
+                auto output = QDir(directory).filePath(
+                    (times.size() == 1 ? name
+                                       : QString("%1_%2").arg(name).arg(k)) +
+                    "." + format);
+                auto result = SampleExporter(reader, options).write(output);
+                bytes += result.bytes;
+                if (!result.error.isEmpty()) {
+                    ++failed;
+                    std::cerr << QObject::tr("Could not export ").toStdString()
+                              << output.toStdString()
+                              << QObject::tr(" Reason: ").toStdString()
+                              << result.error.toStdString() << std::endl;
+                }
+            }
+        }
+        auto seconds = since(begin);
+
+        std::cout << bytes << QObject::tr(" bytes in ").toStdString()
+                  << seconds << " s: " << double(bytes) / seconds / 1e6
+                  << QObject::tr(" MB/s").toStdString() << std::endl;
+        return failed == 0 ? 0 : 1;
+    }
+
+    // One image per file and range, named after the file (plus the index of
+    // the range if there are several)
+    int writeImages(const ReaderRegistry& registry, const QStringList& files,
+        bool useSidecarCache, const QString& directory,
+        const QStringList& ranges, const QString& size, const QString& path)
+    {
+        typedef std::experimental::optional< std::pair< double, double > >
+            Range;
+        std::vector< Range > times;
+        for (auto& text : ranges) {
+            std::pair< double, double > range;
+            if (!parseRange(text, range)) {
+                std::cerr << QObject::tr("Invalid range ").toStdString()
+                          << text.toStdString() << std::endl;
+                return 2;
+            }
+            times.push_back(range);
+        }
+        if (times.empty()) {
+            times.push_back(std::experimental::nullopt);
+        }
+        cli::RenderJob prototype;
+        if (!size.isEmpty() && !parseSize(size, prototype.size)) {
+            std::cerr << QObject::tr("Invalid size ").toStdString()
+                      << size.toStdString() << std::endl;
+            return 2;
+        }
+        QDir().mkpath(directory);
+
+        std::vector< cli::RenderJob > jobs;
+        for (auto& file : files) {
+            auto name = QFileInfo(file).completeBaseName();
+            for (size_t k = 0; k < times.size(); ++k) {
+                auto job = prototype;
+                job.source = file;
+                job.range = times[ k ];
+                job.output = QDir(directory).filePath(times.size() == 1
+                        ? name + ".png"
+                        : QString("%1_%2.png").arg(name).arg(k));
+                jobs.push_back(job);
+            }
+        }
+
+        auto begin = std::chrono::steady_clock::now();
+        cli::render(registry, jobs, useSidecarCache);
+        auto seconds = since(begin);
+
+        int failed = 0;
+        QJsonArray entries;
+        for (auto& job : jobs) {
+            if (!job.error.isEmpty()) {
+                ++failed;
+                std::cerr << QObject::tr("Could not render ").toStdString()
+                          << job.output.toStdString()
+                          << QObject::tr(" Reason: ").toStdString()
+                          << job.error.toStdString() << std::endl;
+            }
+            entries.append(job.toJson());
+        }
+        if (!path.isEmpty()) {
+            QJsonObject document;
+            document[ "images" ] = entries;
+            document[ "seconds" ] = seconds;
+            document[ "images_per_second" ] = double(jobs.size()) / seconds;
+            if (!write(path, document)) {
+                return 1;
+            }
+        }
+
+        std::cout << jobs.size() << QObject::tr(" images in ").toStdString()
+                  << seconds << " s: " << double(jobs.size()) / seconds
+                  << QObject::tr(" images/s").toStdString() << std::endl;
+        return failed == 0 ? 0 : 1;
+    }
+}
+
+bool cli::isBatch(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[ i ], "--batch") == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int cli::batch(QCoreApplication& app)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        QObject::tr("Grimgal without a window"));
+    parser.addHelpOption();
+    parser.addPositionalArgument("files",
+        QObject::tr("Measurement files, --render takes .project files too"),
+        "files...");
+    QCommandLineOption batchOption(
+        "batch", QObject::tr("Run without a window."));
+    QCommandLineOption statsOption("stats",
+        QObject::tr("Write the statistics of every sensor to <file>."),
+        "file");
+    QCommandLineOption renderOption("render",
+        QObject::tr("Render every file to a PNG in <directory>."),
+        "directory");
+    QCommandLineOption rangeOption("range",
+        QObject::tr("Time range to render or export in seconds, may be "
+                    "repeated (default: whole recording)."),
+        "begin:end");
+    QCommandLineOption sizeOption("size",
+        QObject::tr("Size of the rendered images (default: 1920x1080)."),
+        "WIDTHxHEIGHT");
+    QCommandLineOption exportOption("export",
+        QObject::tr("Export the samples of every file to <directory>."),
+        "directory");
+    QCommandLineOption sensorsOption("sensors",
+        QObject::tr("Sensors to export (default: all)."), "0,1,...");
+    QCommandLineOption formatOption("format",
+        QObject::tr("Export format, csv or bin (little endian doubles)."),
+        "format", "csv");
+    QCommandLineOption reportOption("report",
+        QObject::tr("Write the rendered images and their times to <file>."),
+        "file");
+    QCommandLineOption noSidecarOption("no-sidecar",
+        QObject::tr("Neither use nor write sidecar caches."));
+    parser.addOptions({ batchOption, statsOption, renderOption, exportOption,
+        rangeOption, sizeOption, sensorsOption, formatOption, reportOption,
+        noSidecarOption });
+    parser.process(app);
+
+    auto files = parser.positionalArguments();
+    if ((!parser.isSet(statsOption) && !parser.isSet(renderOption) &&
+            !parser.isSet(exportOption)) ||
+        files.isEmpty()) {
+        std::cerr << QObject::tr("Nothing to do, see --help").toStdString()
+                  << std::endl;
+        return 2;
+    }
+
+    ReaderRegistry registry;
+    auto useSidecarCache = !parser.isSet(noSidecarOption);
+    int result = 0;
+    if (parser.isSet(statsOption)) {
+        result = std::max(result, writeStatistics(registry, files,
+                                      useSidecarCache,
+                                      parser.value(statsOption)));
+    }
+    if (parser.isSet(renderOption)) {
+        result = std::max(result,
+            writeImages(registry, files, useSidecarCache,
+                parser.value(renderOption), parser.values(rangeOption),
+                parser.value(sizeOption), parser.value(reportOption)));
+    }
+    if (parser.isSet(exportOption)) {
+        result = std::max(result,
+            writeExports(registry, files, useSidecarCache,
+                parser.value(exportOption), parser.values(rangeOption),
+                parser.value(sensorsOption), parser.value(formatOption)));
+    }
+    return result;
+}
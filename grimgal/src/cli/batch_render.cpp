@@ -0,0 +1,438 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Qt
+#include <QImage>
+#include <QPainter>
+#include <QPointF>
+#include <QRect>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+// Own
+#include "cli/batch_render.h"
+#include "data/configuration.h"
+#include "data/derived_reader.h"
+#include "data/live_reader.h"
+#include "data/measurement.h"
+#include "data/probe.h"
+#include "data/project.h"
+#include "data/project_file.h"
+#include "data/sample_block.h"
+#include "data/sample_pyramid.h"
+#include "render/frame_renderer.h"
+#include "render/tile_loader.h"
+
+// StdLib
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+
+namespace {
+    // Longest wait for the tiles of one image
+    constexpr int TILE_TIMEOUT = 60;
+    // Share of the value range kept free above and below the traces
+    constexpr double VALUE_MARGIN = 0.05;
+
+    class RenderTask : public QRunnable {
+        private:
+        std::function< void() > _task;
+
+        public:
+        RenderTask(std::function< void() > task)
+            : _task(task)
+        {
+        }
+
+        virtual void run() override
+        {
+            this->_task();
+        }
+    };
+
+    struct Source {
+        std::shared_ptr< Project > project;
+        QString error;
+    };
+
+    bool isProject(const QString& filename)
+    {
+        return filename.endsWith(".project");
+    }
+
+    // Recording time of all measurements, nothing if none is indexed
+    std::experimental::optional< std::pair< double, double > > extent(
+        const Project& project)
+    {
+        std::experimental::optional< std::pair< double, double > > result;
+        for (auto& m : project.measurements) {
+            auto e = m->pyramid ? m->pyramid->extent()
+                                : std::experimental::nullopt;
+            if (!e) {
+                continue;
+            }
+            auto offset =
+                std::minmax_element(m->offsetX.begin(), m->offsetX.end());
+            auto begin = e->first + *offset.first;
+            auto end = e->second + *offset.second;
+            result = result ? std::make_pair(std::min(result->first, begin),
+                                  std::max(result->second, end))
+                            : std::make_pair(begin, end);
+        }
+        return result;
+    }
+
+    // Lowest and highest value of a sensor in [begin, end] (measurement
+    // time), derived sensors are evaluated at the given resolution
+    std::experimental::optional< std::pair< double, double > > valueRange(
+        const Measurement& m, size_t sensor, double begin, double end,
+        int_fast32_t resolution)
+    {
+        if (m.pyramid) {
+            auto range = m.pyramid->range(sensor, begin, end);
+            if (!range || range->count == 0) {
+                return {};
+            }
+            return std::make_pair(range->min, range->max);
+        }
+        // Without a pyramid (derived sensors) the samples are read at the
+        // given resolution
+        auto block =
+            readSamples(*m.reader, begin, end, resolution, { sensor });
+        auto low = std::numeric_limits< double >::infinity();
+        auto high = -std::numeric_limits< double >::infinity();
+        for (size_t row = 0; row < block.size(); ++row) {
+            auto value = block.values(0)[ row ];
+            if (!std::isnan(value)) {
+                low = std::min(low, value);
+                high = std::max(high, value);
+            }
+        }
+        if (!(low <= high)) {
+            return {};
+        }
+        return std::make_pair(low, high);
+    }
+
+    // View showing [begin, end] over the full width, the value axis spans
+    // the values of the visible sensors (as drawn, i.e. including their
+    // unit factors and offsets)
+    render::View fit(
+        const Project& project, double begin, double end, QSize size)
+    {
+        render::View view;
+        view.size = size;
+        view.time_per_square =
+            (end - begin) * view.square.x() / double(size.width());
+        view.center.setX(view.timeToX((begin + end) / 2.0));
+
+        // A few rows per pixel are enough for the extremes
+        auto resolution = std::max< int_fast32_t >(1,
+            static_cast< int_fast32_t >(
+                std::ceil(4.0 * double(size.width()) / (end - begin))));
+        auto low = std::numeric_limits< double >::infinity();
+        auto high = -std::numeric_limits< double >::infinity();
+        for (auto& m : project.measurements) {
+            for (size_t i = 0; i < m->visible.size(); ++i) {
+                if (!m->visible[ i ]) {
+                    continue;
+                }
+                auto range = valueRange(*m, i, begin - m->offsetX[ i ],
+                    end - m->offsetX[ i ], resolution);
+                if (!range) {
+                    continue;
+                }
+                // Drawn as value * unitFactor + offsetY
+                auto factor = double(m->unitFactor[ i ]);
+                auto scaled = std::minmax(
+                    { range->first * factor, range->second * factor });
+                low = std::min(low, scaled.first + m->offsetY[ i ]);
+                high = std::max(high, scaled.second + m->offsetY[ i ]);
+            }
+        }
+        if (!(low <= high)) {
+            low = -1.0;
+            high = 1.0;
+        }
+        auto span = high - low;
+        if (span <= 0.0) {
+            span = std::max(std::abs(high), 1.0);
+        }
+        low -= span * VALUE_MARGIN;
+        high += span * VALUE_MARGIN;
+        view.value_per_square =
+            (high - low) * view.square.y() / double(size.height());
+        view.center.setY(view.valueToY((low + high) / 2.0));
+        return view;
+    }
+
+    // True once every tile of the visible sensors is resident, requests the
+    // missing ones
+    bool resident(const render::FrameRenderer& renderer,
+        const Project& project, const QRect& area)
+    {
+        bool result = true;
+        for (auto& m : project.measurements) {
+            if (std::find(m->visible.begin(), m->visible.end(), true) ==
+                m->visible.end()) {
+                continue;
+            }
+            int64_t firstTile = 0;
+            auto tiles = renderer.tiles(m, area, firstTile);
+            result &=
+                std::find(tiles.begin(), tiles.end(), nullptr) == tiles.end();
+        }
+        return result;
+    }
+
+    void draw(std::shared_ptr< render::TileLoader > tileLoader,
+        std::shared_ptr< Configuration > configuration,
+        std::shared_ptr< Project > project, cli::RenderJob& job)
+    {
+        // Tiles are read from the pyramid, raw reads would be far slower
+        for (auto& m : project->measurements) {
+            if (m->pyramid) {
+                m->pyramid->wait();
+            }
+        }
+
+        auto range = job.range ? job.range : extent(*project);
+        if (!range || !(range->first < range->second)) {
+            job.error = "Empty time range";
+            return;
+        }
+        if (job.size.isEmpty()) {
+            job.size = QSize(1920, 1080);
+        }
+
+        render::FrameRenderer renderer(tileLoader);
+        renderer.setConfiguration(configuration);
+        renderer.setProject(project);
+        renderer.setView(
+            fit(*project, range->first, range->second, job.size));
+
+        // The cache is shared, so a tile may be evicted between the check
+        // and the draw, the image is drawn again in that case
+        QImage image(job.size, QImage::Format_ARGB32_Premultiplied);
+        QRect area(QPoint(0, 0), job.size);
+        auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::seconds(TILE_TIMEOUT);
+        for (;;) {
+            auto finished = tileLoader->finishedLoads();
+            if (resident(renderer, *project, area)) {
+                QPainter painter(&image);
+                renderer.drawLayer(painter, area);
+                if (renderer.missingTiles() == 0) {
+                    renderer.drawOverlay(painter, {});
+                    break;
+                }
+            }
+            if (!tileLoader->waitForLoads(finished, deadline)) {
+                job.error = "Timed out waiting for tiles";
+                return;
+            }
+        }
+
+        if (!image.save(job.output, "PNG")) {
+            job.error = "Could not write image";
+        }
+    }
+}
+
+QJsonObject cli::RenderJob::toJson() const
+{
+    QJsonObject result;
+    result[ "source" ] = this->source;
+    result[ "output" ] = this->output;
+    result[ "width" ] = this->size.width();
+    result[ "height" ] = this->size.height();
+    if (this->range) {
+        result[ "begin" ] = this->range->first;
+        result[ "end" ] = this->range->second;
+    }
+    result[ "seconds" ] = this->seconds;
+    if (!this->error.isEmpty()) {
+        result[ "error" ] = this->error;
+    }
+    return result;
+}
+
+void cli::render(const ReaderRegistry& registry, std::vector< RenderJob >& jobs,
+    bool useSidecarCache)
+{
+    QThreadPool pool;
+    pool.setMaxThreadCount(QThread::idealThreadCount());
+
+    // Every file once, measurement files of projects included
+    std::map< QString, std::experimental::optional< ProjectFile > > projects;
+    typedef std::experimental::optional< MeasurementLoader::Opened > Opened;
+    std::map< QString, Opened > opened;
+    for (auto& job : jobs) {
+        if (!isProject(job.source)) {
+            opened[ job.source ];
+            continue;
+        }
+        auto found = projects.find(job.source);
+        if (found == projects.end()) {
+            found = projects.emplace(job.source, ProjectFile::read(job.source))
+                        .first;
+        }
+        if (found->second) {
+            for (auto& entry : found->second->measurements) {
+                // Derived measurements are computed from the others
+                if (!entry.file.startsWith("=")) {
+                    opened[ entry.file ];
+                }
+            }
+        }
+    }
+    for (auto& file : opened) {
+        auto filename = file.first;
+        auto& result = file.second;
+        pool.start(new RenderTask([&registry, filename, &result,
+                                      useSidecarCache]() {
+            // A broken file only fails the images showing it
+            try {
+                result = registry.open(filename, false, false, useSidecarCache);
+            }
+            catch (const std::exception&) {
+                result = std::experimental::nullopt;
+            }
+            // Live sources have no end to wait for
+            if (result &&
+                std::dynamic_pointer_cast< LiveReader >(result->reader)) {
+                result = std::experimental::nullopt;
+            }
+        }));
+    }
+    pool.waitForDone();
+
+    // One project per source, shared by all of its jobs
+    std::map< QString, Source > sources;
+    auto measurement = [&opened](const QString& filename, Source& source) {
+        auto& file = opened[ filename ];
+        if (!file) {
+            source.error = "Could not load " + filename;
+            return std::shared_ptr< Measurement >();
+        }
+        auto m = std::make_shared< Measurement >();
+        m->setReader(file->reader, file->pyramid, file->events,
+            file->eventData, file->source);
+        source.project->measurements.push_back(m);
+        return m;
+    };
+    for (auto& job : jobs) {
+        if (sources.count(job.source)) {
+            continue;
+        }
+        auto& source = sources[ job.source ];
+        source.project = std::make_shared< Project >();
+        source.project->file = job.source;
+        if (!isProject(job.source)) {
+            measurement(job.source, source);
+            continue;
+        }
+        auto& projectFile = projects[ job.source ];
+        if (!projectFile) {
+            source.error = "Not a project";
+            continue;
+        }
+        for (auto& entry : projectFile->measurements) {
+            if (entry.file.startsWith("=")) {
+                continue;
+            }
+            auto m = measurement(entry.file, source);
+            if (m) {
+                ProjectFile::apply(*m, entry.element);
+            }
+        }
+        // Operands are referenced by file, see DerivedReader::filename()
+        auto files = source.project->measurements;
+        auto resolve = [&files](const QString& reference) {
+            for (auto& m : files) {
+                if (QString::fromStdString(m->reader->filename()) ==
+                    reference) {
+                    return m;
+                }
+            }
+            return std::shared_ptr< Measurement >();
+        };
+        for (auto& entry : projectFile->measurements) {
+            if (!entry.file.startsWith("=")) {
+                continue;
+            }
+            QString error;
+            auto expression =
+                ChannelExpression::parse(entry.file.mid(1), resolve, error);
+            if (!expression) {
+                source.error = "Could not load " + entry.file + ": " + error;
+                continue;
+            }
+            // Indexed like in the GUI, see MainWindow::add_derived_measurment
+            auto reader = std::make_shared< DerivedReader >(*expression);
+            auto m = std::make_shared< Measurement >();
+            m->setReader(reader, std::make_shared< SamplePyramid >(reader));
+            ProjectFile::apply(*m, entry.element);
+            source.project->measurements.push_back(m);
+        }
+        for (auto time : projectFile->probes) {
+            auto probe = std::make_shared< Probe >();
+            probe->time = time;
+            source.project->probes.push_back(probe);
+        }
+    }
+
+    // The jobs request tiles at the same time, one loader thread per core
+    // keeps them all busy
+    auto tileLoader =
+        std::make_shared< render::TileLoader >(QThread::idealThreadCount());
+    auto configuration = std::make_shared< Configuration >();
+    for (auto& job : jobs) {
+        auto& source = sources[ job.source ];
+        if (!source.error.isEmpty()) {
+            job.error = source.error;
+            continue;
+        }
+        auto project = source.project;
+        pool.start(
+            new RenderTask([tileLoader, configuration, project, &job]() {
+                auto begin = std::chrono::steady_clock::now();
+                try {
+                    draw(tileLoader, configuration, project, job);
+                }
+                catch (const std::exception& e) {
+                    job.error = QString::fromStdString(e.what());
+                }
+                job.seconds = std::chrono::duration< double >(
+                    std::chrono::steady_clock::now() - begin)
+                                  .count();
+            }));
+    }
+    pool.waitForDone();
+}
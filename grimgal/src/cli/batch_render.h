@@ -0,0 +1,65 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#ifndef CLI_BATCHRENDER_H
+#define CLI_BATCHRENDER_H
+
+// Qt
+#include <QJsonObject>
+#include <QSize>
+#include <QString>
+
+// Own
+#include "data/reader_registry.h"
+
+// StdLib
+#include <experimental/optional>
+#include <utility>
+#include <vector>
+
+namespace cli {
+    struct RenderJob {
+        // A .project file or a single measurement file
+        QString source;
+        // Time range in seconds, nothing renders the whole recording
+        std::experimental::optional< std::pair< double, double > > range;
+        QSize size = QSize(1920, 1080);
+        // PNG file
+        QString output;
+
+        // Empty if the image was written
+        QString error;
+        double seconds = 0.0;
+
+        QJsonObject toJson() const;
+    };
+
+    // Renders every job into its PNG without a widget, one job per core at a
+    // time. Each file is opened once, jobs of the same source share their
+    // measurements and all jobs share one tile loader (and thereby its tile
+    // cache). The value axis is fitted to the visible sensors in the range.
+    void render(const ReaderRegistry& registry, std::vector< RenderJob >& jobs,
+        bool useSidecarCache);
+}
+
+#endif // CLI_BATCHRENDER_H
@@ -0,0 +1,158 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Qt
+#include <QJsonArray>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+// Own
+#include "cli/batch_statistics.h"
+#include "data/live_reader.h"
+#include "data/sample_pyramid.h"
+#include "data/sample_statistics.h"
+
+// StdLib
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <memory>
+
+namespace {
+    class StatisticsTask : public QRunnable {
+        private:
+        std::function< void() > _task;
+
+        public:
+        StatisticsTask(std::function< void() > task)
+            : _task(task)
+        {
+        }
+
+        virtual void run() override
+        {
+            this->_task();
+        }
+    };
+
+    void evaluate(const ReaderRegistry& registry,
+        cli::FileStatistics& result, bool useSidecarCache)
+    {
+        auto opened = registry.open(result.filename, false, false,
+            useSidecarCache);
+        if (!opened) {
+            result.error = "No reader found";
+            return;
+        }
+        if (std::dynamic_pointer_cast< LiveReader >(opened->reader)) {
+            result.error = "Live sources have no end";
+            return;
+        }
+        result.sensors = opened->reader->sensors();
+
+        auto& pyramid = opened->pyramid;
+        if (pyramid) {
+            pyramid->wait();
+        }
+        auto statistics = pyramid ? pyramid->statistics()
+                                  : std::experimental::nullopt;
+        if (statistics) {
+            result.statistics = *statistics;
+        }
+        else {
+            result.statistics =
+                readerStatistics(opened->reader, result.sensors.size());
+        }
+    }
+}
+
+uint64_t cli::FileStatistics::samples() const
+{
+    uint64_t result = 0;
+    for (auto& statistic : this->statistics) {
+        result += statistic.count;
+    }
+    return result;
+}
+
+QJsonObject cli::FileStatistics::toJson() const
+{
+    QJsonObject result;
+    result[ "file" ] = this->filename;
+    result[ "seconds" ] = this->seconds;
+    if (!this->error.isEmpty()) {
+        result[ "error" ] = this->error;
+        return result;
+    }
+
+    // Missing figures (NaN) are written as null
+    QJsonArray entries;
+    for (size_t s = 0; s < this->sensors.size(); ++s) {
+        QJsonObject sensor;
+        sensor[ "name" ] = QString::fromStdString(this->sensors[ s ].name);
+        sensor[ "unit" ] = QString::fromStdString(this->sensors[ s ].unit);
+        if (s < this->statistics.size()) {
+            auto& statistic = this->statistics[ s ];
+            sensor[ "count" ] = double(statistic.count);
+            sensor[ "min" ] = statistic.min;
+            sensor[ "max" ] = statistic.max;
+            sensor[ "mean" ] = statistic.mean;
+            sensor[ "median" ] = statistic.median;
+            sensor[ "variance" ] = statistic.variance;
+        }
+        entries.append(sensor);
+    }
+    result[ "sensors" ] = entries;
+    return result;
+}
+
+std::vector< cli::FileStatistics > cli::statistics(
+    const ReaderRegistry& registry, const QStringList& files,
+    bool useSidecarCache)
+{
+    std::vector< FileStatistics > result(
+        static_cast< size_t >(files.size()));
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(QThread::idealThreadCount());
+    for (int i = 0; i < files.size(); ++i) {
+        auto& file = result[ static_cast< size_t >(i) ];
+        file.filename = files[ i ];
+        pool.start(new StatisticsTask([&registry, &file, useSidecarCache]() {
+            auto begin = std::chrono::steady_clock::now();
+            // An exception must not take down the other files
+            try {
+                evaluate(registry, file, useSidecarCache);
+            }
+            catch (const std::exception& e) {
+                file.error = QString::fromStdString(e.what());
+            }
+            file.seconds = std::chrono::duration< double >(
+                std::chrono::steady_clock::now() - begin)
+                               .count();
+        }));
+    }
+    pool.waitForDone();
+    return result;
+}
@@ -0,0 +1,65 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#ifndef CLI_BATCHSTATISTICS_H
+#define CLI_BATCHSTATISTICS_H
+
+// Qt
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+
+// Own
+#include "data/reader_registry.h"
+#include "data/sample_statistics.h"
+#include <rlib/common/sensor.h>
+
+// StdLib
+#include <cstdint>
+#include <vector>
+
+namespace cli {
+    struct FileStatistics {
+        QString filename;
+        // Empty if the file could be read
+        QString error;
+        std::vector< rlib::common::sensor > sensors;
+        // Per sensor, count is 0 if the reader only reports the figures
+        std::vector< SensorStatistic > statistics;
+        double seconds = 0.0;
+
+        // Values of all sensors
+        uint64_t samples() const;
+        QJsonObject toJson() const;
+    };
+
+    // Per sensor statistics of every file, one file per core at a time.
+    // Figures come from the pyramid pass (or a sidecar of an earlier one),
+    // readers without a fixed sampling interval are asked for theirs.
+    // Values are in the units of the file: unitFactor and the offsets are
+    // properties of a project, which only --render reads.
+    std::vector< FileStatistics > statistics(const ReaderRegistry& registry,
+        const QStringList& files, bool useSidecarCache);
+}
+
+#endif // CLI_BATCHSTATISTICS_H
@@ -0,0 +1,396 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Qt
+#include <QLocale>
+#include <QString>
+
+// Own
+#include "data/channel_expression.h"
+
+// StdLib
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <string>
+
+// Recursive descent over the UTF-8 text, emits the program in postfix order
+class ChannelExpression::Parser {
+    private:
+    const std::string _text;
+    Resolve _resolve;
+    ChannelExpression& _result;
+    size_t _pos = 0;
+    // Stack size after the instructions emitted so far
+    size_t _stack = 0;
+    // Canonical text up to _copied
+    std::string _canonical;
+    size_t _copied = 0;
+
+    void skipSpace()
+    {
+        while (this->_pos < this->_text.size() &&
+               std::isspace(static_cast< unsigned char >(
+                   this->_text[ this->_pos ]))) {
+            ++this->_pos;
+        }
+    }
+
+    bool accept(char c)
+    {
+        this->skipSpace();
+        if (this->_pos < this->_text.size() &&
+            this->_text[ this->_pos ] == c) {
+            ++this->_pos;
+            return true;
+        }
+        return false;
+    }
+
+    bool digits(size_t& value)
+    {
+        auto begin = this->_pos;
+        value = 0;
+        while (this->_pos < this->_text.size() &&
+               std::isdigit(static_cast< unsigned char >(
+                   this->_text[ this->_pos ]))) {
+            value = value * 10 + size_t(this->_text[ this->_pos ] - '0');
+            ++this->_pos;
+        }
+        return this->_pos > begin;
+    }
+
+    void add(OP op, double constant = 0.0, size_t operand = 0)
+    {
+        switch (op) {
+            case OP::OPERAND:
+            case OP::CONSTANT:
+                ++this->_stack;
+                break;
+            case OP::ADD:
+            case OP::SUBTRACT:
+            case OP::MULTIPLY:
+            case OP::DIVIDE:
+                --this->_stack;
+                break;
+            case OP::NEGATE:
+            case OP::ABS:
+            case OP::SQRT:
+                break;
+        }
+        this->_result._depth = std::max(this->_result._depth, this->_stack);
+        this->_result._program.push_back(Instruction{ op, constant, operand });
+    }
+
+    // ".s<sensor>" behind a reference which started at begin
+    void operand(size_t begin, const std::string& reference)
+    {
+        size_t sensor = 0;
+        if (!this->accept('.') || !this->accept('s') || !this->digits(sensor)) {
+            throw std::string("Expected .s<sensor> behind ") + reference;
+        }
+        auto measurement = this->_resolve(QString::fromStdString(reference));
+        if (!measurement) {
+            throw "Unknown measurement " + reference;
+        }
+        if (sensor >= measurement->reader->sensors().size()) {
+            throw "Unknown sensor " +
+                this->_text.substr(begin, this->_pos - begin);
+        }
+
+        auto& operands = this->_result._operands;
+        auto found = std::find_if(operands.begin(), operands.end(),
+            [&measurement, sensor](const Operand& o) {
+                return o.measurement == measurement && o.sensor == sensor;
+            });
+        if (found == operands.end()) {
+            found = operands.insert(
+                operands.end(), Operand{ measurement, sensor });
+        }
+        this->add(OP::OPERAND, 0.0,
+            static_cast< size_t >(found - operands.begin()));
+
+        this->_canonical +=
+            this->_text.substr(this->_copied, begin - this->_copied) + "[" +
+            measurement->reader->filename() + "].s" + std::to_string(sensor);
+        this->_copied = this->_pos;
+    }
+
+    // Digits with an optional fraction and exponent, always with a dot
+    // whatever the locale Qt set (saved projects have to parse everywhere)
+    double number()
+    {
+        auto begin = this->_pos;
+        auto digit = [this](size_t pos) {
+            return pos < this->_text.size() &&
+                   std::isdigit(
+                       static_cast< unsigned char >(this->_text[ pos ]));
+        };
+        while (digit(this->_pos) ||
+               (this->_pos < this->_text.size() &&
+                   this->_text[ this->_pos ] == '.')) {
+            ++this->_pos;
+        }
+        if (this->_pos < this->_text.size() &&
+            (this->_text[ this->_pos ] == 'e' ||
+                this->_text[ this->_pos ] == 'E')) {
+            auto exponent = this->_pos + 1;
+            if (exponent < this->_text.size() &&
+                (this->_text[ exponent ] == '+' ||
+                    this->_text[ exponent ] == '-')) {
+                ++exponent;
+            }
+            if (digit(exponent)) {
+                this->_pos = exponent;
+                while (digit(this->_pos)) {
+                    ++this->_pos;
+                }
+            }
+        }
+        bool ok = false;
+        auto value = QLocale::c().toDouble(
+            QString::fromStdString(
+                this->_text.substr(begin, this->_pos - begin)),
+            &ok);
+        if (!ok) {
+            throw std::string("Invalid number");
+        }
+        return value;
+    }
+
+    void primary()
+    {
+        this->skipSpace();
+        if (this->_pos >= this->_text.size()) {
+            throw std::string("Unexpected end");
+        }
+        auto begin = this->_pos;
+        auto c = this->_text[ this->_pos ];
+
+        if (this->accept('(')) {
+            this->expression();
+            if (!this->accept(')')) {
+                throw std::string("Expected )");
+            }
+            return;
+        }
+        if (std::isdigit(static_cast< unsigned char >(c)) || c == '.') {
+            this->add(OP::CONSTANT, this->number());
+            return;
+        }
+        if (c == '[') {
+            auto close = this->_text.find(']', begin);
+            if (close == std::string::npos) {
+                throw std::string("Expected ]");
+            }
+            this->_pos = close + 1;
+            this->operand(
+                begin, this->_text.substr(begin + 1, close - begin - 1));
+            return;
+        }
+
+        std::string name;
+        while (this->_pos < this->_text.size() &&
+               std::isalpha(static_cast< unsigned char >(
+                   this->_text[ this->_pos ]))) {
+            name += this->_text[ this->_pos++ ];
+        }
+        size_t index = 0;
+        if (name == "m" && this->digits(index)) {
+            this->operand(begin, "m" + std::to_string(index));
+            return;
+        }
+        if (name == "abs" || name == "sqrt") {
+            if (!this->accept('(')) {
+                throw "Expected ( behind " + name;
+            }
+            this->expression();
+            if (!this->accept(')')) {
+                throw std::string("Expected )");
+            }
+            this->add(name == "abs" ? OP::ABS : OP::SQRT);
+            return;
+        }
+        throw "Unexpected " + this->_text.substr(begin, 1);
+    }
+
+    void unary()
+    {
+        if (this->accept('-')) {
+            this->unary();
+            this->add(OP::NEGATE);
+            return;
+        }
+        this->primary();
+    }
+
+    void term()
+    {
+        this->unary();
+        for (;;) {
+            if (this->accept('*')) {
+                this->unary();
+                this->add(OP::MULTIPLY);
+            }
+            else if (this->accept('/')) {
+                this->unary();
+                this->add(OP::DIVIDE);
+            }
+            else {
+                return;
+            }
+        }
+    }
+
+    void expression()
+    {
+        this->term();
+        for (;;) {
+            if (this->accept('+')) {
+                this->term();
+                this->add(OP::ADD);
+            }
+            else if (this->accept('-')) {
+                this->term();
+                this->add(OP::SUBTRACT);
+            }
+            else {
+                return;
+            }
+        }
+    }
+
+    public:
+    Parser(const QString& text, Resolve resolve, ChannelExpression& result)
+        : _text(text.toStdString())
+        , _resolve(resolve)
+        , _result(result)
+    {
+    }
+
+    // Throws a message (std::string) if the text is malformed
+    void parse()
+    {
+        this->expression();
+        this->skipSpace();
+        if (this->_pos != this->_text.size()) {
+            throw "Unexpected " + this->_text.substr(this->_pos, 1);
+        }
+        this->_canonical += this->_text.substr(this->_copied);
+        this->_result._text = QString::fromStdString(this->_canonical);
+    }
+};
+
+std::experimental::optional< ChannelExpression > ChannelExpression::parse(
+    const QString& text, Resolve resolve, QString& error)
+{
+    ChannelExpression result;
+    try {
+        Parser(text, resolve, result).parse();
+    }
+    catch (const std::string& message) {
+        error = QString::fromStdString(message);
+        return {};
+    }
+    if (result._operands.empty()) {
+        error = "No sensor";
+        return {};
+    }
+    return result;
+}
+
+const std::vector< ChannelExpression::Operand >&
+    ChannelExpression::operands() const
+{
+    return this->_operands;
+}
+
+QString ChannelExpression::text() const
+{
+    return this->_text;
+}
+
+void ChannelExpression::evaluate(const std::vector< const double* >& operands,
+    size_t rows, double* result) const
+{
+    std::vector< std::vector< double > > stack(
+        this->_depth, std::vector< double >(rows));
+    size_t top = 0;
+    for (auto& instruction : this->_program) {
+        // Operands of binary instructions: a (below) op= b (top)
+        auto a = top >= 2 ? stack[ top - 2 ].data() : nullptr;
+        auto b = top >= 1 ? stack[ top - 1 ].data() : nullptr;
+        switch (instruction.op) {
+            case OP::OPERAND:
+                std::copy(operands[ instruction.operand ],
+                    operands[ instruction.operand ] + rows,
+                    stack[ top++ ].begin());
+                break;
+            case OP::CONSTANT:
+                std::fill(stack[ top ].begin(), stack[ top ].end(),
+                    instruction.constant);
+                ++top;
+                break;
+            case OP::ADD:
+                for (size_t r = 0; r < rows; ++r) {
+                    a[ r ] += b[ r ];
+                }
+                --top;
+                break;
+            case OP::SUBTRACT:
+                for (size_t r = 0; r < rows; ++r) {
+                    a[ r ] -= b[ r ];
+                }
+                --top;
+                break;
+            case OP::MULTIPLY:
+                for (size_t r = 0; r < rows; ++r) {
+                    a[ r ] *= b[ r ];
+                }
+                --top;
+                break;
+            case OP::DIVIDE:
+                for (size_t r = 0; r < rows; ++r) {
+                    a[ r ] /= b[ r ];
+                }
+                --top;
+                break;
+            case OP::NEGATE:
+                for (size_t r = 0; r < rows; ++r) {
+                    b[ r ] = -b[ r ];
+                }
+                break;
+            case OP::ABS:
+                for (size_t r = 0; r < rows; ++r) {
+                    b[ r ] = std::abs(b[ r ]);
+                }
+                break;
+            case OP::SQRT:
+                for (size_t r = 0; r < rows; ++r) {
+                    b[ r ] = std::sqrt(b[ r ]);
+                }
+                break;
+        }
+    }
+    std::copy(stack[ 0 ].begin(), stack[ 0 ].end(), result);
+}
@@ -0,0 +1,104 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#ifndef CHANNEL_EXPRESSION_H
+#define CHANNEL_EXPRESSION_H
+
+// Qt
+#include <QString>
+
+// Own
+#include "data/measurement.h"
+
+// StdLib
+#include <cstddef>
+#include <experimental/optional>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Arithmetic over sensors, e.g. "m0.s1 * m0.s2" for the power of a voltage
+// and a current. Sensors are written as m<measurement>.s<sensor> (positions
+// in the measurement tree) or as [<file>].s<sensor>. Supported are numbers,
+// + - * /, unary minus, parentheses, abs() and sqrt().
+//
+// The expression is compiled to a stack program which evaluates whole
+// columns at a time, every instruction is one plain loop over the rows.
+class ChannelExpression {
+    public:
+    struct Operand {
+        std::shared_ptr< Measurement > measurement;
+        size_t sensor;
+    };
+
+    // Measurement of a reference, either "m<index>" or a file name. Returns
+    // nullptr if there is none.
+    typedef std::function< std::shared_ptr< Measurement >(const QString&) >
+        Resolve;
+
+    private:
+    enum class OP {
+        OPERAND,
+        CONSTANT,
+        ADD,
+        SUBTRACT,
+        MULTIPLY,
+        DIVIDE,
+        NEGATE,
+        ABS,
+        SQRT,
+    };
+
+    struct Instruction {
+        OP op;
+        double constant;
+        size_t operand;
+    };
+
+    std::vector< Instruction > _program;
+    std::vector< Operand > _operands;
+    // Columns on the stack at most
+    size_t _depth = 0;
+    // Operands written as [<file>].s<sensor>, see text()
+    QString _text;
+
+    class Parser;
+
+    public:
+    // Returns nothing and sets error if text is malformed or references an
+    // unknown measurement or sensor
+    static std::experimental::optional< ChannelExpression > parse(
+        const QString& text, Resolve resolve, QString& error);
+
+    // Distinct sensors in order of first use
+    const std::vector< Operand >& operands() const;
+    // The expression with every operand referenced by file, so it can be
+    // parsed again once the files are open
+    QString text() const;
+
+    // Evaluates rows values, operands[ k ] holds the column of operand k
+    void evaluate(const std::vector< const double* >& operands, size_t rows,
+        double* result) const;
+};
+
+#endif // CHANNEL_EXPRESSION_H
@@ -93,6 +93,8 @@ class Configuration {
     // Other
     bool _use_cached_reader = true;
     bool _use_statistic_reader = false;
+    bool _use_gl_renderer = false;
+    bool _use_sidecar_cache = true;
 };
 
 #endif // CONFIGURATION_H
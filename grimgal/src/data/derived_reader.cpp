@@ -0,0 +1,277 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Qt
+
+// Own
+#include "data/derived_reader.h"
+#include "data/sample_statistics.h"
+
+// StdLib
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <set>
+
+DerivedReader::DerivedReader(ChannelExpression expression)
+    : _expression(expression)
+{
+    auto& operands = this->_expression.operands();
+    auto& base = operands.front();
+    auto baseOffset = base.measurement->offsetX.at(base.sensor);
+    for (auto& operand : operands) {
+        auto shift =
+            baseOffset - operand.measurement->offsetX.at(operand.sensor);
+        auto found = std::find_if(this->_sources.begin(),
+            this->_sources.end(), [&operand, shift](const Source& source) {
+                return source.measurement == operand.measurement &&
+                       source.shift == shift;
+            });
+        if (found == this->_sources.end()) {
+            auto interval = operand.measurement->reader->sensors()
+                                .at(operand.sensor)
+                                .sampling_interval;
+            found = this->_sources.insert(this->_sources.end(),
+                Source{ operand.measurement, {}, shift, interval });
+        }
+        this->_columns.emplace_back(
+            static_cast< size_t >(found - this->_sources.begin()),
+            found->channels.size());
+        found->channels.push_back(operand.sensor);
+    }
+
+    rlib::common::sensor sensor;
+    sensor.name = this->_expression.text().toStdString();
+    sensor.sampling_interval = this->_sources.front().sampling_interval;
+    this->_sensors.push_back(sensor);
+}
+
+const ChannelExpression& DerivedReader::expression() const
+{
+    return this->_expression;
+}
+
+SampleBlock DerivedReader::fetch(const Source& source, double begin,
+    double end, std::shared_ptr< SampleArena > arena) const
+{
+    auto resolution = std::numeric_limits< int_fast32_t >::max();
+    if (source.sampling_interval > 0.0) {
+        resolution = static_cast< int_fast32_t >(
+            std::ceil(1.0 / source.sampling_interval));
+    }
+    return readSamples(*source.measurement->source, begin, end, resolution,
+        source.channels, arena);
+}
+
+SampleBlock DerivedReader::block(double begin, double end,
+    int_fast32_t resolution, std::vector< size_t > channels,
+    std::shared_ptr< SampleArena > arena)
+{
+    std::vector< SampleBlock > blocks;
+    blocks.reserve(this->_sources.size());
+    blocks.push_back(this->fetch(this->_sources.front(), begin, end, arena));
+    for (size_t s = 1; s < this->_sources.size(); ++s) {
+        // One sample before the range, so the first row has a value to hold
+        auto& source = this->_sources[ s ];
+        blocks.push_back(this->fetch(source,
+            begin + source.shift - source.sampling_interval,
+            end + source.shift, arena));
+    }
+    auto rows = blocks.front().size();
+    auto time = blocks.front().time();
+
+    // Rows of the other sources held at each row of the first one
+    std::vector< std::vector< size_t > > held(this->_sources.size());
+    for (size_t s = 1; s < this->_sources.size(); ++s) {
+        auto& block = blocks[ s ];
+        auto shift = this->_sources[ s ].shift;
+        held[ s ].resize(rows);
+        size_t next = 0;
+        for (size_t r = 0; r < rows; ++r) {
+            while (next < block.size() &&
+                   block.time()[ next ] <= time[ r ] + shift) {
+                ++next;
+            }
+            held[ s ][ r ] = next == 0 ? block.size() : next - 1;
+        }
+    }
+
+    // Columns of the operands, the ones of the first source are used as is
+    auto nan = std::numeric_limits< double >::quiet_NaN();
+    std::vector< std::vector< double > > aligned(this->_columns.size());
+    std::vector< const double* > columns(this->_columns.size());
+    for (size_t k = 0; k < this->_columns.size(); ++k) {
+        auto s = this->_columns[ k ].first;
+        auto values = blocks[ s ].values(this->_columns[ k ].second);
+        if (s == 0) {
+            columns[ k ] = values;
+            continue;
+        }
+        aligned[ k ].resize(rows);
+        for (size_t r = 0; r < rows; ++r) {
+            auto row = held[ s ][ r ];
+            aligned[ k ][ r ] = row < blocks[ s ].size() ? values[ row ] : nan;
+        }
+        columns[ k ] = aligned[ k ].data();
+    }
+
+    SampleBlock result(channels, rows, arena);
+    result.resize(rows);
+    std::copy(time, time + rows, result.time());
+    for (size_t c = 0; c < channels.size(); ++c) {
+        this->_expression.evaluate(columns, rows, result.values(c));
+    }
+    result.crop(begin, end);
+
+    // Thinned out only after the evaluation, so the peaks are those of the
+    // derived values
+    auto interval = this->_sensors.front().sampling_interval;
+    auto wanted = 1.0 / double(std::max< int_fast32_t >(resolution, 1));
+    if (resolution > 0 && (interval <= 0.0 || wanted > interval)) {
+        return envelopeSamples(result, wanted, arena);
+    }
+    return result;
+}
+
+bool DerivedReader::growing() const
+{
+    for (auto& source : this->_sources) {
+        auto& pyramid = source.measurement->pyramid;
+        if (pyramid && pyramid->live()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string DerivedReader::filename()
+{
+    return "=" + this->_expression.text().toStdString();
+}
+
+std::vector< rlib::common::sensor > DerivedReader::sensors()
+{
+    return this->_sensors;
+}
+
+std::vector< rlib::common::sample > DerivedReader::samples(
+    double begin, double end, int_fast32_t resolution)
+{
+    auto block = this->block(begin, end, resolution, { 0 });
+    std::vector< rlib::common::sample > result(block.size());
+    for (size_t r = 0; r < block.size(); ++r) {
+        result[ r ].time = block.time()[ r ];
+        result[ r ].values = { block.values(0)[ r ] };
+    }
+    return result;
+}
+
+rlib::common::sample DerivedReader::sample(
+    double time, int_fast32_t resolution)
+{
+    // Like any reader: the row at or before time, the first one if there is
+    // none
+    auto full = std::numeric_limits< int_fast32_t >::max();
+    auto row = this->_sources.front().measurement->source->sample(time, full);
+    auto block = this->block(row.time,
+        std::nextafter(row.time, std::numeric_limits< double >::infinity()),
+        full, { 0 });
+
+    rlib::common::sample result;
+    result.time = row.time;
+    result.values = { block.empty() ? std::numeric_limits< double >::quiet_NaN()
+                                    : block.values(0)[ 0 ] };
+    return result;
+}
+
+std::vector< rlib::common::event_data > DerivedReader::events(
+    double begin, double end)
+{
+    // Events of the measurements of the operands, moved to the time base
+    std::vector< rlib::common::event_data > result;
+    std::set< const Measurement* > measurements;
+    for (auto& source : this->_sources) {
+        auto& events = source.measurement->eventData;
+        if (!events || !measurements.insert(source.measurement.get()).second) {
+            continue;
+        }
+        for (auto event : *events) {
+            event.time -= source.shift;
+            if (event.time >= begin && (end < 0.0 || event.time <= end)) {
+                result.push_back(event);
+            }
+        }
+    }
+    std::stable_sort(result.begin(), result.end(),
+        [](const rlib::common::event_data& a,
+            const rlib::common::event_data& b) { return a.time < b.time; });
+    return result;
+}
+
+std::vector< std::experimental::optional< double > > DerivedReader::statistic(
+    rlib::common::statistic_data data)
+{
+    // One pass over the whole time base, the figures are not kept. The
+    // pyramid of the derived measurement gathers them as well.
+    auto full = std::numeric_limits< int_fast32_t >::max();
+    auto& base = *this->_sources.front().measurement->source;
+    auto first = base.sample(std::numeric_limits< double >::lowest(), full);
+    auto last = std::nextafter(
+        base.sample(std::numeric_limits< double >::max(), full).time,
+        std::numeric_limits< double >::infinity());
+    auto interval = this->_sensors.front().sampling_interval;
+    auto chunk = interval > 0.0 ? interval * 64.0 * 1024.0 : 60.0;
+
+    SampleStatistics statistics(1);
+    auto arena = std::make_shared< SampleArena >();
+    for (auto begin = first.time; begin < last; begin += chunk) {
+        statistics.add(this->block(
+            begin, std::min(begin + chunk, last), full, { 0 }, arena));
+    }
+    auto figures = statistics.result().front();
+
+    std::vector< std::experimental::optional< double > > result(1);
+    if (figures.count == 0) {
+        return result;
+    }
+    switch (data) {
+        case rlib::common::statistic_data::MIN_VALUE:
+            result[ 0 ] = figures.min;
+            break;
+        case rlib::common::statistic_data::MAX_VALUE:
+            result[ 0 ] = figures.max;
+            break;
+        case rlib::common::statistic_data::AVG_VALUE:
+            result[ 0 ] = figures.mean;
+            break;
+        case rlib::common::statistic_data::MEDIAN_VALUE:
+            result[ 0 ] = figures.median;
+            break;
+        case rlib::common::statistic_data::VAR_VALUE:
+            result[ 0 ] = figures.variance;
+            break;
+        default:
+            break;
+    }
+    return result;
+}
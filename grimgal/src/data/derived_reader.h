@@ -0,0 +1,104 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#ifndef DERIVED_READER_H
+#define DERIVED_READER_H
+
+// Qt
+
+// Own
+#include "data/channel_expression.h"
+#include "data/measurement.h"
+#include "data/sample_block.h"
+#include <rlib/common/reader.h>
+
+// StdLib
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Reader of a single derived sensor, an expression over sensors of other
+// measurements. Every block is evaluated on the raw rows of the operands,
+// read at their own rate through Measurement::source, and only the result
+// is thinned out to the requested resolution. The expression is never
+// applied to min/max rows, whose combination would not be a value of the
+// derived sensor. Long coarse ranges are answered by the pyramid of the
+// derived measurement, built from these exact values.
+//
+// The time base is that of the first operand. Operands of other
+// measurements (or with another offsetX) are aligned to it by their offsets
+// at construction and sampled with the previous value at each row. Safe to
+// use from any thread.
+class DerivedReader : public rlib::common::reader, public BlockSource {
+    private:
+    // Operands read together, i.e. of the same measurement and shift
+    struct Source {
+        std::shared_ptr< Measurement > measurement;
+        std::vector< size_t > channels;
+        // Added to the time of the first operand to get the time of this
+        // source
+        double shift;
+        double sampling_interval;
+    };
+
+    ChannelExpression _expression;
+    std::vector< Source > _sources;
+    // Source and column of every operand
+    std::vector< std::pair< size_t, size_t > > _columns;
+    std::vector< rlib::common::sensor > _sensors;
+
+    // Raw rows of the source in [begin, end)
+    SampleBlock fetch(const Source& source, double begin, double end,
+        std::shared_ptr< SampleArena > arena) const;
+
+    public:
+    DerivedReader(ChannelExpression expression);
+
+    const ChannelExpression& expression() const;
+
+    // Derived values in [begin, end), channels may only hold sensor 0
+    virtual SampleBlock block(double begin, double end,
+        int_fast32_t resolution, std::vector< size_t > channels,
+        std::shared_ptr< SampleArena > arena =
+            SampleArena::global()) override;
+    // True if an operand is live, a pyramid of the derived values could not
+    // keep up with it
+    virtual bool growing() const override;
+
+    // "=" followed by the text of the expression, which is how a project
+    // file stores a derived measurement
+    virtual std::string filename() override;
+    virtual std::vector< rlib::common::sensor > sensors() override;
+    virtual std::vector< rlib::common::sample > samples(
+        double begin, double end, int_fast32_t resolution) override;
+    virtual rlib::common::sample sample(
+        double time, int_fast32_t resolution) override;
+    virtual std::vector< rlib::common::event_data > events(
+        double begin, double end) override;
+    virtual std::vector< std::experimental::optional< double > > statistic(
+        rlib::common::statistic_data data) override;
+};
+
+#endif // DERIVED_READER_H
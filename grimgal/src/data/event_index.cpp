@@ -0,0 +1,109 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Qt
+
+// Own
+#include "data/event_index.h"
+#include <rlib/common/event_data.h>
+
+// StdLib
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+EventIndex::EventIndex(const std::vector< rlib::common::event_data >& events)
+    : _size(events.size())
+{
+    std::map< int, std::vector< double > > channels;
+    for (auto& e : events) {
+        channels[ e.origin ].push_back(e.time);
+    }
+    for (auto& channel : channels) {
+        auto& time = channel.second;
+        if (!std::is_sorted(time.begin(), time.end())) {
+            std::sort(time.begin(), time.end());
+        }
+        this->_channels.push_back({ channel.first, std::move(time) });
+    }
+}
+
+const EventIndex::Channel* EventIndex::channel(int origin) const
+{
+    auto found = std::lower_bound(this->_channels.begin(),
+        this->_channels.end(), origin,
+        [](const Channel& c, int o) { return c.origin < o; });
+    if (found == this->_channels.end() || found->origin != origin) {
+        return nullptr;
+    }
+    return &*found;
+}
+
+size_t EventIndex::size() const
+{
+    return this->_size;
+}
+
+std::vector< int > EventIndex::origins() const
+{
+    std::vector< int > origins;
+    for (auto& channel : this->_channels) {
+        origins.push_back(channel.origin);
+    }
+    return origins;
+}
+
+size_t EventIndex::count(int origin, double begin, double end) const
+{
+    auto channel = this->channel(origin);
+    if (channel == nullptr || end <= begin) {
+        return 0;
+    }
+    auto& time = channel->time;
+    auto first = std::lower_bound(time.begin(), time.end(), begin);
+    auto last = std::lower_bound(first, time.end(), end);
+    return static_cast< size_t >(last - first);
+}
+
+std::vector< EventIndex::Bin > EventIndex::histogram(
+    int origin, double begin, double width, size_t bins) const
+{
+    std::vector< Bin > result;
+    auto channel = this->channel(origin);
+    if (channel == nullptr || width <= 0.0 || bins == 0) {
+        return result;
+    }
+
+    auto& time = channel->time;
+    auto end = begin + width * double(bins);
+    auto it = std::lower_bound(time.begin(), time.end(), begin);
+    while (it != time.end() && *it < end) {
+        // Jump to the first event behind the bin of *it
+        auto bin = std::floor((*it - begin) / width);
+        auto binEnd = std::min(end, begin + (bin + 1.0) * width);
+        auto next = std::lower_bound(it + 1, time.end(), binEnd);
+        result.push_back({ *it, static_cast< uint32_t >(next - it) });
+        it = next;
+    }
+    return result;
+}
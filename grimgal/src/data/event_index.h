@@ -0,0 +1,79 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#ifndef EVENT_INDEX_H
+#define EVENT_INDEX_H
+
+// Qt
+
+// Own
+#include <rlib/common/event_data.h>
+
+// StdLib
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Sorted event times of one measurement, split by origin (sensor index or -1
+// for global events) since each origin is drawn with its own color and
+// offset. Built once when the measurement is opened; every viewport query is
+// a binary search, so drawing does not depend on the number of events.
+class EventIndex {
+    public:
+    // Events of one pixel column (or any other bin)
+    struct Bin {
+        // Time of the first event in the bin
+        double time;
+        uint32_t count;
+    };
+
+    private:
+    struct Channel {
+        int origin;
+        std::vector< double > time;
+    };
+    // Sorted by origin
+    std::vector< Channel > _channels;
+    size_t _size = 0;
+
+    const Channel* channel(int origin) const;
+
+    public:
+    EventIndex() = default;
+    explicit EventIndex(const std::vector< rlib::common::event_data >& events);
+
+    size_t size() const;
+    // Origins which have at least one event, ascending
+    std::vector< int > origins() const;
+
+    // Number of events of origin in [begin, end)
+    size_t count(int origin, double begin, double end) const;
+
+    // Non-empty bins of [begin, begin + bins * width), each covering width.
+    // Costs one binary search per non-empty bin, i.e. at most one per pixel
+    // column when binned by pixel, however many events fall into it.
+    std::vector< Bin > histogram(
+        int origin, double begin, double width, size_t bins) const;
+};
+
+#endif // EVENT_INDEX_H
@@ -0,0 +1,142 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Qt
+
+// Own
+#include "data/event_store.h"
+#include <rlib/common/event_data.h>
+
+// StdLib
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <queue>
+#include <tuple>
+#include <utility>
+
+EventStore::EventStore(std::vector< rlib::common::event_data > events)
+    : _events(std::move(events))
+{
+    auto earlier = [](const rlib::common::event_data& a,
+                       const rlib::common::event_data& b) {
+        return a.time < b.time;
+    };
+    // Readers usually deliver them sorted already
+    if (!std::is_sorted(this->_events.begin(), this->_events.end(), earlier)) {
+        std::stable_sort(this->_events.begin(), this->_events.end(), earlier);
+    }
+
+    std::vector< int > origins;
+    for (auto& e : this->_events) {
+        origins.push_back(e.origin);
+    }
+    std::sort(origins.begin(), origins.end());
+    origins.erase(std::unique(origins.begin(), origins.end()), origins.end());
+    this->_origins = origins;
+    this->_offsets.assign(this->_origins.size(), 0.0);
+
+    // Unshifted, the drawn order is the time order
+    this->_order.resize(this->_events.size());
+    this->_time.resize(this->_events.size());
+    for (size_t i = 0; i < this->_events.size(); ++i) {
+        this->_order[ i ] = static_cast< uint32_t >(i);
+        this->_time[ i ] = this->_events[ i ].time;
+    }
+}
+
+bool EventStore::setOffsets(const std::vector< double >& offsetX)
+{
+    auto offsetOf = [&offsetX](int origin) {
+        if (origin < 0 || static_cast< size_t >(origin) >= offsetX.size()) {
+            return 0.0;
+        }
+        return offsetX[ static_cast< size_t >(origin) ];
+    };
+
+    std::vector< double > offsets;
+    for (auto origin : this->_origins) {
+        offsets.push_back(offsetOf(origin));
+    }
+    if (offsets == this->_offsets) {
+        return false;
+    }
+    this->_offsets = offsets;
+
+    // One run per origin, each already in drawn order
+    std::map< int, std::vector< uint32_t > > runs;
+    for (size_t i = 0; i < this->_events.size(); ++i) {
+        runs[ this->_events[ i ].origin ].push_back(static_cast< uint32_t >(i));
+    }
+
+    this->_order.clear();
+    this->_time.clear();
+    // (drawn time, run, position in run), smallest time first
+    typedef std::tuple< double, size_t, size_t > Head;
+    std::priority_queue< Head, std::vector< Head >, std::greater< Head > >
+        heads;
+    std::vector< std::pair< double, const std::vector< uint32_t >* > > run;
+    for (auto& r : runs) {
+        run.push_back({ offsetOf(r.first), &r.second });
+        heads.emplace(
+            this->_events[ r.second.front() ].time + run.back().first,
+            run.size() - 1, 0);
+    }
+    while (!heads.empty()) {
+        double time;
+        size_t r;
+        size_t position;
+        std::tie(time, r, position) = heads.top();
+        heads.pop();
+
+        auto& indices = *run[ r ].second;
+        this->_order.push_back(indices[ position ]);
+        this->_time.push_back(time);
+        if (++position < indices.size()) {
+            heads.emplace(
+                this->_events[ indices[ position ] ].time + run[ r ].first, r,
+                position);
+        }
+    }
+    return true;
+}
+
+size_t EventStore::size() const
+{
+    return this->_order.size();
+}
+
+bool EventStore::empty() const
+{
+    return this->_order.empty();
+}
+
+const rlib::common::event_data& EventStore::at(size_t i) const
+{
+    return this->_events[ this->_order[ i ] ];
+}
+
+double EventStore::time(size_t i) const
+{
+    return this->_time[ i ];
+}
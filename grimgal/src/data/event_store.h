@@ -0,0 +1,68 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#ifndef EVENT_STORE_H
+#define EVENT_STORE_H
+
+// Qt
+
+// Own
+#include <rlib/common/event_data.h>
+
+// StdLib
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// All events of one measurement, read once from the reader and kept in the
+// order they are drawn in: event time plus the offsetX of their sensor
+// (global events are not shifted). The events of one sensor never change
+// their relative order, so an offset change only merges the per sensor runs
+// again instead of sorting everything.
+class EventStore {
+    private:
+    // Sorted by event time
+    std::vector< rlib::common::event_data > _events;
+    // Drawn order as index into _events and the drawn time of each entry
+    std::vector< uint32_t > _order;
+    std::vector< double > _time;
+    // Offsets of the origins which occur, as of the last setOffsets()
+    std::vector< int > _origins;
+    std::vector< double > _offsets;
+
+    public:
+    explicit EventStore(std::vector< rlib::common::event_data > events);
+
+    // Reorders the events for the given offsetX of each sensor. Returns false
+    // (and does nothing) if no occurring origin moved.
+    bool setOffsets(const std::vector< double >& offsetX);
+
+    size_t size() const;
+    bool empty() const;
+
+    // i-th event in drawn order and the time it is drawn at
+    const rlib::common::event_data& at(size_t i) const;
+    double time(size_t i) const;
+};
+
+#endif // EVENT_STORE_H
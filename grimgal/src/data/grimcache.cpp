@@ -0,0 +1,704 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Qt
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
+
+// Own
+#include "data/grimcache.h"
+
+// StdLib
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace {
+    uint64_t align8(uint64_t size)
+    {
+        return (size + 7) & ~uint64_t(7);
+    }
+
+    // Bytes of one pyramid level within the sidecar
+    uint64_t levelBytes(uint64_t buckets, uint64_t sensors)
+    {
+        return buckets * sizeof(double) + align8(buckets * sizeof(uint32_t)) +
+               4 * sensors * buckets * sizeof(double) +
+               sensors * align8(buckets * sizeof(uint32_t)) +
+               sensors * align8(buckets);
+    }
+}
+
+std::vector< QString > grimcache::sidecarPaths(const QString& source)
+{
+    auto absolute = QFileInfo(source).absoluteFilePath();
+    std::vector< QString > paths = { absolute + ".grimcache" };
+
+    auto cache =
+        QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (!cache.isEmpty()) {
+        auto hash = QCryptographicHash::hash(
+            absolute.toUtf8(), QCryptographicHash::Sha1)
+                        .toHex();
+        paths.push_back(
+            cache + "/" + QString::fromLatin1(hash) + ".grimcache");
+    }
+    return paths;
+}
+
+//--// Writer
+
+grimcache::Writer::Writer(
+    const QString& source, std::shared_ptr< rlib::common::reader > reader)
+    : _source(source)
+    , _reader(reader)
+{
+    QFileInfo info(source);
+    this->_source_size = info.size();
+    this->_source_mtime = info.lastModified().toMSecsSinceEpoch();
+}
+
+std::shared_ptr< grimcache::Writer > grimcache::Writer::create(
+    const QString& source, std::shared_ptr< rlib::common::reader > reader)
+{
+    auto writer = std::make_shared< Writer >(source, reader);
+    for (auto& path : sidecarPaths(source)) {
+        QDir().mkpath(QFileInfo(path).absolutePath());
+        writer->_file.setFileName(path);
+        if (writer->_file.open(QIODevice::WriteOnly)) {
+            // Filled in by finish()
+            Header header = {};
+            writer->write(&header, sizeof(header));
+            return writer;
+        }
+    }
+    return nullptr;
+}
+
+void grimcache::Writer::setEvents(
+    std::vector< rlib::common::event_data > events)
+{
+    this->_events = std::move(events);
+}
+
+void grimcache::Writer::write(const void* data, size_t size)
+{
+    if (this->_failed || size == 0) {
+        return;
+    }
+    auto written = this->_file.write(static_cast< const char* >(data),
+        static_cast< qint64 >(size));
+    if (written != static_cast< qint64 >(size)) {
+        this->_failed = true;
+    }
+}
+
+void grimcache::Writer::align()
+{
+    static const char zero[ 8 ] = {};
+    auto pos = static_cast< uint64_t >(this->_file.pos());
+    this->write(zero, align8(pos) - pos);
+}
+
+uint64_t grimcache::Writer::addString(const std::string& string)
+{
+    auto offset = this->_strings.size();
+    this->_strings += string;
+    return offset;
+}
+
+void grimcache::Writer::append(const SampleBlock& block)
+{
+    if (this->_failed || block.empty()) {
+        return;
+    }
+    auto size = block.size();
+    ChunkEntry chunk;
+    {
+        chunk.begin = block.time()[ 0 ];
+        chunk.end = block.time()[ size - 1 ];
+        chunk.first = this->_sample_count;
+        chunk.count = size;
+        chunk.offset = static_cast< uint64_t >(this->_file.pos());
+    }
+    this->write(block.time(), size * sizeof(double));
+    for (size_t c = 0; c < block.channels().size(); ++c) {
+        this->write(block.values(c), size * sizeof(double));
+    }
+    this->_chunks.push_back(chunk);
+    this->_sample_count += size;
+}
+
+bool grimcache::Writer::finish(
+    const std::vector< SamplePyramid::Level >& levels,
+    const std::vector< SensorStatistic >& statistics)
+{
+    // A source which changed while it was read (e.g. a capture still being
+    // written) would leave a sidecar with the new key but the old data
+    QFileInfo info(this->_source);
+    if (info.size() != this->_source_size ||
+        info.lastModified().toMSecsSinceEpoch() != this->_source_mtime) {
+        this->_file.cancelWriting();
+        return false;
+    }
+
+    auto sensors = this->_reader->sensors();
+
+    Header header = {};
+    {
+        std::copy(MAGIC, MAGIC + sizeof(MAGIC), header.magic);
+        header.version = VERSION;
+        header.sensor_count = static_cast< uint32_t >(sensors.size());
+
+        auto path = info.absoluteFilePath().toStdString();
+        header.source_size = static_cast< uint64_t >(this->_source_size);
+        header.source_mtime = this->_source_mtime;
+        header.path_offset = this->addString(path);
+        header.path_length = path.size();
+        header.sample_count = this->_sample_count;
+    }
+
+    std::vector< LevelEntry > levelEntries;
+    for (auto& level : levels) {
+        auto buckets = level.time.size();
+        levelEntries.push_back({ level.interval, buckets,
+            static_cast< uint64_t >(this->_file.pos()) });
+
+        this->write(level.time.data(), buckets * sizeof(double));
+        this->write(level.count.data(), buckets * sizeof(uint32_t));
+        this->align();
+        for (auto& column : level.min) {
+            this->write(column.data(), buckets * sizeof(double));
+        }
+        for (auto& column : level.max) {
+            this->write(column.data(), buckets * sizeof(double));
+        }
+        for (auto& column : level.mean) {
+            this->write(column.data(), buckets * sizeof(double));
+        }
+        for (auto& column : level.square) {
+            this->write(column.data(), buckets * sizeof(double));
+        }
+        for (auto& column : level.valid) {
+            this->write(column.data(), buckets * sizeof(uint32_t));
+            this->align();
+        }
+        for (auto& column : level.min_first) {
+            std::vector< uint8_t > flags(column.begin(), column.end());
+            this->write(flags.data(), buckets);
+            this->align();
+        }
+    }
+
+    // All events of the source, also those before the first or after the
+    // last sample
+    std::vector< EventEntry > eventEntries;
+    {
+        auto& events = this->_events;
+        std::stable_sort(events.begin(), events.end(),
+            [](const rlib::common::event_data& a,
+                const rlib::common::event_data& b) {
+                return a.time < b.time;
+            });
+        for (auto& event : events) {
+            eventEntries.push_back({ event.time,
+                static_cast< int32_t >(event.origin),
+                static_cast< int32_t >(event.event_level),
+                this->addString(event.message), event.message.size() });
+        }
+    }
+
+    std::vector< SensorEntry > sensorEntries;
+    for (auto& sensor : sensors) {
+        sensorEntries.push_back({ sensor.sampling_interval,
+            this->addString(sensor.name), sensor.name.size(),
+            this->addString(sensor.unit), sensor.unit.size() });
+    }
+
+    header.chunk_count = this->_chunks.size();
+    header.chunk_offset = static_cast< uint64_t >(this->_file.pos());
+    this->write(
+        this->_chunks.data(), this->_chunks.size() * sizeof(ChunkEntry));
+    header.level_count = levelEntries.size();
+    header.level_offset = static_cast< uint64_t >(this->_file.pos());
+    this->write(
+        levelEntries.data(), levelEntries.size() * sizeof(LevelEntry));
+    header.event_count = eventEntries.size();
+    header.event_offset = static_cast< uint64_t >(this->_file.pos());
+    this->write(
+        eventEntries.data(), eventEntries.size() * sizeof(EventEntry));
+    header.sensor_offset = static_cast< uint64_t >(this->_file.pos());
+    this->write(
+        sensorEntries.data(), sensorEntries.size() * sizeof(SensorEntry));
+    header.statistic_offset = static_cast< uint64_t >(this->_file.pos());
+    this->write(statistics.data(), statistics.size() * sizeof(SensorStatistic));
+    header.string_offset = static_cast< uint64_t >(this->_file.pos());
+    header.string_length = this->_strings.size();
+    this->write(this->_strings.data(), this->_strings.size());
+
+    if (!this->_failed && this->_file.seek(0)) {
+        this->write(&header, sizeof(header));
+    }
+    if (this->_failed || !this->_file.commit()) {
+        this->_file.cancelWriting();
+        std::cout << QObject::tr("Could not write sidecar cache ").toStdString()
+                  << this->_file.fileName().toStdString() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+//--// Reader
+
+grimcache::Reader::~Reader()
+{
+    if (this->_data != nullptr) {
+        this->_file.unmap(this->_data);
+    }
+}
+
+std::shared_ptr< grimcache::Reader > grimcache::Reader::open(
+    const QString& source)
+{
+    QFileInfo info(source);
+    if (!info.isFile()) {
+        return nullptr;
+    }
+    for (auto& path : sidecarPaths(source)) {
+        if (!QFileInfo(path).isFile()) {
+            continue;
+        }
+        auto reader = std::make_shared< Reader >();
+        if (!reader->map(path)) {
+            continue;
+        }
+        auto& header = reader->_header;
+        if (header.source_size == static_cast< uint64_t >(info.size()) &&
+            header.source_mtime == info.lastModified().toMSecsSinceEpoch() &&
+            reader->_source == info.absoluteFilePath().toStdString()) {
+            return reader;
+        }
+    }
+    return nullptr;
+}
+
+bool grimcache::Reader::contains(
+    uint64_t offset, uint64_t count, uint64_t size) const
+{
+    return offset % 8 == 0 && offset <= this->_size &&
+           count <= (this->_size - offset) / size;
+}
+
+std::string grimcache::Reader::string(uint64_t offset, uint64_t length) const
+{
+    if (offset > this->_header.string_length ||
+        length > this->_header.string_length - offset) {
+        return std::string();
+    }
+    return std::string(
+        this->at< char >(this->_header.string_offset + offset), length);
+}
+
+bool grimcache::Reader::map(const QString& path)
+{
+    this->_file.setFileName(path);
+    if (!this->_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    this->_size = static_cast< uint64_t >(this->_file.size());
+    if (this->_size < sizeof(Header)) {
+        return false;
+    }
+    this->_data = this->_file.map(0, this->_file.size());
+    if (this->_data == nullptr) {
+        return false;
+    }
+
+    // Never trust an offset, a truncated or foreign file must not crash
+    auto& header = this->_header;
+    std::memcpy(&header, this->_data, sizeof(Header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        header.version != VERSION ||
+        !this->contains(
+            header.chunk_offset, header.chunk_count, sizeof(ChunkEntry)) ||
+        !this->contains(
+            header.level_offset, header.level_count, sizeof(LevelEntry)) ||
+        !this->contains(
+            header.event_offset, header.event_count, sizeof(EventEntry)) ||
+        !this->contains(
+            header.sensor_offset, header.sensor_count, sizeof(SensorEntry)) ||
+        !this->contains(header.statistic_offset, header.sensor_count,
+            sizeof(SensorStatistic)) ||
+        !this->contains(header.string_offset, header.string_length, 1)) {
+        return false;
+    }
+    this->_chunks = this->at< ChunkEntry >(header.chunk_offset);
+    for (uint64_t c = 0; c < header.chunk_count; ++c) {
+        auto& chunk = this->_chunks[ c ];
+        if (chunk.count > this->_size ||
+            !this->contains(chunk.offset,
+                chunk.count * (uint64_t(header.sensor_count) + 1),
+                sizeof(double))) {
+            return false;
+        }
+    }
+    auto levels = this->at< LevelEntry >(header.level_offset);
+    for (uint64_t l = 0; l < header.level_count; ++l) {
+        if (levels[ l ].bucket_count > this->_size ||
+            !this->contains(levels[ l ].offset,
+                levelBytes(levels[ l ].bucket_count, header.sensor_count),
+                1)) {
+            return false;
+        }
+    }
+    this->_events = this->at< EventEntry >(header.event_offset);
+    this->_statistics = this->at< SensorStatistic >(header.statistic_offset);
+
+    this->_source = this->string(header.path_offset, header.path_length);
+    auto sensors = this->at< SensorEntry >(header.sensor_offset);
+    for (uint32_t s = 0; s < header.sensor_count; ++s) {
+        rlib::common::sensor sensor;
+        sensor.name = this->string(sensors[ s ].name_offset,
+            sensors[ s ].name_length);
+        sensor.unit = this->string(sensors[ s ].unit_offset,
+            sensors[ s ].unit_length);
+        sensor.sampling_interval = sensors[ s ].sampling_interval;
+        this->_sensors.push_back(sensor);
+    }
+    return true;
+}
+
+const double* grimcache::Reader::column(
+    const ChunkEntry& chunk, size_t column) const
+{
+    return this->at< double >(
+        chunk.offset + column * chunk.count * sizeof(double));
+}
+
+uint64_t grimcache::Reader::stride(int_fast32_t resolution) const
+{
+    if (resolution <= 0 || this->_sensors.empty() ||
+        this->_sensors.front().sampling_interval <= 0.0) {
+        return 1;
+    }
+    auto step = 1.0 / double(resolution) /
+                this->_sensors.front().sampling_interval;
+    return std::max(uint64_t(1), static_cast< uint64_t >(step));
+}
+
+std::experimental::optional< SampleBlock > grimcache::Reader::levelBlock(
+    double begin, double end, int_fast32_t resolution,
+    const std::vector< size_t >& channels,
+    std::shared_ptr< SampleArena > arena) const
+{
+    // Coarsest level whose buckets are not wider than one requested sample
+    auto wanted = 1.0 / double(resolution);
+    auto entries = this->at< LevelEntry >(this->_header.level_offset);
+    const LevelEntry* entry = nullptr;
+    for (uint64_t l = 0; l < this->_header.level_count; ++l) {
+        if (entries[ l ].interval > wanted) {
+            break;
+        }
+        entry = entries + l;
+    }
+    if (entry == nullptr) {
+        return {};
+    }
+
+    // Same layout as written by Writer::finish()
+    auto buckets = entry->bucket_count;
+    auto sensors = uint64_t(this->_header.sensor_count);
+    auto time = this->at< double >(entry->offset);
+    auto columns = entry->offset + buckets * sizeof(double) +
+                   align8(buckets * sizeof(uint32_t));
+    auto flags = columns + 4 * sensors * buckets * sizeof(double) +
+                 sensors * align8(buckets * sizeof(uint32_t));
+
+    auto first = static_cast< uint64_t >(
+        std::lower_bound(time, time + buckets, begin - entry->interval) -
+        time);
+    auto last = static_cast< uint64_t >(
+        std::lower_bound(time + first, time + buckets, end) - time);
+
+    // Every bucket yields its minimum and maximum in the order they
+    // occurred, like SamplePyramid::samples()
+    SampleBlock block(channels, 2 * (last - first), arena);
+    for (auto b = first; b < last; ++b) {
+        block.append(time[ b ]);
+        block.append(time[ b ] + entry->interval / 2.0);
+    }
+    for (size_t c = 0; c < channels.size(); ++c) {
+        uint64_t s = channels[ c ];
+        if (s >= sensors) {
+            continue;
+        }
+        auto min = this->at< double >(columns + s * buckets * sizeof(double));
+        auto max = this->at< double >(
+            columns + (sensors + s) * buckets * sizeof(double));
+        auto minFirst = this->at< uint8_t >(flags + s * align8(buckets));
+        auto values = block.values(c);
+        for (auto b = first; b < last; ++b) {
+            auto row = 2 * (b - first);
+            values[ row ] = minFirst[ b ] ? min[ b ] : max[ b ];
+            values[ row + 1 ] = minFirst[ b ] ? max[ b ] : min[ b ];
+        }
+    }
+    block.crop(begin, end);
+    return block;
+}
+
+SampleBlock grimcache::Reader::block(double begin, double end,
+    int_fast32_t resolution, std::vector< size_t > channels,
+    std::shared_ptr< SampleArena > arena)
+{
+    struct Range {
+        const ChunkEntry* chunk;
+        uint64_t first;
+        uint64_t rows;
+    };
+
+    // Coarse requests are answered from the stored pyramid levels, or as
+    // min/max envelope of the rows where no level is fine enough. Keeping
+    // every n-th row would drop the peaks.
+    auto step = this->stride(resolution);
+    if (step > 1) {
+        auto coarse = this->levelBlock(begin, end, resolution, channels, arena);
+        if (coarse) {
+            return std::move(*coarse);
+        }
+    }
+
+    // Rows of each chunk within [begin, end)
+    auto chunks = this->_chunks;
+    auto lastChunk = chunks + this->_header.chunk_count;
+    auto chunk = std::lower_bound(chunks, lastChunk, begin,
+        [](const ChunkEntry& c, double time) { return c.end < time; });
+    std::vector< Range > ranges;
+    size_t rows = 0;
+    for (; chunk != lastChunk && chunk->begin < end; ++chunk) {
+        auto time = this->column(*chunk, 0);
+        auto first = static_cast< uint64_t >(
+            std::lower_bound(time, time + chunk->count, begin) - time);
+        auto last = static_cast< uint64_t >(
+            std::lower_bound(time + first, time + chunk->count, end) - time);
+        if (first < last) {
+            ranges.push_back({ &*chunk, first, last - first });
+            rows += last - first;
+        }
+    }
+
+    SampleBlock block(channels, rows, arena);
+    block.resize(rows);
+    size_t row = 0;
+    for (auto& range : ranges) {
+        for (size_t c = 0; c <= channels.size(); ++c) {
+            double* target = c == 0 ? block.time() : block.values(c - 1);
+            size_t column = c == 0 ? 0 : channels[ c - 1 ] + 1;
+            if (column > this->_header.sensor_count) {
+                continue;
+            }
+            auto source = this->column(*range.chunk, column) + range.first;
+            std::copy(source, source + range.rows, target + row);
+        }
+        row += range.rows;
+    }
+    if (step > 1) {
+        return envelopeSamples(block,
+            double(step) * this->_sensors.front().sampling_interval, arena);
+    }
+    return block;
+}
+
+std::vector< SamplePyramid::Level > grimcache::Reader::levels() const
+{
+    auto sensors = this->_header.sensor_count;
+    auto entries = this->at< LevelEntry >(this->_header.level_offset);
+
+    std::vector< SamplePyramid::Level > levels;
+    for (uint64_t l = 0; l < this->_header.level_count; ++l) {
+        auto buckets = entries[ l ].bucket_count;
+        auto offset = entries[ l ].offset;
+        auto doubles = [&]() {
+            auto data = this->at< double >(offset);
+            offset += buckets * sizeof(double);
+            return std::vector< double >(data, data + buckets);
+        };
+
+        SamplePyramid::Level level;
+        level.interval = entries[ l ].interval;
+        level.time = doubles();
+        {
+            auto count = this->at< uint32_t >(offset);
+            level.count.assign(count, count + buckets);
+            offset += align8(buckets * sizeof(uint32_t));
+        }
+        for (uint32_t s = 0; s < sensors; ++s) {
+            level.min.push_back(doubles());
+        }
+        for (uint32_t s = 0; s < sensors; ++s) {
+            level.max.push_back(doubles());
+        }
+        for (uint32_t s = 0; s < sensors; ++s) {
+            level.mean.push_back(doubles());
+        }
+        for (uint32_t s = 0; s < sensors; ++s) {
+            level.square.push_back(doubles());
+        }
+        for (uint32_t s = 0; s < sensors; ++s) {
+            auto valid = this->at< uint32_t >(offset);
+            level.valid.emplace_back(valid, valid + buckets);
+            offset += align8(buckets * sizeof(uint32_t));
+        }
+        for (uint32_t s = 0; s < sensors; ++s) {
+            auto flags = this->at< uint8_t >(offset);
+            level.min_first.emplace_back(flags, flags + buckets);
+            offset += align8(buckets);
+        }
+        levels.push_back(std::move(level));
+    }
+    return levels;
+}
+
+std::vector< SensorStatistic > grimcache::Reader::statistics() const
+{
+    return std::vector< SensorStatistic >(this->_statistics,
+        this->_statistics + this->_header.sensor_count);
+}
+
+std::string grimcache::Reader::filename()
+{
+    return this->_source;
+}
+
+std::vector< rlib::common::sensor > grimcache::Reader::sensors()
+{
+    return this->_sensors;
+}
+
+std::vector< rlib::common::sample > grimcache::Reader::samples(
+    double begin, double end, int_fast32_t resolution)
+{
+    std::vector< size_t > channels(this->_sensors.size());
+    for (size_t s = 0; s < channels.size(); ++s) {
+        channels[ s ] = s;
+    }
+    auto block = this->block(begin, end, resolution, channels);
+
+    std::vector< rlib::common::sample > result(block.size());
+    for (size_t r = 0; r < block.size(); ++r) {
+        result[ r ].time = block.time()[ r ];
+        result[ r ].values.resize(channels.size());
+        for (size_t c = 0; c < channels.size(); ++c) {
+            result[ r ].values[ c ] = block.values(c)[ r ];
+        }
+    }
+    return result;
+}
+
+rlib::common::sample grimcache::Reader::sample(
+    double time, int_fast32_t resolution)
+{
+    rlib::common::sample result;
+    if (this->_header.chunk_count == 0) {
+        return result;
+    }
+    // Last sample at or before time, the first one if there is none
+    auto chunks = this->_chunks;
+    auto lastChunk = chunks + this->_header.chunk_count;
+    auto chunk = std::upper_bound(chunks, lastChunk, time,
+        [](double t, const ChunkEntry& c) { return t < c.begin; });
+    if (chunk != chunks) {
+        --chunk;
+    }
+    auto times = this->column(*chunk, 0);
+    auto row = static_cast< uint64_t >(
+        std::upper_bound(times, times + chunk->count, time) - times);
+    if (row > 0) {
+        --row;
+    }
+
+    result.time = times[ row ];
+    for (size_t s = 0; s < this->_sensors.size(); ++s) {
+        result.values.push_back(this->column(*chunk, s + 1)[ row ]);
+    }
+    return result;
+}
+
+std::vector< rlib::common::event_data > grimcache::Reader::events(
+    double begin, double end)
+{
+    auto events = this->_events;
+    auto lastEvent = events + this->_header.event_count;
+    auto first = std::lower_bound(events, lastEvent, begin,
+        [](const EventEntry& e, double time) { return e.time < time; });
+
+    std::vector< rlib::common::event_data > result;
+    // A negative end asks for every event up to the last one
+    for (auto it = first;
+         it != lastEvent && (end < 0.0 || it->time <= end); ++it) {
+        rlib::common::event_data event;
+        event.time = it->time;
+        event.origin = it->origin;
+        event.event_level =
+            static_cast< rlib::common::event_data_level >(it->level);
+        event.message = this->string(it->message_offset, it->message_length);
+        result.push_back(event);
+    }
+    return result;
+}
+
+std::vector< std::experimental::optional< double > > grimcache::Reader::
+    statistic(rlib::common::statistic_data data)
+{
+    std::vector< std::experimental::optional< double > > result;
+    for (auto& statistic : this->statistics()) {
+        if (statistic.count == 0) {
+            result.push_back({});
+            continue;
+        }
+        switch (data) {
+            case rlib::common::statistic_data::MIN_VALUE:
+                result.push_back(statistic.min);
+                break;
+            case rlib::common::statistic_data::MAX_VALUE:
+                result.push_back(statistic.max);
+                break;
+            case rlib::common::statistic_data::AVG_VALUE:
+                result.push_back(statistic.mean);
+                break;
+            case rlib::common::statistic_data::MEDIAN_VALUE:
+                result.push_back(statistic.median);
+                break;
+            case rlib::common::statistic_data::VAR_VALUE:
+                result.push_back(statistic.variance);
+                break;
+            default:
+                result.push_back({});
+                break;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,246 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#ifndef GRIMCACHE_H
+#define GRIMCACHE_H
+
+// Qt
+#include <QFile>
+#include <QSaveFile>
+#include <QString>
+
+// Own
+#include "data/sample_block.h"
+#include "data/sample_pyramid.h"
+#include "data/sample_statistics.h"
+#include <rlib/common/event_data.h>
+#include <rlib/common/reader.h>
+#include <rlib/common/sample.h>
+#include <rlib/common/sensor.h>
+
+// StdLib
+#include <cstdint>
+#include <experimental/optional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Columnar sidecar cache of a measurement file. The first open of a file
+// writes it while the pyramid is built, later opens map it and answer every
+// request from the mapping without asking the original reader again.
+//
+// Layout (native byte order, every section starts 8 byte aligned):
+//   Header
+//   per chunk:  time[ count ], then value[ count ] of every sensor
+//   per level:  time[ n ], count[ n ], then min[ n ], max[ n ], mean[ n ],
+//               square[ n ], valid[ n ] and min_first[ n ] (one byte each)
+//               of every sensor
+//   ChunkEntry[ chunk_count ]
+//   LevelEntry[ level_count ]
+//   EventEntry[ event_count ], sorted by time
+//   SensorEntry[ sensor_count ]
+//   SensorStatistic[ sensor_count ]
+//   Strings: source path, sensor names and units, event messages
+namespace grimcache {
+    constexpr char MAGIC[ 8 ] = { 'G', 'R', 'I', 'M', 'C', 'A', 'C', 'H' };
+    // Sidecars of older versions may lack events, the end of the recording
+    // or the valid counts or have levels whose buckets span gaps, they are
+    // written again
+    constexpr uint32_t VERSION = 6;
+
+    struct Header {
+        char magic[ 8 ];
+        uint32_t version;
+        uint32_t sensor_count;
+        // Key of the source file, any change invalidates the sidecar
+        uint64_t source_size;
+        int64_t source_mtime;
+        uint64_t path_offset;
+        uint64_t path_length;
+
+        uint64_t sample_count;
+        uint64_t chunk_count;
+        uint64_t chunk_offset;
+        uint64_t level_count;
+        uint64_t level_offset;
+        uint64_t event_count;
+        uint64_t event_offset;
+        uint64_t sensor_offset;
+        uint64_t statistic_offset;
+        uint64_t string_offset;
+        uint64_t string_length;
+    };
+
+    struct SensorEntry {
+        double sampling_interval;
+        uint64_t name_offset;
+        uint64_t name_length;
+        uint64_t unit_offset;
+        uint64_t unit_length;
+    };
+
+    struct ChunkEntry {
+        // Time of the first and last sample
+        double begin;
+        double end;
+        // Row of the first sample within the whole recording
+        uint64_t first;
+        uint64_t count;
+        uint64_t offset;
+    };
+
+    struct LevelEntry {
+        double interval;
+        uint64_t bucket_count;
+        uint64_t offset;
+    };
+
+    struct EventEntry {
+        double time;
+        int32_t origin;
+        int32_t level;
+        uint64_t message_offset;
+        uint64_t message_length;
+    };
+
+    // Sidecar locations of a source file, next to it first and the user
+    // cache directory as fallback for read only media
+    std::vector< QString > sidecarPaths(const QString& source);
+
+    // Streams the samples of a reader into a new sidecar. Written to a
+    // temporary file which only replaces the target on finish(), so an
+    // aborted build never leaves a truncated sidecar behind.
+    class Writer {
+        private:
+        QString _source;
+        std::shared_ptr< rlib::common::reader > _reader;
+        std::vector< rlib::common::event_data > _events;
+        QSaveFile _file;
+        bool _failed = false;
+        // Key of the source when the writer was created, before anything
+        // was read
+        qint64 _source_size = 0;
+        qint64 _source_mtime = 0;
+
+        std::vector< ChunkEntry > _chunks;
+        uint64_t _sample_count = 0;
+        std::string _strings;
+
+        void write(const void* data, size_t size);
+        void align();
+        uint64_t addString(const std::string& string);
+
+        public:
+        Writer(const QString& source,
+            std::shared_ptr< rlib::common::reader > reader);
+
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+
+        // Opens the first writable sidecar location, nullptr if none is.
+        // Takes the key of the source, so it has to be called before the
+        // source is read.
+        static std::shared_ptr< Writer > create(const QString& source,
+            std::shared_ptr< rlib::common::reader > reader);
+
+        // All events of the source, read once by the caller
+        void setEvents(std::vector< rlib::common::event_data > events);
+
+        // Appends a chunk holding all sensors in order, chunks have to
+        // follow each other in time
+        void append(const SampleBlock& block);
+        // Adds the pyramid, the events, the sensors and their statistics
+        // and commits the file. Drops it instead if the source changed since
+        // create().
+        bool finish(const std::vector< SamplePyramid::Level >& levels,
+            const std::vector< SensorStatistic >& statistics);
+    };
+
+    // Reader on top of a mapped sidecar. Columns are handed out straight
+    // from the mapping, nothing is parsed on open.
+    class Reader : public rlib::common::reader, public BlockSource {
+        private:
+        QFile _file;
+        uchar* _data = nullptr;
+        uint64_t _size = 0;
+        Header _header;
+
+        std::string _source;
+        std::vector< rlib::common::sensor > _sensors;
+        const ChunkEntry* _chunks = nullptr;
+        const EventEntry* _events = nullptr;
+        const SensorStatistic* _statistics = nullptr;
+
+        template < typename T >
+        const T* at(uint64_t offset) const
+        {
+            return reinterpret_cast< const T* >(this->_data + offset);
+        }
+        bool contains(uint64_t offset, uint64_t count, uint64_t size) const;
+        std::string string(uint64_t offset, uint64_t length) const;
+        // Column of a chunk, 0 is the time and s + 1 the values of sensor s
+        const double* column(const ChunkEntry& chunk, size_t column) const;
+        // Rows of the recording per requested sample, at least 1
+        uint64_t stride(int_fast32_t resolution) const;
+        // Min/max rows from the coarsest stored level which is still fine
+        // enough for the resolution, nothing if there is none
+        std::experimental::optional< SampleBlock > levelBlock(double begin,
+            double end, int_fast32_t resolution,
+            const std::vector< size_t >& channels,
+            std::shared_ptr< SampleArena > arena) const;
+        bool map(const QString& path);
+
+        public:
+        Reader() = default;
+        virtual ~Reader();
+
+        // Maps the sidecar of source if one exists and still matches its
+        // size and modification time, nullptr otherwise
+        static std::shared_ptr< Reader > open(const QString& source);
+
+        // Samples in [begin, end) as columns of the given sensors, copied
+        // straight out of the mapping. Coarse requests get the min/max rows
+        // of the stored levels instead of every sample.
+        virtual SampleBlock block(double begin, double end,
+            int_fast32_t resolution, std::vector< size_t > channels,
+            std::shared_ptr< SampleArena > arena =
+                SampleArena::global()) override;
+        // Pyramid and statistics stored with the samples, gathered on the
+        // first open
+        std::vector< SamplePyramid::Level > levels() const;
+        std::vector< SensorStatistic > statistics() const;
+
+        virtual std::string filename() override;
+        virtual std::vector< rlib::common::sensor > sensors() override;
+        virtual std::vector< rlib::common::sample > samples(
+            double begin, double end, int_fast32_t resolution) override;
+        virtual rlib::common::sample sample(
+            double time, int_fast32_t resolution) override;
+        virtual std::vector< rlib::common::event_data > events(
+            double begin, double end) override;
+        virtual std::vector< std::experimental::optional< double > > statistic(
+            rlib::common::statistic_data data) override;
+    };
+}
+
+#endif // GRIMCACHE_H
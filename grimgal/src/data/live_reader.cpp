@@ -0,0 +1,255 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Qt
+
+// Own
+#include "data/live_reader.h"
+
+// StdLib
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+constexpr std::chrono::milliseconds LiveReader::POLL_INTERVAL;
+
+LiveReader::LiveReader(
+    std::shared_ptr< rlib::common::reader > source, size_t capacity)
+    : _source(source)
+    , _filename(source->filename())
+    , _sensors(source->sensors())
+    , _sampling_interval(0.0)
+    , _ring(this->_sensors.size(), capacity)
+    , _stop(false)
+{
+    if (!this->_sensors.empty()) {
+        this->_sampling_interval = this->_sensors.at(0).sampling_interval;
+    }
+}
+
+LiveReader::~LiveReader()
+{
+    this->_stop = true;
+    if (this->_ingest.joinable()) {
+        this->_ingest.join();
+    }
+}
+
+void LiveReader::start(std::shared_ptr< SamplePyramid > pyramid)
+{
+    {
+        std::lock_guard< std::mutex > lock(this->_pyramid_mutex);
+        this->_pyramid = pyramid;
+    }
+    if (!this->_ingest.joinable()) {
+        this->_ingest = std::thread([this]() { this->ingest(); });
+    }
+}
+
+int_fast32_t LiveReader::resolution() const
+{
+    if (this->_sampling_interval <= 0.0) {
+        return 1;
+    }
+    return static_cast< int_fast32_t >(
+        std::ceil(1.0 / this->_sampling_interval));
+}
+
+void LiveReader::ingest()
+{
+    std::vector< size_t > channels(this->_sensors.size());
+    std::iota(channels.begin(), channels.end(), size_t(0));
+    // Only one block is alive at a time, its buffer is reused by the next
+    auto arena = std::make_shared< SampleArena >();
+    auto resolution = this->resolution();
+    auto next = 0.0;
+    auto inf = std::numeric_limits< double >::infinity();
+    // Time of the newest row appended so far
+    auto last = -inf;
+
+    while (!this->_stop) {
+        SampleBlock block;
+        {
+            std::lock_guard< std::mutex > lock(this->_source_mutex);
+            block = readSamples(*this->_source, next,
+                std::numeric_limits< double >::max(), resolution, channels,
+                arena);
+        }
+        // A source which maps the request to sample indices may round the
+        // begin back onto the newest sample, it must not be counted twice
+        block.crop(std::nextafter(last, inf), inf);
+        if (block.empty()) {
+            std::this_thread::sleep_for(POLL_INTERVAL);
+            continue;
+        }
+
+        this->_ring.append(block);
+        std::shared_ptr< SamplePyramid > pyramid;
+        {
+            std::lock_guard< std::mutex > lock(this->_pyramid_mutex);
+            pyramid = this->_pyramid.lock();
+        }
+        if (pyramid) {
+            pyramid->append(block);
+        }
+        // Requests are half open, the next one starts right behind the
+        // newest sample
+        last = block.time()[ block.size() - 1 ];
+        next = std::nextafter(last, inf);
+    }
+}
+
+uint64_t LiveReader::revision() const
+{
+    return this->_ring.written();
+}
+
+bool LiveReader::growing() const
+{
+    return true;
+}
+
+std::experimental::optional< double > LiveReader::newest() const
+{
+    return this->_ring.newest();
+}
+
+SampleBlock LiveReader::block(double begin, double end,
+    int_fast32_t resolution, std::vector< size_t > channels,
+    std::shared_ptr< SampleArena > arena)
+{
+    auto oldest = this->_ring.oldest();
+    if (oldest && begin >= *oldest) {
+        return this->_ring.read(begin, end, channels, arena);
+    }
+
+    // Part of the range has already left the ring (or nothing has been
+    // received yet), that part is asked from the source
+    auto split = oldest ? std::min(*oldest, end) : end;
+    SampleBlock result;
+    {
+        std::lock_guard< std::mutex > lock(this->_source_mutex);
+        result = readSamples(
+            *this->_source, begin, split, resolution, channels, arena);
+    }
+    if (split < end) {
+        auto recent = this->_ring.read(split, end, channels, arena);
+        auto size = result.size();
+        result.resize(size + recent.size());
+        std::copy(recent.time(), recent.time() + recent.size(),
+            result.time() + size);
+        for (size_t c = 0; c < channels.size(); ++c) {
+            std::copy(recent.values(c), recent.values(c) + recent.size(),
+                result.values(c) + size);
+        }
+    }
+    return result;
+}
+
+std::string LiveReader::filename()
+{
+    return this->_filename;
+}
+
+std::vector< rlib::common::sensor > LiveReader::sensors()
+{
+    return this->_sensors;
+}
+
+std::vector< rlib::common::sample > LiveReader::samples(
+    double begin, double end, int_fast32_t resolution)
+{
+    std::vector< size_t > channels(this->_sensors.size());
+    std::iota(channels.begin(), channels.end(), size_t(0));
+    auto block = this->block(begin, end, resolution, channels);
+
+    std::vector< rlib::common::sample > result(block.size());
+    for (size_t r = 0; r < block.size(); ++r) {
+        result[ r ].time = block.time()[ r ];
+        result[ r ].values.resize(channels.size());
+        for (size_t c = 0; c < channels.size(); ++c) {
+            result[ r ].values[ c ] = block.values(c)[ r ];
+        }
+    }
+    return result;
+}
+
+rlib::common::sample LiveReader::sample(double time, int_fast32_t resolution)
+{
+    std::lock_guard< std::mutex > lock(this->_source_mutex);
+    return this->_source->sample(time, resolution);
+}
+
+std::vector< rlib::common::event_data > LiveReader::events(
+    double begin, double end)
+{
+    std::lock_guard< std::mutex > lock(this->_source_mutex);
+    return this->_source->events(begin, end);
+}
+
+std::vector< std::experimental::optional< double > > LiveReader::statistic(
+    rlib::common::statistic_data data)
+{
+    std::shared_ptr< SamplePyramid > pyramid;
+    {
+        std::lock_guard< std::mutex > lock(this->_pyramid_mutex);
+        pyramid = this->_pyramid.lock();
+    }
+    std::vector< std::experimental::optional< double > > result(
+        this->_sensors.size());
+    std::experimental::optional< std::vector< SensorStatistic > > statistics;
+    if (pyramid) {
+        statistics = pyramid->statistics();
+    }
+    if (!statistics) {
+        return result;
+    }
+    // Figures of everything received so far
+    for (size_t s = 0; s < statistics->size() && s < result.size(); ++s) {
+        auto& statistic = statistics->at(s);
+        if (statistic.count == 0) {
+            continue;
+        }
+        switch (data) {
+            case rlib::common::statistic_data::MIN_VALUE:
+                result[ s ] = statistic.min;
+                break;
+            case rlib::common::statistic_data::MAX_VALUE:
+                result[ s ] = statistic.max;
+                break;
+            case rlib::common::statistic_data::AVG_VALUE:
+                result[ s ] = statistic.mean;
+                break;
+            case rlib::common::statistic_data::MEDIAN_VALUE:
+                result[ s ] = statistic.median;
+                break;
+            case rlib::common::statistic_data::VAR_VALUE:
+                result[ s ] = statistic.variance;
+                break;
+            default:
+                break;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,111 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#ifndef LIVE_READER_H
+#define LIVE_READER_H
+
+// Qt
+
+// Own
+#include "data/sample_block.h"
+#include "data/sample_pyramid.h"
+#include "data/sample_ring.h"
+#include <rlib/common/reader.h>
+
+// StdLib
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <experimental/optional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Reader in front of a source which keeps growing while it is open, e.g. a
+// remote capture. An ingest thread polls the source for samples behind the
+// newest one it has seen and appends them to a ring of the newest samples
+// and to the live pyramid, so the plot, the pyramid and the statistics grow
+// with the capture instead of being read again from the start. Requests
+// within the ring never touch the source, older ones are forwarded to it.
+class LiveReader : public rlib::common::reader, public BlockSource {
+    public:
+    // Sleep of the ingest thread if the source had nothing new
+    static constexpr std::chrono::milliseconds POLL_INTERVAL{ 10 };
+
+    private:
+    std::shared_ptr< rlib::common::reader > _source;
+    // Sources are not thread safe, the ingest thread and the readers of
+    // samples older than the ring take turns
+    std::mutex _source_mutex;
+    std::string _filename;
+    std::vector< rlib::common::sensor > _sensors;
+    double _sampling_interval;
+
+    SampleRing _ring;
+    std::mutex _pyramid_mutex;
+    std::weak_ptr< SamplePyramid > _pyramid;
+
+    std::atomic< bool > _stop;
+    std::thread _ingest;
+
+    void ingest();
+    int_fast32_t resolution() const;
+
+    public:
+    LiveReader(std::shared_ptr< rlib::common::reader > source,
+        size_t capacity = SampleRing::DEFAULT_CAPACITY);
+    virtual ~LiveReader();
+
+    LiveReader(const LiveReader&) = delete;
+    LiveReader& operator=(const LiveReader&) = delete;
+
+    // Starts ingesting, every new sample is appended to pyramid as well
+    // (which has to be a live pyramid of this reader)
+    void start(std::shared_ptr< SamplePyramid > pyramid);
+
+    // Number of samples received so far, changes whenever new data arrived
+    uint64_t revision() const;
+    virtual bool growing() const override;
+    // Time of the newest sample received so far
+    virtual std::experimental::optional< double > newest() const override;
+
+    // Samples in [begin, end) as columns of the given sensors
+    virtual SampleBlock block(double begin, double end,
+        int_fast32_t resolution, std::vector< size_t > channels,
+        std::shared_ptr< SampleArena > arena =
+            SampleArena::global()) override;
+
+    virtual std::string filename() override;
+    virtual std::vector< rlib::common::sensor > sensors() override;
+    virtual std::vector< rlib::common::sample > samples(
+        double begin, double end, int_fast32_t resolution) override;
+    virtual rlib::common::sample sample(
+        double time, int_fast32_t resolution) override;
+    virtual std::vector< rlib::common::event_data > events(
+        double begin, double end) override;
+    virtual std::vector< std::experimental::optional< double > > statistic(
+        rlib::common::statistic_data data) override;
+};
+
+#endif // LIVE_READER_H
@@ -0,0 +1,131 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Qt
+
+// Own
+#include "data/loopback_reader.h"
+
+// StdLib
+#include <algorithm>
+#include <cmath>
+
+constexpr size_t LoopbackReader::DEFAULT_SENSORS;
+constexpr double LoopbackReader::DEFAULT_RATE;
+constexpr uint64_t LoopbackReader::MAX_BATCH;
+
+LoopbackReader::LoopbackReader(
+    std::string filename, size_t sensors, double rate)
+    : _filename(filename)
+    , _sensors(sensors)
+    , _rate(rate)
+    , _start(std::chrono::steady_clock::now())
+{
+}
+
+double LoopbackReader::elapsed() const
+{
+    return std::chrono::duration< double >(
+        std::chrono::steady_clock::now() - this->_start)
+        .count();
+}
+
+double LoopbackReader::value(size_t sensor, uint64_t index) const
+{
+    // Sine of a different frequency per sensor plus a slow ramp, cheap and
+    // easy to recognise in the plot
+    auto time = double(index) / this->_rate;
+    auto frequency = 0.5 * double(sensor + 1);
+    return std::sin(2.0 * M_PI * frequency * time) * double(sensor + 1) +
+           std::fmod(time, 10.0) * 0.1;
+}
+
+rlib::common::sample LoopbackReader::at(uint64_t index) const
+{
+    rlib::common::sample result;
+    result.time = double(index) / this->_rate;
+    result.values.resize(this->_sensors);
+    for (size_t s = 0; s < this->_sensors; ++s) {
+        result.values[ s ] = this->value(s, index);
+    }
+    return result;
+}
+
+std::string LoopbackReader::filename()
+{
+    return this->_filename;
+}
+
+std::vector< rlib::common::sensor > LoopbackReader::sensors()
+{
+    std::vector< rlib::common::sensor > result(this->_sensors);
+    for (size_t s = 0; s < this->_sensors; ++s) {
+        result[ s ].name = "Loopback " + std::to_string(s);
+        result[ s ].unit = "V";
+        result[ s ].sampling_interval = 1.0 / this->_rate;
+    }
+    return result;
+}
+
+std::vector< rlib::common::sample > LoopbackReader::samples(
+    double begin, double end, int_fast32_t resolution)
+{
+    // Every sample is delivered, the resolution only matters for files
+    auto available = this->elapsed();
+    end = std::min(end, available);
+    std::vector< rlib::common::sample > result;
+    if (begin >= end) {
+        return result;
+    }
+    auto first = static_cast< uint64_t >(
+        std::ceil(std::max(begin, 0.0) * this->_rate));
+    auto last = static_cast< uint64_t >(std::ceil(end * this->_rate));
+    last = std::min(last, first + MAX_BATCH);
+    result.reserve(last - first);
+    for (auto index = first; index < last; ++index) {
+        result.push_back(this->at(index));
+    }
+    return result;
+}
+
+rlib::common::sample LoopbackReader::sample(
+    double time, int_fast32_t resolution)
+{
+    // Last available sample at or before time
+    time = std::min(time, this->elapsed());
+    return this->at(
+        static_cast< uint64_t >(std::floor(std::max(time, 0.0) * this->_rate)));
+}
+
+std::vector< rlib::common::event_data > LoopbackReader::events(
+    double begin, double end)
+{
+    return {};
+}
+
+std::vector< std::experimental::optional< double > > LoopbackReader::
+    statistic(rlib::common::statistic_data data)
+{
+    return std::vector< std::experimental::optional< double > >(
+        this->_sensors);
+}
@@ -0,0 +1,78 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#ifndef LOOPBACK_READER_H
+#define LOOPBACK_READER_H
+
+// Qt
+
+// Own
+#include <rlib/common/reader.h>
+
+// StdLib
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Local stand-in for a remote capture: synthetic waveforms which become
+// available in real time, sample n not before n / rate seconds after the
+// reader was created. Used to try the live mode and to measure ingest
+// throughput and latency without hardware.
+class LoopbackReader : public rlib::common::reader {
+    public:
+    static constexpr size_t DEFAULT_SENSORS = 4;
+    static constexpr double DEFAULT_RATE = 10000.0;
+    // Most samples handed out by a single request, like a network read
+    static constexpr uint64_t MAX_BATCH = 65536;
+
+    private:
+    std::string _filename;
+    size_t _sensors;
+    double _rate;
+    std::chrono::steady_clock::time_point _start;
+
+    double value(size_t sensor, uint64_t index) const;
+    rlib::common::sample at(uint64_t index) const;
+
+    public:
+    LoopbackReader(std::string filename, size_t sensors = DEFAULT_SENSORS,
+        double rate = DEFAULT_RATE);
+
+    // Seconds since the reader was created, every sample up to this time is
+    // available
+    double elapsed() const;
+
+    virtual std::string filename() override;
+    virtual std::vector< rlib::common::sensor > sensors() override;
+    virtual std::vector< rlib::common::sample > samples(
+        double begin, double end, int_fast32_t resolution) override;
+    virtual rlib::common::sample sample(
+        double time, int_fast32_t resolution) override;
+    virtual std::vector< rlib::common::event_data > events(
+        double begin, double end) override;
+    virtual std::vector< std::experimental::optional< double > > statistic(
+        rlib::common::statistic_data data) override;
+};
+
+#endif // LOOPBACK_READER_H
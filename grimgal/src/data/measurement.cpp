@@ -27,9 +27,24 @@
 // Own
 #include "data/measurement.h"
 
-void Measurement::setReader(std::shared_ptr< rlib::common::reader > reader)
+void Measurement::setReader(std::shared_ptr< rlib::common::reader > reader,
+    std::shared_ptr< SamplePyramid > pyramid,
+    std::shared_ptr< EventIndex > events,
+    std::shared_ptr< const std::vector< rlib::common::event_data > >
+        eventData,
+    std::shared_ptr< rlib::common::reader > source)
 {
     this->reader = reader;
+    this->source = source ? source : reader;
+    this->pyramid = pyramid;
+    this->events = events;
+    this->eventData = eventData;
+    if (!this->events || !this->eventData) {
+        auto data = std::make_shared< std::vector< rlib::common::event_data > >(
+            this->reader->events(0.0, -1.0));
+        this->events = std::make_shared< EventIndex >(*data);
+        this->eventData = data;
+    }
     this->name = QString::fromStdString(this->reader->filename());
     for (auto& sensor : this->reader->sensors()) {
         this->sensorName.push_back(QString::fromStdString(sensor.name));
@@ -35,6 +35,9 @@
 #include <vector>
 
 // Own
+#include "data/event_index.h"
+#include "data/sample_pyramid.h"
+#include <rlib/common/event_data.h>
 #include <rlib/common/reader.h>
 
 enum class LINE_TYPE : int {
@@ -56,6 +59,17 @@ inline std::string to_string(LINE_TYPE c)
 class Measurement {
     public:
     std::shared_ptr< rlib::common::reader > reader;
+    // Same data as reader but safe to read from any thread, for work off
+    // the tile loader (range figures, probes, export). Never nullptr once a
+    // reader is set.
+    std::shared_ptr< rlib::common::reader > source;
+    std::shared_ptr< SamplePyramid > pyramid;
+    // Event times for drawing, never nullptr once a reader is set
+    std::shared_ptr< EventIndex > events;
+    // All events as read on open, for the event table, never nullptr once a
+    // reader is set
+    std::shared_ptr< const std::vector< rlib::common::event_data > >
+        eventData;
     // PROPERTIES
     QString name;
     std::vector< QString > sensorName;
@@ -68,7 +82,14 @@ class Measurement {
     std::vector< LINE_TYPE > line_types;
 
     public:
-    void setReader(std::shared_ptr< rlib::common::reader > reader);
+    // Without events they are read and indexed at once, without a source
+    // the reader has to be thread safe itself
+    void setReader(std::shared_ptr< rlib::common::reader > reader,
+        std::shared_ptr< SamplePyramid > pyramid = nullptr,
+        std::shared_ptr< EventIndex > events = nullptr,
+        std::shared_ptr< const std::vector< rlib::common::event_data > >
+            eventData = nullptr,
+        std::shared_ptr< rlib::common::reader > source = nullptr);
 };
 
 #endif // MEASURMENT_H
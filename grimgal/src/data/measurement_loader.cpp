@@ -0,0 +1,157 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Qt
+#include <QRunnable>
+#include <QThread>
+
+// Own
+#include "data/measurement_loader.h"
+
+// StdLib
+#include <algorithm>
+#include <exception>
+#include <iostream>
+
+namespace {
+    class OpenTask : public QRunnable {
+        private:
+        std::function< void() > _task;
+
+        public:
+        OpenTask(std::function< void() > task)
+            : _task(task)
+        {
+        }
+
+        virtual void run() override
+        {
+            this->_task();
+        }
+    };
+}
+
+MeasurementLoader::MeasurementLoader(QObject* parent)
+    : QObject(parent)
+{
+    // Opening is mostly waiting for the disk, every file gets its own thread
+    this->_pool.setMaxThreadCount(std::max(4, QThread::idealThreadCount()));
+}
+
+MeasurementLoader::~MeasurementLoader()
+{
+    this->cancelAll();
+    this->_pool.clear();
+    this->_pool.waitForDone();
+}
+
+quint64 MeasurementLoader::load(QString filename, Open open)
+{
+    quint64 id;
+    {
+        std::lock_guard< std::mutex > lock(this->_mutex);
+        id = this->_next_id++;
+        this->_jobs[ id ].filename = filename;
+    }
+    this->_pool.start(
+        new OpenTask([this, id, open]() { this->run(id, open); }));
+    return id;
+}
+
+void MeasurementLoader::run(quint64 id, Open open)
+{
+    {
+        std::lock_guard< std::mutex > lock(this->_mutex);
+        auto job = this->_jobs.find(id);
+        if (job == this->_jobs.end() || job->second.cancelled) {
+            this->_jobs.erase(id);
+            return;
+        }
+    }
+
+    std::experimental::optional< Opened > result;
+    // An exception must not take down the worker (and the application)
+    try {
+        result = open();
+    }
+    catch (const std::exception& e) {
+        std::cout << QObject::tr("Could not load file ").toStdString()
+                  << this->filename(id).toStdString()
+                  << QObject::tr(" Reason: ").toStdString() << e.what()
+                  << std::endl;
+    }
+
+    {
+        std::lock_guard< std::mutex > lock(this->_mutex);
+        auto job = this->_jobs.find(id);
+        if (job == this->_jobs.end() || job->second.cancelled) {
+            this->_jobs.erase(id);
+            return;
+        }
+        job->second.result = std::move(result);
+    }
+    emit this->loaded(id);
+}
+
+void MeasurementLoader::cancel(quint64 id)
+{
+    std::lock_guard< std::mutex > lock(this->_mutex);
+    auto job = this->_jobs.find(id);
+    if (job != this->_jobs.end()) {
+        job->second.cancelled = true;
+    }
+}
+
+void MeasurementLoader::cancelAll()
+{
+    std::lock_guard< std::mutex > lock(this->_mutex);
+    for (auto& job : this->_jobs) {
+        job.second.cancelled = true;
+    }
+}
+
+std::experimental::optional< MeasurementLoader::Opened >
+    MeasurementLoader::take(quint64 id)
+{
+    std::lock_guard< std::mutex > lock(this->_mutex);
+    auto job = this->_jobs.find(id);
+    if (job == this->_jobs.end()) {
+        return {};
+    }
+    std::experimental::optional< Opened > result;
+    if (!job->second.cancelled) {
+        result = std::move(job->second.result);
+    }
+    this->_jobs.erase(job);
+    return result;
+}
+
+QString MeasurementLoader::filename(quint64 id)
+{
+    std::lock_guard< std::mutex > lock(this->_mutex);
+    auto job = this->_jobs.find(id);
+    if (job == this->_jobs.end()) {
+        return QString();
+    }
+    return job->second.filename;
+}
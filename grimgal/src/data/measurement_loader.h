@@ -0,0 +1,104 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#ifndef MEASUREMENT_LOADER_H
+#define MEASUREMENT_LOADER_H
+
+// Qt
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+
+// Own
+#include "data/event_index.h"
+#include "data/sample_pyramid.h"
+#include <rlib/common/event_data.h>
+#include <rlib/common/reader.h>
+
+// StdLib
+#include <experimental/optional>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Opens measurement files on a worker pool, one file per thread, so adding
+// several files takes about as long as the slowest one. loaded() is emitted
+// (and delivered queued) once a file is open, the result is then picked up
+// with take() on the GUI thread.
+class MeasurementLoader : public QObject {
+    Q_OBJECT
+
+    public:
+    struct Opened {
+        std::shared_ptr< rlib::common::reader > reader;
+        std::shared_ptr< SamplePyramid > pyramid;
+        std::shared_ptr< EventIndex > events;
+        // Events as read on the worker, so the event table does not have to
+        // read them again
+        std::shared_ptr< const std::vector< rlib::common::event_data > >
+            eventData;
+        // Thread safe reader of the same data, see Measurement::source.
+        // nullptr if reader is thread safe itself.
+        std::shared_ptr< rlib::common::reader > source;
+    };
+    // Constructs the reader, called on a worker thread. Returns nothing if
+    // the file can not be read.
+    typedef std::function< std::experimental::optional< Opened >() > Open;
+
+    private:
+    struct Job {
+        QString filename;
+        bool cancelled = false;
+        std::experimental::optional< Opened > result;
+    };
+
+    QThreadPool _pool;
+
+    std::mutex _mutex;
+    quint64 _next_id = 0;
+    std::map< quint64, Job > _jobs;
+
+    void run(quint64 id, Open open);
+
+    public:
+    MeasurementLoader(QObject* parent = Q_NULLPTR);
+    virtual ~MeasurementLoader();
+
+    // Queues a file and returns the id of the load
+    quint64 load(QString filename, Open open);
+    // A reader which is being constructed can not be interrupted, its
+    // result is dropped once it is done
+    void cancel(quint64 id);
+    void cancelAll();
+
+    // Result of a finished load, nothing if it failed. Forgets the load.
+    std::experimental::optional< Opened > take(quint64 id);
+    QString filename(quint64 id);
+
+    signals:
+    void loaded(quint64 id);
+};
+
+#endif // MEASUREMENT_LOADER_H
@@ -0,0 +1,116 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Qt
+#include <QColor>
+#include <QDomDocument>
+#include <QDomNodeList>
+#include <QFile>
+
+// Own
+#include "data/project_file.h"
+
+// StdLib
+#include <functional>
+
+namespace {
+    // Calls f with the index and text of every child of the named element
+    void each(const QDomElement& element, const QString& name,
+        std::function< void(size_t, QString) > f)
+    {
+        auto childNodes = element.firstChildElement(name).childNodes();
+        for (int k = 0; k < childNodes.size(); k++) {
+            f(static_cast< size_t >(k), childNodes.at(k).toElement().text());
+        }
+    }
+}
+
+std::experimental::optional< ProjectFile > ProjectFile::read(QString filename)
+{
+    QDomDocument projectXml;
+    {
+        QFile file(filename);
+        if (!file.open(QIODevice::ReadOnly) || !projectXml.setContent(&file)) {
+            return {};
+        }
+    }
+
+    ProjectFile result;
+    QDomElement projectElement = projectXml.documentElement();
+    QDomNodeList measurementsChildNodes =
+        projectElement.firstChildElement("measurements").childNodes();
+    for (int i = 0; i < measurementsChildNodes.length(); i++) {
+        Entry entry;
+        entry.element = measurementsChildNodes.at(i).toElement();
+        entry.file = entry.element.firstChildElement("file").text();
+        result.measurements.push_back(entry);
+    }
+
+    QDomNodeList probeNodes =
+        projectElement.firstChildElement("probes").childNodes();
+    for (int k = 0; k < probeNodes.size(); k++) {
+        result.probes.push_back(probeNodes.at(k).toElement().text().toDouble());
+    }
+    return result;
+}
+
+void ProjectFile::apply(Measurement& measurement, const QDomElement& element)
+{
+    measurement.name = element.firstChildElement("name").text();
+
+    each(element, "sensorname", [&measurement](size_t k, QString text) {
+        if (k < measurement.sensorName.size()) {
+            measurement.sensorName[ k ] = text;
+        }
+    });
+    each(element, "unitfactor", [&measurement](size_t k, QString text) {
+        if (k < measurement.unitFactor.size()) {
+            measurement.unitFactor[ k ] = text.toLongLong();
+        }
+    });
+    each(element, "offsetx", [&measurement](size_t k, QString text) {
+        if (k < measurement.offsetX.size()) {
+            measurement.offsetX[ k ] = text.toDouble();
+        }
+    });
+    each(element, "offsety", [&measurement](size_t k, QString text) {
+        if (k < measurement.offsetY.size()) {
+            measurement.offsetY[ k ] = text.toDouble();
+        }
+    });
+    each(element, "visible", [&measurement](size_t k, QString text) {
+        if (k < measurement.visible.size()) {
+            measurement.visible[ k ] = text.toInt() == 1;
+        }
+    });
+    each(element, "color", [&measurement](size_t k, QString text) {
+        if (k < measurement.color.size()) {
+            measurement.color[ k ] = QColor(text);
+        }
+    });
+    each(element, "comment", [&measurement](size_t k, QString text) {
+        if (k < measurement.comment.size()) {
+            measurement.comment[ k ] = text;
+        }
+    });
+}
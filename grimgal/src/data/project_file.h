@@ -0,0 +1,60 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#ifndef PROJECT_FILE_H
+#define PROJECT_FILE_H
+
+// Qt
+#include <QDomElement>
+#include <QString>
+
+// Own
+#include "data/measurement.h"
+
+// StdLib
+#include <experimental/optional>
+#include <vector>
+
+// Contents of a .project file as written by MainWindow::saveProject(), read
+// without a window so the batch mode can open projects as well
+struct ProjectFile {
+    struct Entry {
+        QString file;
+        // Stored properties of the measurement, see apply()
+        QDomElement element;
+    };
+
+    std::vector< Entry > measurements;
+    // Probe times
+    std::vector< double > probes;
+
+    // Returns nothing if the file can not be read or parsed
+    static std::experimental::optional< ProjectFile > read(QString filename);
+
+    // Applies names, unit factors, offsets, visibility, colors and comments
+    // of an entry to the measurement opened from its file. Values for
+    // sensors the measurement does not have are ignored.
+    static void apply(Measurement& measurement, const QDomElement& element);
+};
+
+#endif // PROJECT_FILE_H
@@ -0,0 +1,190 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Qt
+
+// Own
+#include "data/event_index.h"
+#include "data/grimcache.h"
+#include "data/live_reader.h"
+#include "data/loopback_reader.h"
+#include "data/reader_registry.h"
+#include "data/sample_pyramid.h"
+#include "data/serial_reader.h"
+#include <rlib/android/meta_reader.h>
+#include <rlib/common/cached_reader.h>
+#include <rlib/common/statistic_reader.h>
+#include <rlib/csv/csv_reader.h>
+#include <rlib/grim/grim_reader.h>
+#include <rlib/keysight/dlog_reader.h>
+#include <rlib/powerscale/psi_reader.h>
+#include <rlib/remote/reader.h>
+#include <rlib/xml/xml_reader.h>
+
+// StdLib
+
+namespace {
+    // All events of a reader, read once for the index and the event table
+    std::shared_ptr< const std::vector< rlib::common::event_data > >
+        readEvents(rlib::common::reader& reader)
+    {
+        typedef std::vector< rlib::common::event_data > Events;
+        return std::make_shared< const Events >(reader.events(0.0, -1.0));
+    }
+}
+
+ReaderRegistry::ReaderRegistry()
+{
+    this->add("Keysight;.dlog", [](QString file) {
+        return std::make_shared< rlib::keysight::dlog_reader >(
+            file.toStdString());
+    });
+    this->add("Powerscale;.psi", [](QString file) {
+        return std::make_shared< rlib::powerscale::psi_reader >(
+            file.toStdString());
+    });
+    this->add("Android;.meta", [](QString file) {
+        return std::make_shared< rlib::android::meta_reader >(
+            file.toStdString());
+    });
+    this->add("Grimgal;.grim", [](QString file) {
+        return std::make_shared< rlib::grim::grim_reader >(file.toStdString());
+    });
+    this->add("Grimgal CSV;.csv", [](QString file) {
+        return std::make_shared< rlib::csv::csv_reader >(file.toStdString());
+    });
+    this->add("Grimgal XML;.xml", [](QString file) {
+        return std::make_shared< rlib::xml::xml_reader >(file.toStdString());
+    });
+    // Remote captures keep growing, they are streamed into the plot
+    this->add("Remote;.remote", [](QString file) {
+        return std::make_shared< LiveReader >(
+            std::make_shared< rlib::remote::reader >(
+                file.toStdString(), 1, 8888, 1));
+    });
+    this->add("Loopback;.loopback", [](QString file) {
+        return std::make_shared< LiveReader >(
+            std::make_shared< LoopbackReader >(file.toStdString()));
+    });
+}
+
+void ReaderRegistry::add(QString format, Factory factory)
+{
+    this->_formats.insert_or_assign(format, factory);
+}
+
+const std::map< QString, ReaderRegistry::Factory >& ReaderRegistry::
+    formats() const
+{
+    return this->_formats;
+}
+
+std::experimental::optional< MeasurementLoader::Opened > ReaderRegistry::open(
+    QString filename, bool useStatisticReader, bool useCachedReader,
+    bool useSidecarCache) const
+{
+    // A sidecar of an earlier open answers everything by itself
+    if (useSidecarCache) {
+        auto cache = grimcache::Reader::open(filename);
+        if (cache) {
+            auto events = readEvents(*cache);
+            return MeasurementLoader::Opened{ cache,
+                std::make_shared< SamplePyramid >(
+                    cache, cache->levels(), cache->statistics()),
+                std::make_shared< EventIndex >(*events), events };
+        }
+    }
+    // Look for a reader
+    for (auto& tuple : this->_formats) {
+        auto ext = std::get< 0 >(tuple).section(';', 1, 1);
+        if (filename.endsWith(ext)) {
+            auto reader = std::get< 1 >(tuple)(filename);
+            // Live data grows with every append, neither the rlib caches nor
+            // a sidecar would stay valid
+            auto live = std::dynamic_pointer_cast< LiveReader >(reader);
+            if (live) {
+                auto events = readEvents(*live);
+                auto pyramid = SamplePyramid::live(live);
+                live->start(pyramid);
+                return MeasurementLoader::Opened{ live, pyramid,
+                    std::make_shared< EventIndex >(*events), events };
+            }
+            // Files are read by the pyramid builder, the tile loader and the
+            // exporter at the same time, they take turns on one reader
+            auto serial = std::make_shared< SerialReader >(reader);
+            auto measurement_reader =
+                wrap(serial, useStatisticReader, useCachedReader);
+            // The pyramid walks the whole file once, build it from the
+            // plain reader so the cached_reader is not flooded. The same
+            // walk writes the sidecar for the next open, its key is taken
+            // before anything else is read.
+            std::shared_ptr< grimcache::Writer > writer;
+            if (useSidecarCache) {
+                writer = grimcache::Writer::create(filename, serial);
+            }
+            // Events are read once, before the builder starts, and shared
+            // by the index and the sidecar
+            auto events = readEvents(*serial);
+            auto index = std::make_shared< EventIndex >(*events);
+            if (writer) {
+                writer->setEvents(*events);
+            }
+            return MeasurementLoader::Opened{ measurement_reader,
+                std::make_shared< SamplePyramid >(serial, writer), index,
+                events, serial };
+        }
+    }
+    return {};
+}
+
+std::shared_ptr< rlib::common::reader > ReaderRegistry::wrap(
+    std::shared_ptr< rlib::common::reader > source, bool useStatisticReader,
+    bool useCachedReader)
+{
+    auto reader = source;
+    if (useStatisticReader) {
+        reader = std::make_shared< rlib::common::statistic_reader >(reader);
+    }
+    if (useCachedReader) {
+        reader = std::make_shared< rlib::common::cached_reader >(reader);
+    }
+    return reader;
+}
+
+std::shared_ptr< rlib::common::reader > ReaderRegistry::reader(
+    QString filename, bool useSidecarCache) const
+{
+    if (useSidecarCache) {
+        auto cache = grimcache::Reader::open(filename);
+        if (cache) {
+            return cache;
+        }
+    }
+    for (auto& tuple : this->_formats) {
+        auto ext = std::get< 0 >(tuple).section(';', 1, 1);
+        if (filename.endsWith(ext)) {
+            return std::get< 1 >(tuple)(filename);
+        }
+    }
+    return nullptr;
+}
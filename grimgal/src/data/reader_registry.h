@@ -0,0 +1,77 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#ifndef READER_REGISTRY_H
+#define READER_REGISTRY_H
+
+// Qt
+#include <QString>
+
+// Own
+#include "data/measurement_loader.h"
+#include <rlib/common/reader.h>
+
+// StdLib
+#include <experimental/optional>
+#include <functional>
+#include <map>
+#include <memory>
+
+// File formats grimgal can open, shared by the main window and the batch
+// mode. Formats are keyed "Name;.ext" and picked by the file extension.
+class ReaderRegistry {
+    public:
+    typedef std::function< std::shared_ptr< rlib::common::reader >(QString) >
+        Factory;
+
+    private:
+    std::map< QString, Factory > _formats;
+
+    public:
+    // Registers all formats of readerlib plus the live ones
+    ReaderRegistry();
+
+    void add(QString format, Factory factory);
+    const std::map< QString, Factory >& formats() const;
+
+    // Constructs the reader of a file together with its pyramid and event
+    // index, safe to call from any thread. Returns nothing if no format
+    // matches.
+    std::experimental::optional< MeasurementLoader::Opened > open(
+        QString filename, bool useStatisticReader, bool useCachedReader,
+        bool useSidecarCache) const;
+
+    // Reader a measurement draws from, i.e. the thread safe reader of a file
+    // wrapped in the rlib caches the settings ask for
+    static std::shared_ptr< rlib::common::reader > wrap(
+        std::shared_ptr< rlib::common::reader > source,
+        bool useStatisticReader, bool useCachedReader);
+
+    // Only the reader of a file, without pyramid or event index, for a
+    // single pass over it. A sidecar is preferred if there is one. Returns
+    // nullptr if no format matches.
+    std::shared_ptr< rlib::common::reader > reader(
+        QString filename, bool useSidecarCache) const;
+};
+
+#endif // READER_REGISTRY_H
@@ -0,0 +1,358 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Qt
+
+// Own
+#include "data/sample_block.h"
+
+// StdLib
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+constexpr size_t SampleArena::DEFAULT_CAPACITY;
+constexpr size_t SampleArena::MAX_OVERSIZE;
+
+SampleArena::SampleArena(size_t capacity)
+    : _capacity(capacity)
+{
+}
+
+std::shared_ptr< SampleArena > SampleArena::global()
+{
+    static auto arena = std::make_shared< SampleArena >();
+    return arena;
+}
+
+std::vector< double > SampleArena::acquire(size_t size)
+{
+    std::vector< double > buffer;
+    {
+        std::lock_guard< std::mutex > lock(this->_mutex);
+        // Smallest pooled buffer that fits, larger ones stay for larger
+        // requests
+        auto found = this->_free.lower_bound(size);
+        if (found != this->_free.end() &&
+            found->first <= std::max(size, size_t(1)) * MAX_OVERSIZE) {
+            buffer = std::move(found->second);
+            this->_bytes -= found->first * sizeof(double);
+            this->_free.erase(found);
+        }
+    }
+    // Within the capacity, so no allocation for a pooled buffer
+    buffer.resize(size);
+    return buffer;
+}
+
+void SampleArena::release(std::vector< double >&& buffer)
+{
+    auto capacity = buffer.capacity();
+    if (capacity == 0) {
+        return;
+    }
+    std::lock_guard< std::mutex > lock(this->_mutex);
+    // Drop the smallest buffers first, they are the cheapest to allocate
+    while (!this->_free.empty() &&
+           this->_bytes + capacity * sizeof(double) > this->_capacity) {
+        this->_bytes -= this->_free.begin()->first * sizeof(double);
+        this->_free.erase(this->_free.begin());
+    }
+    if (capacity * sizeof(double) > this->_capacity) {
+        return;
+    }
+    this->_bytes += capacity * sizeof(double);
+    this->_free.emplace(capacity, std::move(buffer));
+}
+
+size_t SampleArena::bytes()
+{
+    std::lock_guard< std::mutex > lock(this->_mutex);
+    return this->_bytes;
+}
+
+SampleBlock::SampleBlock(std::vector< size_t > channels, size_t capacity,
+    std::shared_ptr< SampleArena > arena)
+    : _arena(arena)
+    , _channels(std::move(channels))
+{
+    this->reserve(capacity);
+}
+
+SampleBlock::~SampleBlock()
+{
+    this->release();
+}
+
+SampleBlock::SampleBlock(SampleBlock&& other) noexcept
+    : _arena(std::move(other._arena))
+    , _channels(std::move(other._channels))
+    , _buffer(std::move(other._buffer))
+    , _size(other._size)
+    , _capacity(other._capacity)
+{
+    other._size = 0;
+    other._capacity = 0;
+}
+
+SampleBlock& SampleBlock::operator=(SampleBlock&& other) noexcept
+{
+    if (this != &other) {
+        this->release();
+        this->_arena = std::move(other._arena);
+        this->_channels = std::move(other._channels);
+        this->_buffer = std::move(other._buffer);
+        this->_size = other._size;
+        this->_capacity = other._capacity;
+        other._size = 0;
+        other._capacity = 0;
+    }
+    return *this;
+}
+
+void SampleBlock::release()
+{
+    if (this->_arena) {
+        this->_arena->release(std::move(this->_buffer));
+    }
+    this->_buffer = std::vector< double >();
+    this->_size = 0;
+    this->_capacity = 0;
+}
+
+size_t SampleBlock::size() const
+{
+    return this->_size;
+}
+
+bool SampleBlock::empty() const
+{
+    return this->_size == 0;
+}
+
+const std::vector< size_t >& SampleBlock::channels() const
+{
+    return this->_channels;
+}
+
+std::experimental::optional< size_t > SampleBlock::column(size_t sensor) const
+{
+    auto found =
+        std::find(this->_channels.begin(), this->_channels.end(), sensor);
+    if (found == this->_channels.end()) {
+        return {};
+    }
+    return static_cast< size_t >(found - this->_channels.begin());
+}
+
+const double* SampleBlock::time() const
+{
+    return this->_buffer.data();
+}
+
+double* SampleBlock::time()
+{
+    return this->_buffer.data();
+}
+
+const double* SampleBlock::values(size_t column) const
+{
+    return this->_buffer.data() + (column + 1) * this->_capacity;
+}
+
+double* SampleBlock::values(size_t column)
+{
+    return this->_buffer.data() + (column + 1) * this->_capacity;
+}
+
+size_t SampleBlock::lowerBound(double time) const
+{
+    auto first = this->time();
+    return static_cast< size_t >(
+        std::lower_bound(first, first + this->_size, time) - first);
+}
+
+void SampleBlock::reserve(size_t capacity)
+{
+    if (capacity <= this->_capacity) {
+        return;
+    }
+    auto columns = this->_channels.size() + 1;
+    std::vector< double > buffer;
+    if (this->_arena) {
+        buffer = this->_arena->acquire(columns * capacity);
+    }
+    else {
+        buffer.resize(columns * capacity);
+    }
+    for (size_t c = 0; c < columns; ++c) {
+        auto from = this->_buffer.data() + c * this->_capacity;
+        std::copy(from, from + this->_size, buffer.data() + c * capacity);
+    }
+
+    auto size = this->_size;
+    this->release();
+    this->_buffer = std::move(buffer);
+    this->_size = size;
+    this->_capacity = capacity;
+}
+
+void SampleBlock::resize(size_t size)
+{
+    this->reserve(size);
+    auto nan = std::numeric_limits< double >::quiet_NaN();
+    for (size_t c = 0; c < this->_channels.size() && size > this->_size; ++c) {
+        std::fill(this->values(c) + this->_size, this->values(c) + size, nan);
+    }
+    this->_size = size;
+}
+
+size_t SampleBlock::append(double time)
+{
+    if (this->_size == this->_capacity) {
+        this->reserve(std::max(size_t(64), 2 * this->_capacity));
+    }
+    auto row = this->_size++;
+    this->time()[ row ] = time;
+    auto nan = std::numeric_limits< double >::quiet_NaN();
+    for (size_t c = 0; c < this->_channels.size(); ++c) {
+        this->values(c)[ row ] = nan;
+    }
+    return row;
+}
+
+void SampleBlock::append(const rlib::common::sample& datum)
+{
+    auto row = this->append(datum.time);
+    for (size_t c = 0; c < this->_channels.size(); ++c) {
+        if (this->_channels[ c ] < datum.values.size()) {
+            this->values(c)[ row ] = datum.values[ this->_channels[ c ] ];
+        }
+    }
+}
+
+void SampleBlock::crop(double begin, double end)
+{
+    auto first = this->lowerBound(begin);
+    auto last = std::max(first, this->lowerBound(end));
+    for (size_t c = 0; c < this->_channels.size() + 1; ++c) {
+        auto column = this->_buffer.data() + c * this->_capacity;
+        std::copy(column + first, column + last, column);
+    }
+    this->_size = last - first;
+}
+
+void SampleBlock::clear()
+{
+    this->_size = 0;
+}
+
+size_t SampleBlock::bytes() const
+{
+    return sizeof(SampleBlock) + this->_channels.capacity() * sizeof(size_t) +
+           this->_buffer.capacity() * sizeof(double);
+}
+
+SampleBlock envelopeSamples(const SampleBlock& block, double interval,
+    std::shared_ptr< SampleArena > arena)
+{
+    auto& channels = block.channels();
+    SampleBlock result(channels, 0, arena);
+    auto time = block.time();
+    auto size = block.size();
+    for (size_t first = 0; first < size;) {
+        auto bucket = std::floor(time[ first ] / interval);
+        auto last = static_cast< size_t >(
+            std::lower_bound(
+                time + first, time + size, (bucket + 1.0) * interval) -
+            time);
+        last = std::max(last, first + 1);
+
+        if (last - first <= 2) {
+            for (auto r = first; r < last; ++r) {
+                auto row = result.append(time[ r ]);
+                for (size_t c = 0; c < channels.size(); ++c) {
+                    result.values(c)[ row ] = block.values(c)[ r ];
+                }
+            }
+            first = last;
+            continue;
+        }
+
+        auto row = result.append(time[ first ]);
+        result.append(time[ last - 1 ]);
+        for (size_t c = 0; c < channels.size(); ++c) {
+            auto values = block.values(c);
+            // Comparisons with missing values (NaN) are always false
+            auto minRow = first;
+            auto maxRow = first;
+            for (auto r = first; r < last; ++r) {
+                if (std::isnan(values[ minRow ]) ||
+                    values[ r ] < values[ minRow ]) {
+                    minRow = r;
+                }
+                if (std::isnan(values[ maxRow ]) ||
+                    values[ r ] > values[ maxRow ]) {
+                    maxRow = r;
+                }
+            }
+            auto target = result.values(c);
+            target[ row ] = values[ std::min(minRow, maxRow) ];
+            target[ row + 1 ] = values[ std::max(minRow, maxRow) ];
+        }
+        first = last;
+    }
+    return result;
+}
+
+bool BlockSource::growing() const
+{
+    return false;
+}
+
+std::experimental::optional< double > BlockSource::newest() const
+{
+    return {};
+}
+
+SampleBlock readSamples(rlib::common::reader& reader, double begin,
+    double end, int_fast32_t resolution, std::vector< size_t > channels,
+    std::shared_ptr< SampleArena > arena)
+{
+    // Sidecars, live rings and derived sensors hand out their columns
+    // without going through rlib samples
+    auto source = dynamic_cast< BlockSource* >(&reader);
+    if (source != nullptr) {
+        return source->block(begin, end, resolution, channels, arena);
+    }
+
+    auto data = reader.samples(begin, end, resolution);
+    SampleBlock block(std::move(channels), data.size(), arena);
+    for (auto& datum : data) {
+        if (datum.time >= begin && datum.time < end) {
+            block.append(datum);
+        }
+    }
+    return block;
+}
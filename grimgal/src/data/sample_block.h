@@ -0,0 +1,161 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#ifndef SAMPLE_BLOCK_H
+#define SAMPLE_BLOCK_H
+
+// Qt
+
+// Own
+#include <rlib/common/reader.h>
+#include <rlib/common/sample.h>
+
+// StdLib
+#include <cstddef>
+#include <cstdint>
+#include <experimental/optional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Pool of released sample buffers. Blocks hand their storage back when they
+// are destroyed, so loading the next tile of the same size reuses it instead
+// of going to the heap again. Thread safe.
+class SampleArena {
+    public:
+    // Upper bound of the memory kept in the pool
+    static constexpr size_t DEFAULT_CAPACITY = size_t(64) << 20;
+    // A pooled buffer is only handed out for requests of at least
+    // 1 / MAX_OVERSIZE of its size, so a small block never pins a large one
+    static constexpr size_t MAX_OVERSIZE = 2;
+
+    private:
+    std::mutex _mutex;
+    size_t _capacity;
+    size_t _bytes = 0;
+    // Free buffers by capacity (in doubles)
+    std::multimap< size_t, std::vector< double > > _free;
+
+    public:
+    SampleArena(size_t capacity = DEFAULT_CAPACITY);
+
+    // Arena shared by all blocks which are not given an own one
+    static std::shared_ptr< SampleArena > global();
+
+    // Buffer of exactly size elements, reusing a pooled one if possible
+    std::vector< double > acquire(size_t size);
+    void release(std::vector< double >&& buffer);
+
+    size_t bytes();
+};
+
+// Columnar samples: one contiguous time array plus one contiguous value
+// array per channel, all carved from a single arena buffer. Missing values
+// are NaN. Rows are expected in ascending time order.
+class SampleBlock {
+    private:
+    std::shared_ptr< SampleArena > _arena;
+    // Sensor of each value column
+    std::vector< size_t > _channels;
+    // Time column followed by the value columns, each _capacity long
+    std::vector< double > _buffer;
+    size_t _size = 0;
+    size_t _capacity = 0;
+
+    void release();
+
+    public:
+    SampleBlock() = default;
+    SampleBlock(std::vector< size_t > channels, size_t capacity = 0,
+        std::shared_ptr< SampleArena > arena = SampleArena::global());
+    ~SampleBlock();
+
+    SampleBlock(const SampleBlock&) = delete;
+    SampleBlock& operator=(const SampleBlock&) = delete;
+    SampleBlock(SampleBlock&& other) noexcept;
+    SampleBlock& operator=(SampleBlock&& other) noexcept;
+
+    size_t size() const;
+    bool empty() const;
+    const std::vector< size_t >& channels() const;
+    // Column of sensor within the values (if loaded)
+    std::experimental::optional< size_t > column(size_t sensor) const;
+
+    const double* time() const;
+    double* time();
+    const double* values(size_t column) const;
+    double* values(size_t column);
+
+    // First row with a time not less than time
+    size_t lowerBound(double time) const;
+
+    void reserve(size_t capacity);
+    // Grows or shrinks to size rows, new rows are NaN and have to be given a
+    // time by the caller. Meant for filling whole columns at once.
+    void resize(size_t size);
+    // Appends a row of NaN values and returns its index
+    size_t append(double time);
+    // Appends a sample of the reader, projected onto the channels
+    void append(const rlib::common::sample& datum);
+    // Drops all rows outside of [begin, end)
+    void crop(double begin, double end);
+    void clear();
+
+    // Approximate heap usage
+    size_t bytes() const;
+};
+
+// Minimum and maximum of every column per time bucket of the given width,
+// buckets are aligned to multiples of it. A bucket yields two rows at the
+// time of its first and last sample, holding the extremes in the order they
+// occurred, buckets of up to two rows are kept as they are. Missing values
+// are skipped. Used to thin out samples without losing their peaks.
+SampleBlock envelopeSamples(const SampleBlock& block, double interval,
+    std::shared_ptr< SampleArena > arena = SampleArena::global());
+
+// Reader which hands out columns directly instead of rlib samples, e.g. a
+// sidecar, a live ring or a derived sensor. readSamples() prefers it.
+class BlockSource {
+    public:
+    virtual ~BlockSource() = default;
+
+    // Samples in [begin, end) as columns of the given sensors
+    virtual SampleBlock block(double begin, double end,
+        int_fast32_t resolution, std::vector< size_t > channels,
+        std::shared_ptr< SampleArena > arena = SampleArena::global()) = 0;
+    // True for a source which keeps growing while it is open
+    virtual bool growing() const;
+    // Time of the newest sample of a growing source, nothing if there is
+    // none yet or the source has a fixed length
+    virtual std::experimental::optional< double > newest() const;
+};
+
+// Samples of the reader in [begin, end) as block of the given sensors. This
+// is the one place where the per sample value vectors of rlib are turned
+// into columns, a BlockSource hands out its columns directly.
+SampleBlock readSamples(rlib::common::reader& reader, double begin,
+    double end, int_fast32_t resolution, std::vector< size_t > channels,
+    std::shared_ptr< SampleArena > arena = SampleArena::global());
+
+#endif // SAMPLE_BLOCK_H
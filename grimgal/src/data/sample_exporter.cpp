@@ -0,0 +1,391 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Qt
+#include <QByteArray>
+#include <QSaveFile>
+#include <QtEndian>
+
+// Own
+#include "data/sample_block.h"
+#include "data/sample_exporter.h"
+
+// StdLib
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <experimental/optional>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    // Bounded queue between two stages. push() blocks while it is full and
+    // pop() while it is empty. Once closed push() fails at once and pop()
+    // returns nothing after the remaining items were taken.
+    template < typename T >
+    class Channel {
+        private:
+        std::mutex _mutex;
+        std::condition_variable _changed;
+        std::deque< T > _items;
+        size_t _capacity;
+        bool _closed = false;
+
+        public:
+        Channel(size_t capacity)
+            : _capacity(capacity)
+        {
+        }
+
+        bool push(T&& item)
+        {
+            std::unique_lock< std::mutex > lock(this->_mutex);
+            this->_changed.wait(lock, [this]() {
+                return this->_closed || this->_items.size() < this->_capacity;
+            });
+            if (this->_closed) {
+                return false;
+            }
+            this->_items.push_back(std::move(item));
+            this->_changed.notify_all();
+            return true;
+        }
+
+        std::experimental::optional< T > pop()
+        {
+            std::unique_lock< std::mutex > lock(this->_mutex);
+            this->_changed.wait(lock,
+                [this]() { return this->_closed || !this->_items.empty(); });
+            if (this->_items.empty()) {
+                return {};
+            }
+            std::experimental::optional< T > result(
+                std::move(this->_items.front()));
+            this->_items.pop_front();
+            this->_changed.notify_all();
+            return result;
+        }
+
+        void close()
+        {
+            std::lock_guard< std::mutex > lock(this->_mutex);
+            this->_closed = true;
+            this->_changed.notify_all();
+        }
+    };
+
+    struct Chunk {
+        SampleBlock block;
+        // Recording time read up to
+        double end;
+    };
+
+    struct Encoded {
+        QByteArray data;
+        uint64_t rows;
+        double end;
+    };
+
+    void appendNumber(QByteArray& out, double value)
+    {
+        // Missing values are left empty
+        if (std::isnan(value)) {
+            return;
+        }
+        // Independent of the C locale, which Qt sets from the environment
+        // (e.g. a decimal comma)
+        out.append(QByteArray::number(value, 'g', 17));
+    }
+
+    void appendField(QByteArray& out, const std::string& text)
+    {
+        if (text.find_first_of(",\"\n") == std::string::npos) {
+            out.append(text.c_str());
+            return;
+        }
+        out.append('"');
+        for (auto c : text) {
+            if (c == '"') {
+                out.append('"');
+            }
+            out.append(c);
+        }
+        out.append('"');
+    }
+}
+
+SampleExporter::SampleExporter(
+    std::shared_ptr< rlib::common::reader > reader, Options options)
+    : _reader(reader)
+    , _options(options)
+{
+}
+
+SampleExporter::FORMAT SampleExporter::formatOf(const QString& filename)
+{
+    return filename.endsWith(".csv", Qt::CaseInsensitive) ? FORMAT::CSV
+                                                          : FORMAT::BINARY;
+}
+
+SampleExporter::Result SampleExporter::write(
+    const QString& filename, Progress progress)
+{
+    Result result;
+    auto& options = this->_options;
+    auto sensors = this->_reader->sensors();
+    auto channels = options.sensors;
+    if (channels.empty()) {
+        channels.resize(sensors.size());
+        std::iota(channels.begin(), channels.end(), size_t(0));
+    }
+    for (auto s : channels) {
+        if (s >= sensors.size()) {
+            result.error = "No such sensor";
+            return result;
+        }
+    }
+    if (channels.empty()) {
+        result.error = "No sensors";
+        return result;
+    }
+    auto offsetX = options.offsetX;
+    auto offsetY = options.offsetY;
+    auto shift = options.shift;
+    auto factor = options.factor;
+    offsetX.resize(channels.size(), 0.0);
+    offsetY.resize(channels.size(), 0.0);
+    shift.resize(channels.size(), 0.0);
+    factor.resize(channels.size(), 1.0);
+    // One time column unless the sensors are shifted apart
+    bool sharedTime = std::all_of(offsetX.begin(), offsetX.end(),
+        [&offsetX](double x) { return x == offsetX.front(); });
+
+    QSaveFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        result.error = "Could not open " + filename;
+        return result;
+    }
+    if (options.format == FORMAT::CSV) {
+        QByteArray header;
+        for (size_t c = 0; c < channels.size(); ++c) {
+            if (c == 0 || !sharedTime) {
+                header.append(c == 0 ? "time" : ",time");
+            }
+            auto& sensor = sensors[ channels[ c ] ];
+            header.append(',');
+            appendField(header, sensor.unit.empty()
+                                    ? sensor.name
+                                    : sensor.name + " [" + sensor.unit + "]");
+        }
+        header.append('\n');
+        if (file.write(header) != header.size()) {
+            result.error = "Could not write " + filename;
+            file.cancelWriting();
+            return result;
+        }
+        result.bytes += static_cast< uint64_t >(header.size());
+    }
+
+    Channel< Chunk > chunks(QUEUE_DEPTH);
+    Channel< Encoded > encoded(QUEUE_DEPTH);
+    std::mutex errorMutex;
+    QString error;
+    auto fail = [&](const char* what) {
+        std::lock_guard< std::mutex > lock(errorMutex);
+        if (error.isEmpty()) {
+            error = what;
+        }
+        chunks.close();
+        encoded.close();
+    };
+
+    // Chunks of about CHUNK_SAMPLES rows. Readers without a fixed sampling
+    // interval start with a second and adapt the duration to the rows they
+    // actually returned.
+    auto interval = sensors.front().sampling_interval;
+    auto resolution = std::numeric_limits< int_fast32_t >::max();
+    if (interval > 0.0) {
+        resolution = static_cast< int_fast32_t >(std::ceil(1.0 / interval));
+    }
+    auto duration = interval > 0.0 ? interval * double(CHUNK_SAMPLES) : 1.0;
+
+    // Read range, covering the range of every sensor. Infinite borders are
+    // those of the recording, a reader answers a time outside of it with
+    // the sample at the nearest border.
+    auto shifts = std::minmax_element(shift.begin(), shift.end());
+    auto readBegin = options.begin - *shifts.second;
+    auto readEnd = options.end - *shifts.first;
+    try {
+        if (std::isinf(readBegin)) {
+            auto first = this->_reader->sample(
+                std::numeric_limits< double >::lowest(), resolution);
+            readBegin = first.time;
+        }
+        if (std::isinf(readEnd)) {
+            auto last = this->_reader->sample(
+                std::numeric_limits< double >::max(), resolution);
+            readEnd = std::nextafter(
+                last.time, std::numeric_limits< double >::infinity());
+        }
+    }
+    catch (const std::exception&) {
+        result.error = "Could not read the measurement";
+        file.cancelWriting();
+        return result;
+    }
+
+    std::thread reading([&, duration]() mutable {
+        // Buffers of encoded chunks are reused for the following ones
+        auto arena = std::make_shared< SampleArena >();
+        try {
+            for (auto begin = readBegin; begin < readEnd;) {
+                auto end = std::min(begin + duration, readEnd);
+                auto block = readSamples(
+                    *this->_reader, begin, end, resolution, channels, arena);
+                if (interval <= 0.0) {
+                    auto scale = block.empty()
+                                     ? 2.0
+                                     : double(CHUNK_SAMPLES) /
+                                           double(block.size());
+                    duration *= std::max(0.5, std::min(2.0, scale));
+                }
+                begin = end;
+                if (!chunks.push(Chunk{ std::move(block), end })) {
+                    return;
+                }
+            }
+        }
+        catch (const std::exception&) {
+            fail("Could not read the measurement");
+            return;
+        }
+        chunks.close();
+    });
+
+    std::thread encoding([&]() {
+        auto columns =
+            sharedTime ? channels.size() + 1 : channels.size() * 2;
+        std::vector< const double* > values(channels.size());
+        auto nan = std::numeric_limits< double >::quiet_NaN();
+        while (auto chunk = chunks.pop()) {
+            auto& block = chunk->block;
+            auto rows = block.size();
+            // Offsets as whole columns, the value columns are only read once
+            // more below
+            for (size_t c = 0; c < channels.size(); ++c) {
+                auto column = block.values(c);
+                if (shift[ c ] != *shifts.first ||
+                    shift[ c ] != *shifts.second) {
+                    // Rows of the read range outside the sensor's own
+                    auto from = block.lowerBound(options.begin - shift[ c ]);
+                    auto to = block.lowerBound(options.end - shift[ c ]);
+                    std::fill(column, column + from, nan);
+                    std::fill(column + to, column + rows, nan);
+                }
+                if (factor[ c ] != 1.0 || offsetY[ c ] != 0.0) {
+                    for (size_t r = 0; r < rows; ++r) {
+                        column[ r ] = column[ r ] * factor[ c ] + offsetY[ c ];
+                    }
+                }
+                values[ c ] = column;
+            }
+            auto time = block.time();
+
+            Encoded out{ QByteArray(), rows, chunk->end };
+            if (options.format == FORMAT::BINARY) {
+                out.data.resize(static_cast< int >(rows * columns *
+                                                   sizeof(double)));
+                auto row = reinterpret_cast< double* >(out.data.data());
+                for (size_t r = 0; r < rows; ++r) {
+                    for (size_t c = 0; c < channels.size(); ++c) {
+                        if (c == 0 || !sharedTime) {
+                            *row++ = time[ r ] + offsetX[ c ];
+                        }
+                        *row++ = values[ c ][ r ];
+                    }
+                }
+#if Q_BYTE_ORDER != Q_LITTLE_ENDIAN
+                auto words = reinterpret_cast< quint64* >(out.data.data());
+                for (size_t w = 0; w < rows * columns; ++w) {
+                    words[ w ] = qToLittleEndian(words[ w ]);
+                }
+#endif
+            }
+            else {
+                // Rough upper bound of a row, so the array grows only once
+                out.data.reserve(static_cast< int >(rows * columns * 24));
+                for (size_t r = 0; r < rows; ++r) {
+                    for (size_t c = 0; c < channels.size(); ++c) {
+                        if (c == 0 || !sharedTime) {
+                            if (c != 0) {
+                                out.data.append(',');
+                            }
+                            appendNumber(out.data, time[ r ] + offsetX[ c ]);
+                        }
+                        out.data.append(',');
+                        appendNumber(out.data, values[ c ][ r ]);
+                    }
+                    out.data.append('\n');
+                }
+            }
+            if (!encoded.push(std::move(out))) {
+                chunks.close();
+                return;
+            }
+        }
+        encoded.close();
+    });
+
+    auto length = readEnd - readBegin;
+    while (auto chunk = encoded.pop()) {
+        if (file.write(chunk->data) != chunk->data.size()) {
+            fail("Could not write the file");
+            break;
+        }
+        result.rows += chunk->rows;
+        result.bytes += static_cast< uint64_t >(chunk->data.size());
+        auto done = length > 0.0 ? (chunk->end - readBegin) / length : 1.0;
+        if (progress && !progress(done)) {
+            fail("Cancelled");
+            break;
+        }
+    }
+    reading.join();
+    encoding.join();
+
+    result.error = error;
+    if (!result.error.isEmpty()) {
+        file.cancelWriting();
+    }
+    else if (!file.commit()) {
+        result.error = "Could not write " + filename;
+    }
+    return result;
+}
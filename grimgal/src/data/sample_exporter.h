@@ -0,0 +1,110 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#ifndef SAMPLE_EXPORTER_H
+#define SAMPLE_EXPORTER_H
+
+// Qt
+#include <QString>
+
+// Own
+#include <rlib/common/reader.h>
+
+// StdLib
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <vector>
+
+// Streams a time range of some sensors into a CSV or a packed binary file.
+// Three stages run concurrently and hand chunks of CHUNK_SAMPLES rows to
+// each other through queues of QUEUE_DEPTH chunks: a thread reading blocks,
+// a thread applying the offsets and encoding them and the calling thread
+// writing. Memory stays bounded by the chunks in flight, whatever the
+// length of the range.
+//
+// Columns are the time followed by one value per sensor. If the offsets
+// shift the sensors by different times, every sensor gets its own time
+// column instead (time, value, time, value, ...). CSV files start with a
+// header naming the columns, binary files hold the rows as little endian
+// doubles without any header.
+class SampleExporter {
+    public:
+    enum class FORMAT { CSV, BINARY };
+
+    static constexpr size_t CHUNK_SAMPLES = 64 * 1024;
+    static constexpr size_t QUEUE_DEPTH = 2;
+
+    struct Options {
+        FORMAT format = FORMAT::CSV;
+        // Samples in [begin, end) of the recording, i.e. without offsets.
+        // An infinite border exports from the first or up to the last
+        // sample, gaps in between included.
+        double begin = -std::numeric_limits< double >::infinity();
+        double end = std::numeric_limits< double >::infinity();
+        // Sensors in column order, empty exports all
+        std::vector< size_t > sensors;
+        // Per exported sensor, moves its range to [begin - shift,
+        // end - shift), so a range in view time covers every sensor at the
+        // offsetX it is drawn with. Values outside of it are left empty.
+        // Empty for none.
+        std::vector< double > shift;
+        // Per exported sensor, added to the time and the values. Empty for
+        // none.
+        std::vector< double > offsetX;
+        std::vector< double > offsetY;
+        // Per exported sensor, multiplies the values before offsetY is
+        // added (the unitFactor of a measurement). Empty for none.
+        std::vector< double > factor;
+    };
+
+    struct Result {
+        uint64_t rows = 0;
+        uint64_t bytes = 0;
+        // Empty on success
+        QString error;
+    };
+
+    // Returns false to cancel, called by the writing thread after every chunk
+    // with the share of the range done
+    typedef std::function< bool(double) > Progress;
+
+    private:
+    std::shared_ptr< rlib::common::reader > _reader;
+    Options _options;
+
+    public:
+    SampleExporter(
+        std::shared_ptr< rlib::common::reader > reader, Options options);
+
+    // CSV for *.csv, binary otherwise
+    static FORMAT formatOf(const QString& filename);
+
+    // Blocks until the file is written. The file is replaced only once the
+    // export is complete, a failed or cancelled one leaves it untouched.
+    Result write(const QString& filename, Progress progress = nullptr);
+};
+
+#endif // SAMPLE_EXPORTER_H
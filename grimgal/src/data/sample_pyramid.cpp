@@ -0,0 +1,729 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Qt
+
+// Own
+#include "data/grimcache.h"
+#include "data/sample_block.h"
+#include "data/sample_pyramid.h"
+#include <rlib/common/reader.h>
+#include <rlib/common/sample.h>
+
+// StdLib
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+// Number of raw samples requested from the reader at once while building
+#define PYRAMID_CHUNK_SAMPLES (size_t(1) << 16)
+
+constexpr size_t SamplePyramid::BASE_FACTOR;
+constexpr size_t SamplePyramid::LEVEL_FACTOR;
+
+SamplePyramid::SamplePyramid(std::shared_ptr< rlib::common::reader > reader,
+    std::shared_ptr< grimcache::Writer > writer)
+    : _reader(reader)
+    , _sensor_count(0)
+    , _writer(writer)
+    , _building(false)
+    , _ready(false)
+    , _cancel(false)
+{
+    auto sensors = this->_reader->sensors();
+    this->_sensor_count = sensors.size();
+    // Without a fixed sampling interval (e.g. event driven formats) there is
+    // no sensible bucket size, such readers are always asked directly
+    if (sensors.empty() || sensors.at(0).sampling_interval <= 0.0) {
+        this->_writer.reset();
+        return;
+    }
+    double samplingInterval = sensors.at(0).sampling_interval;
+    this->_building = true;
+    this->_builder = std::thread(
+        [this, samplingInterval]() { this->build(samplingInterval); });
+}
+
+SamplePyramid::SamplePyramid(std::shared_ptr< rlib::common::reader > reader,
+    std::vector< Level > levels, std::vector< SensorStatistic > statistics)
+    : _reader(reader)
+    , _sensor_count(statistics.size())
+    , _levels(std::move(levels))
+    , _statistics(std::move(statistics))
+    , _building(false)
+    , _ready(!this->_levels.empty())
+    , _cancel(false)
+{
+    if (this->_ready) {
+        link(this->_levels);
+        this->buildPrefix();
+    }
+}
+
+SamplePyramid::SamplePyramid(
+    std::shared_ptr< rlib::common::reader > reader, double samplingInterval)
+    : _reader(reader)
+    , _sensor_count(reader->sensors().size())
+    , _building(true)
+    , _ready(false)
+    , _cancel(false)
+{
+    this->_live.reset(new Accumulator(this->_sensor_count));
+    this->_live_statistics.reset(new SampleStatistics(this->_sensor_count));
+    this->_levels.push_back(emptyLevel(
+        samplingInterval * double(BASE_FACTOR), this->_sensor_count));
+    this->buildPrefix();
+}
+
+std::shared_ptr< SamplePyramid > SamplePyramid::live(
+    std::shared_ptr< rlib::common::reader > reader)
+{
+    auto sensors = reader->sensors();
+    if (sensors.empty() || sensors.at(0).sampling_interval <= 0.0) {
+        return nullptr;
+    }
+    return std::shared_ptr< SamplePyramid >(
+        new SamplePyramid(reader, sensors.at(0).sampling_interval));
+}
+
+bool SamplePyramid::live() const
+{
+    return this->_live != nullptr;
+}
+
+void SamplePyramid::append(const SampleBlock& block)
+{
+    if (!this->_live) {
+        return;
+    }
+
+    std::lock_guard< std::mutex > lock(this->_mutex);
+    this->_live_statistics->add(block);
+    auto& bucket = *this->_live;
+    // Same rule as buildBaseLevel(), a bucket across a gap is closed early
+    auto interval = this->_levels.front().interval;
+    auto span = interval + interval / double(BASE_FACTOR) / 2.0;
+    auto time = block.time();
+    for (size_t first = 0; first < block.size();) {
+        if (bucket.count > 0 && time[ first ] >= bucket.time + span) {
+            bucket.flush(this->_levels.front());
+            this->appendBucket();
+        }
+        auto from = bucket.count > 0 ? bucket.time : time[ first ];
+        auto last = std::min(block.size(), first + BASE_FACTOR - bucket.count);
+        last = static_cast< size_t >(
+            std::lower_bound(time + first, time + last, from + span) - time);
+        bucket.add(block, first, last);
+        first = last;
+        if (bucket.count == BASE_FACTOR) {
+            bucket.flush(this->_levels.front());
+            this->appendBucket();
+        }
+    }
+    this->_statistics = this->_live_statistics->result();
+    if (!this->_levels.front().time.empty()) {
+        this->_ready = true;
+        this->_building = false;
+        this->_built.notify_all();
+    }
+}
+
+void SamplePyramid::appendBucket()
+{
+    this->appendPrefix(this->_levels.front().time.size() - 1);
+    // Only the last bucket of each level changed, so only the last bucket of
+    // the level above has to be combined again
+    for (size_t l = 0; l < this->_levels.size(); ++l) {
+        auto buckets = this->_levels[ l ].time.size();
+        if (l + 1 < this->_levels.size()) {
+            combine(this->_levels[ l ], buckets - 1, this->_levels[ l + 1 ]);
+        }
+        else if (buckets > LEVEL_FACTOR) {
+            // Same rule as build(), the top level has at most LEVEL_FACTOR
+            // buckets
+            auto next = this->buildNextLevel(this->_levels[ l ]);
+            this->_levels.push_back(std::move(next));
+        }
+    }
+}
+
+SamplePyramid::~SamplePyramid()
+{
+    this->_cancel = true;
+    if (this->_builder.joinable()) {
+        this->_builder.join();
+    }
+}
+
+bool SamplePyramid::ready() const
+{
+    return this->_ready;
+}
+
+bool SamplePyramid::building() const
+{
+    return this->_building;
+}
+
+void SamplePyramid::wait() const
+{
+    std::unique_lock< std::mutex > lock(this->_mutex);
+    this->_built.wait(lock, [this]() { return !this->_building; });
+}
+
+std::experimental::optional< std::vector< SensorStatistic > >
+    SamplePyramid::statistics() const
+{
+    if (!this->_ready) {
+        return {};
+    }
+    std::lock_guard< std::mutex > lock(this->_mutex);
+    return this->_statistics;
+}
+
+std::experimental::optional< std::pair< double, double > >
+    SamplePyramid::extent() const
+{
+    if (!this->_ready) {
+        return {};
+    }
+    std::lock_guard< std::mutex > lock(this->_mutex);
+    auto& base = this->_levels.front();
+    if (base.time.empty()) {
+        return {};
+    }
+    return std::make_pair(base.time.front(), base.time.back() + base.interval);
+}
+
+void SamplePyramid::build(double samplingInterval)
+{
+    SampleStatistics statistics(this->_sensor_count);
+    std::vector< Level > levels;
+    levels.push_back(this->buildBaseLevel(samplingInterval, statistics));
+    while (!this->_cancel && levels.back().time.size() > LEVEL_FACTOR) {
+        levels.push_back(this->buildNextLevel(levels.back()));
+    }
+    if (this->_cancel || levels.front().time.empty()) {
+        // Drops the unfinished sidecar
+        this->_writer.reset();
+        std::lock_guard< std::mutex > lock(this->_mutex);
+        this->_building = false;
+        this->_built.notify_all();
+        return;
+    }
+    auto result = statistics.result();
+    if (this->_writer) {
+        this->_writer->finish(levels, result);
+        this->_writer.reset();
+    }
+
+    std::lock_guard< std::mutex > lock(this->_mutex);
+    this->_levels = std::move(levels);
+    this->_statistics = std::move(result);
+    this->buildPrefix();
+    this->_ready = true;
+    this->_building = false;
+    this->_built.notify_all();
+}
+
+SamplePyramid::Accumulator::Accumulator(size_t sensors)
+    : min(sensors, std::numeric_limits< double >::infinity())
+    , max(sensors, -std::numeric_limits< double >::infinity())
+    , sum(sensors, 0.0)
+    , square(sensors, 0.0)
+    , valid(sensors, 0)
+    , minIndex(sensors, 0)
+    , maxIndex(sensors, 0)
+{
+}
+
+void SamplePyramid::Accumulator::add(
+    const SampleBlock& block, size_t first, size_t last)
+{
+    if (first >= last) {
+        return;
+    }
+    if (this->count == 0) {
+        this->time = block.time()[ first ];
+    }
+    // Each sensor column in one contiguous run. Missing values (NaN) never
+    // become min or max and are left out of the sums.
+    for (size_t s = 0; s < this->min.size(); ++s) {
+        auto values = block.values(s);
+        for (size_t r = first; r < last; ++r) {
+            auto value = values[ r ];
+            if (value < this->min[ s ]) {
+                this->min[ s ] = value;
+                this->minIndex[ s ] = this->count + r - first;
+            }
+            if (value > this->max[ s ]) {
+                this->max[ s ] = value;
+                this->maxIndex[ s ] = this->count + r - first;
+            }
+            if (!std::isnan(value)) {
+                this->sum[ s ] += value;
+                this->square[ s ] += value * value;
+                ++this->valid[ s ];
+            }
+        }
+    }
+    this->count += last - first;
+}
+
+void SamplePyramid::Accumulator::flush(Level& level)
+{
+    auto inf = std::numeric_limits< double >::infinity();
+    auto nan = std::numeric_limits< double >::quiet_NaN();
+
+    level.time.push_back(this->time);
+    level.count.push_back(static_cast< uint32_t >(this->count));
+    for (size_t s = 0; s < this->min.size(); ++s) {
+        // A sensor without any value in the bucket stays missing
+        if (this->min[ s ] > this->max[ s ]) {
+            this->min[ s ] = this->max[ s ] = nan;
+            this->sum[ s ] = this->square[ s ] = nan;
+        }
+        auto n = double(this->valid[ s ]);
+        level.min[ s ].push_back(this->min[ s ]);
+        level.max[ s ].push_back(this->max[ s ]);
+        level.mean[ s ].push_back(this->sum[ s ] / n);
+        level.square[ s ].push_back(this->square[ s ] / n);
+        level.valid[ s ].push_back(static_cast< uint32_t >(this->valid[ s ]));
+        level.min_first[ s ].push_back(
+            this->minIndex[ s ] <= this->maxIndex[ s ]);
+        this->min[ s ] = inf;
+        this->max[ s ] = -inf;
+        this->sum[ s ] = 0.0;
+        this->square[ s ] = 0.0;
+        this->valid[ s ] = 0;
+    }
+    this->count = 0;
+}
+
+SamplePyramid::Level SamplePyramid::emptyLevel(
+    double interval, size_t sensorCount)
+{
+    Level level;
+    level.interval = interval;
+    level.min.resize(sensorCount);
+    level.max.resize(sensorCount);
+    level.mean.resize(sensorCount);
+    level.square.resize(sensorCount);
+    level.valid.resize(sensorCount);
+    level.min_first.resize(sensorCount);
+    return level;
+}
+
+SamplePyramid::Level SamplePyramid::buildBaseLevel(
+    double samplingInterval, SampleStatistics& statistics)
+{
+    auto sensorCount = this->_sensor_count;
+    auto level =
+        emptyLevel(samplingInterval * double(BASE_FACTOR), sensorCount);
+    Accumulator bucket(sensorCount);
+
+    auto resolution =
+        static_cast< int_fast32_t >(std::ceil(1.0 / samplingInterval));
+    auto chunk = samplingInterval * double(PYRAMID_CHUNK_SAMPLES);
+
+    std::vector< size_t > channels(sensorCount);
+    std::iota(channels.begin(), channels.end(), size_t(0));
+    // Only one chunk is alive at a time, its buffer is reused by the next
+    auto arena = std::make_shared< SampleArena >();
+
+    // First and last sample of the recording, a reader answers a time
+    // outside of it with the sample at the nearest border
+    auto first = this->_reader->sample(
+        std::numeric_limits< double >::lowest(), resolution);
+    auto last = this->_reader->sample(
+        std::numeric_limits< double >::max(), resolution);
+    if (first.values.empty() || last.values.empty()) {
+        return level;
+    }
+
+    // A bucket never spans more than its interval (give or take half a
+    // sample of jitter), so one across a gap is closed early
+    auto span = level.interval + samplingInterval / 2.0;
+
+    // Walk the whole extent chunk by chunk, empty chunks are gaps and do not
+    // end the walk. Chunks are half open, so borders are not delivered
+    // twice.
+    for (double begin = first.time; begin <= last.time && !this->_cancel;
+         begin += chunk) {
+        auto block = readSamples(*this->_reader, begin, begin + chunk,
+            resolution, channels, arena);
+        if (block.empty()) {
+            continue;
+        }
+        if (this->_writer) {
+            this->_writer->append(block);
+        }
+        statistics.add(block);
+        auto time = block.time();
+        for (size_t row = 0; row < block.size();) {
+            if (bucket.count > 0 && time[ row ] >= bucket.time + span) {
+                bucket.flush(level);
+            }
+            auto from = bucket.count > 0 ? bucket.time : time[ row ];
+            auto next =
+                std::min(block.size(), row + BASE_FACTOR - bucket.count);
+            next = static_cast< size_t >(
+                std::lower_bound(time + row, time + next, from + span) -
+                time);
+            bucket.add(block, row, next);
+            row = next;
+            if (bucket.count == BASE_FACTOR) {
+                bucket.flush(level);
+            }
+        }
+    }
+    if (bucket.count > 0) {
+        bucket.flush(level);
+    }
+    return level;
+}
+
+void SamplePyramid::combine(const Level& lower, size_t bucket, Level& level)
+{
+    // The last bucket takes the child if it holds it already or it still
+    // fits, a child after a gap starts a new bucket
+    auto slot = level.time.size();
+    if (slot > 0 && bucket < level.first.back() + LEVEL_FACTOR &&
+        lower.time[ bucket ] < level.time.back() + level.interval) {
+        --slot;
+    }
+    // The last bucket of a growing level is replaced until it is complete
+    bool append = slot == level.time.size();
+    auto b = append ? bucket : level.first[ slot ];
+    auto e = bucket + 1;
+    auto set = [append, slot](auto& column, auto value) {
+        if (append) {
+            column.push_back(value);
+        }
+        else {
+            column[ slot ] = value;
+        }
+    };
+
+    uint32_t count = 0;
+    for (size_t k = b; k < e; ++k) {
+        count += lower.count[ k ];
+    }
+    set(level.time, lower.time[ b ]);
+    set(level.count, count);
+    set(level.first, b);
+
+    for (size_t s = 0; s < lower.min.size(); ++s) {
+        size_t minChild = b;
+        size_t maxChild = b;
+        double sum = 0.0;
+        double square = 0.0;
+        uint32_t valid = 0;
+        for (size_t k = b; k < e; ++k) {
+            // A child without values may come first, it is never kept
+            if (lower.min[ s ][ k ] < lower.min[ s ][ minChild ] ||
+                std::isnan(lower.min[ s ][ minChild ])) {
+                minChild = k;
+            }
+            if (lower.max[ s ][ k ] > lower.max[ s ][ maxChild ] ||
+                std::isnan(lower.max[ s ][ maxChild ])) {
+                maxChild = k;
+            }
+            if (lower.valid[ s ][ k ] > 0) {
+                sum += lower.mean[ s ][ k ] * double(lower.valid[ s ][ k ]);
+                square +=
+                    lower.square[ s ][ k ] * double(lower.valid[ s ][ k ]);
+                valid += lower.valid[ s ][ k ];
+            }
+        }
+        set(level.min[ s ], lower.min[ s ][ minChild ]);
+        set(level.max[ s ], lower.max[ s ][ maxChild ]);
+        set(level.mean[ s ], sum / double(valid));
+        set(level.square[ s ], square / double(valid));
+        set(level.valid[ s ], valid);
+        set(level.min_first[ s ],
+            minChild < maxChild ||
+                (minChild == maxChild && lower.min_first[ s ][ minChild ]));
+    }
+}
+
+SamplePyramid::Level SamplePyramid::buildNextLevel(const Level& lower) const
+{
+    auto level = emptyLevel(
+        lower.interval * double(LEVEL_FACTOR), this->_sensor_count);
+    for (size_t b = 0; b < lower.time.size(); ++b) {
+        combine(lower, b, level);
+    }
+    return level;
+}
+
+std::pair< size_t, size_t > SamplePyramid::children(
+    const Level& lower, const Level& level, size_t b)
+{
+    auto end =
+        b + 1 < level.first.size() ? level.first[ b + 1 ] : lower.time.size();
+    return std::make_pair(level.first[ b ], end);
+}
+
+void SamplePyramid::link(std::vector< Level >& levels)
+{
+    for (size_t l = 1; l < levels.size(); ++l) {
+        auto& lower = levels[ l - 1 ].time;
+        auto& level = levels[ l ];
+        level.first.clear();
+        for (auto time : level.time) {
+            level.first.push_back(static_cast< size_t >(
+                std::lower_bound(lower.begin(), lower.end(), time) -
+                lower.begin()));
+        }
+    }
+}
+
+void SamplePyramid::buildPrefix()
+{
+    this->_prefix_sum.assign(this->_sensor_count, { 0.0 });
+    this->_prefix_square.assign(this->_sensor_count, { 0.0 });
+    this->_prefix_count.assign(this->_sensor_count, { 0 });
+    for (size_t b = 0; b < this->_levels.front().time.size(); ++b) {
+        this->appendPrefix(b);
+    }
+}
+
+void SamplePyramid::appendPrefix(size_t bucket)
+{
+    auto& base = this->_levels.front();
+    for (size_t s = 0; s < this->_sensor_count; ++s) {
+        auto sum = this->_prefix_sum[ s ].back();
+        auto square = this->_prefix_square[ s ].back();
+        auto count = this->_prefix_count[ s ].back();
+        auto valid = base.valid[ s ][ bucket ];
+        if (valid > 0) {
+            sum += base.mean[ s ][ bucket ] * double(valid);
+            square += base.square[ s ][ bucket ] * double(valid);
+            count += valid;
+        }
+        this->_prefix_sum[ s ].push_back(sum);
+        this->_prefix_square[ s ].push_back(square);
+        this->_prefix_count[ s ].push_back(count);
+    }
+}
+
+std::experimental::optional< SamplePyramid::RangeStatistic >
+    SamplePyramid::range(size_t sensor, double begin, double end) const
+{
+    if (!this->_ready || sensor >= this->_sensor_count) {
+        return {};
+    }
+
+    auto inf = std::numeric_limits< double >::infinity();
+    auto nan = std::numeric_limits< double >::quiet_NaN();
+    RangeStatistic result = { 0, inf, -inf, nan, nan, nan };
+    double sum = 0.0;
+    double square = 0.0;
+    double samplingInterval = 0.0;
+    // Partial buckets at the borders, read once the levels are unlocked so
+    // a live append() does not wait for the reader
+    std::vector< std::pair< double, double > > borders;
+
+    {
+        std::lock_guard< std::mutex > lock(this->_mutex);
+
+        auto& base = this->_levels.front();
+        auto buckets = base.time.size();
+        samplingInterval = base.interval / double(BASE_FACTOR);
+        auto bucketEnd = [&](size_t b) {
+            if (b + 1 < buckets) {
+                return base.time[ b + 1 ];
+            }
+            return base.time[ b ] +
+                   samplingInterval * double(base.count[ b ]);
+        };
+
+        // Whole buckets are [first, last)
+        auto first = static_cast< size_t >(
+            std::lower_bound(base.time.begin(), base.time.end(), begin) -
+            base.time.begin());
+        size_t last = 0;
+        if (buckets > 0) {
+            last = static_cast< size_t >(
+                std::upper_bound(base.time.begin() + 1, base.time.end(), end) -
+                (base.time.begin() + 1));
+            if (last == buckets - 1 && bucketEnd(last) <= end) {
+                last = buckets;
+            }
+        }
+
+        if (first >= last) {
+            borders.emplace_back(begin, end);
+        }
+        else {
+            borders.emplace_back(begin, base.time[ first ]);
+            borders.emplace_back(bucketEnd(last - 1), end);
+
+            sum += this->_prefix_sum[ sensor ][ last ] -
+                   this->_prefix_sum[ sensor ][ first ];
+            square += this->_prefix_square[ sensor ][ last ] -
+                      this->_prefix_square[ sensor ][ first ];
+            result.count += this->_prefix_count[ sensor ][ last ] -
+                            this->_prefix_count[ sensor ][ first ];
+
+            // Climb the levels, taking the buckets at both ends of each level
+            // whose parent is not within the range, so at most
+            // 2 * (LEVEL_FACTOR - 1) buckets per level
+            auto take = [&](const Level& level, size_t b) {
+                // Comparisons with missing values (NaN) are always false
+                if (level.min[ sensor ][ b ] < result.min) {
+                    result.min = level.min[ sensor ][ b ];
+                }
+                if (level.max[ sensor ][ b ] > result.max) {
+                    result.max = level.max[ sensor ][ b ];
+                }
+            };
+            for (size_t l = 0; first < last; ++l) {
+                auto& level = this->_levels[ l ];
+                if (l + 1 == this->_levels.size()) {
+                    for (; first < last; ++first) {
+                        take(level, first);
+                    }
+                    break;
+                }
+                // Buckets of the level above whose children are within
+                // [first, last)
+                auto& up = this->_levels[ l + 1 ];
+                auto upFirst = static_cast< size_t >(
+                    std::lower_bound(up.first.begin(), up.first.end(), first) -
+                    up.first.begin());
+                auto upLast = static_cast< size_t >(
+                    std::upper_bound(up.first.begin(), up.first.end(), last) -
+                    up.first.begin());
+                if (upLast > 0 &&
+                    children(level, up, upLast - 1).second > last) {
+                    --upLast;
+                }
+                if (upFirst >= upLast) {
+                    for (; first < last; ++first) {
+                        take(level, first);
+                    }
+                    break;
+                }
+                for (; first < up.first[ upFirst ]; ++first) {
+                    take(level, first);
+                }
+                auto end = children(level, up, upLast - 1).second;
+                for (; last > end; --last) {
+                    take(level, last - 1);
+                }
+                first = upFirst;
+                last = upLast;
+            }
+        }
+    }
+
+    // Raw samples of the partial buckets
+    auto resolution =
+        static_cast< int_fast32_t >(std::ceil(1.0 / samplingInterval));
+    for (auto& border : borders) {
+        if (border.first >= border.second || !this->_reader) {
+            continue;
+        }
+        auto block = readSamples(*this->_reader, border.first, border.second,
+            resolution, { sensor });
+        auto values = block.values(0);
+        for (size_t r = 0; r < block.size(); ++r) {
+            auto value = values[ r ];
+            if (std::isnan(value)) {
+                continue;
+            }
+            result.min = std::min(result.min, value);
+            result.max = std::max(result.max, value);
+            sum += value;
+            square += value * value;
+            ++result.count;
+        }
+    }
+
+    if (result.count == 0) {
+        result.min = result.max = nan;
+        return result;
+    }
+    result.mean = sum / double(result.count);
+    result.rms = std::sqrt(square / double(result.count));
+    result.energy = sum * samplingInterval;
+    return result;
+}
+
+std::experimental::optional< SampleBlock > SamplePyramid::samples(
+    double begin, double end, int_fast32_t resolution,
+    const std::vector< size_t >& channels) const
+{
+    if (!this->_ready || resolution <= 0) {
+        return {};
+    }
+
+    std::lock_guard< std::mutex > lock(this->_mutex);
+
+    // Coarsest level whose buckets are not wider than one requested sample
+    auto wanted = 1.0 / double(resolution);
+    const Level* level = nullptr;
+    for (auto& l : this->_levels) {
+        if (l.interval > wanted) {
+            break;
+        }
+        level = &l;
+    }
+    if (level == nullptr) {
+        return {};
+    }
+
+    auto first = std::lower_bound(
+        level->time.begin(), level->time.end(), begin - level->interval);
+    auto last = std::upper_bound(first, level->time.end(), end);
+    auto firstIndex = static_cast< size_t >(first - level->time.begin());
+    auto lastIndex = static_cast< size_t >(last - level->time.begin());
+
+    SampleBlock result(channels, 2 * (lastIndex - firstIndex));
+    for (size_t b = firstIndex; b < lastIndex; ++b) {
+        result.append(level->time[ b ]);
+        result.append(level->time[ b ] + level->interval / 2.0);
+    }
+    for (size_t c = 0; c < channels.size(); ++c) {
+        auto s = channels[ c ];
+        if (s >= this->_sensor_count) {
+            continue;
+        }
+        auto values = result.values(c);
+        for (size_t b = firstIndex; b < lastIndex; ++b) {
+            auto row = 2 * (b - firstIndex);
+            if (level->min_first[ s ][ b ]) {
+                values[ row ] = level->min[ s ][ b ];
+                values[ row + 1 ] = level->max[ s ][ b ];
+            }
+            else {
+                values[ row ] = level->max[ s ][ b ];
+                values[ row + 1 ] = level->min[ s ][ b ];
+            }
+        }
+    }
+    return result;
+}
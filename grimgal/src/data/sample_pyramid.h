@@ -0,0 +1,230 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#ifndef SAMPLE_PYRAMID_H
+#define SAMPLE_PYRAMID_H
+
+// Qt
+
+// Own
+#include "data/sample_block.h"
+#include "data/sample_statistics.h"
+#include <rlib/common/reader.h>
+#include <rlib/common/sample.h>
+
+// StdLib
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <experimental/optional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace grimcache {
+    class Writer;
+}
+
+// Multi-resolution min/max/mean index over all samples of a reader. The
+// pyramid is built once on a background thread, each level combines up to
+// four buckets of the level below which start within its interval, so no
+// bucket spans a gap. Viewport requests are then answered from the
+// level closest to the requested resolution instead of walking the raw data.
+// A live pyramid starts empty and grows with every append() instead.
+class SamplePyramid {
+    public:
+    // Number of raw samples combined into one bucket of level 0
+    static constexpr size_t BASE_FACTOR = 64;
+    // Maximum number of buckets of level n combined into one bucket of
+    // level n + 1
+    static constexpr size_t LEVEL_FACTOR = 4;
+
+    struct Level {
+        // Duration covered by one bucket
+        double interval;
+        // Time of the first sample and number of samples of each bucket
+        std::vector< double > time;
+        std::vector< uint32_t > count;
+        // Per sensor aggregates of each bucket (sensor x bucket)
+        std::vector< std::vector< double > > min;
+        std::vector< std::vector< double > > max;
+        std::vector< std::vector< double > > mean;
+        // Mean of the squared values, for the RMS of a range
+        std::vector< std::vector< double > > square;
+        // Number of values which are not missing (sensor x bucket), mean and
+        // square are taken over these only
+        std::vector< std::vector< uint32_t > > valid;
+        // Per sensor flag, whether the minimum occurred before the maximum
+        std::vector< std::vector< bool > > min_first;
+        // Index of the first bucket of the level below in each bucket, empty
+        // for the base level. Not stored in a sidecar, a bucket starts with
+        // its first child, see link().
+        std::vector< size_t > first;
+    };
+
+    struct RangeStatistic {
+        uint64_t count;
+        double min;
+        double max;
+        double mean;
+        double rms;
+        // Integral of the values over time (value unit times seconds)
+        double energy;
+    };
+
+    private:
+    // Base level bucket which is still being filled
+    struct Accumulator {
+        std::vector< double > min;
+        std::vector< double > max;
+        std::vector< double > sum;
+        std::vector< double > square;
+        std::vector< size_t > valid;
+        std::vector< size_t > minIndex;
+        std::vector< size_t > maxIndex;
+        size_t count = 0;
+        double time = 0.0;
+
+        explicit Accumulator(size_t sensors);
+        // Adds the rows [first, last) of a block holding every sensor
+        void add(const SampleBlock& block, size_t first, size_t last);
+        // Appends the bucket to level and starts the next one
+        void flush(Level& level);
+    };
+
+    // Read on the builder thread while others use it as well, so it has to
+    // be thread safe (see SerialReader)
+    std::shared_ptr< rlib::common::reader > _reader;
+    size_t _sensor_count;
+    // Receives every chunk read while building, then the levels
+    std::shared_ptr< grimcache::Writer > _writer;
+
+    mutable std::mutex _mutex;
+    std::vector< Level > _levels;
+    // Whole file figures, gathered by the same pass as the base level
+    std::vector< SensorStatistic > _statistics;
+    // Running totals over the buckets of the base level (sensor x bucket),
+    // entry b covers the buckets [0, b). Counts are those of the values
+    // which are not missing, so they are the divisor of a mean.
+    std::vector< std::vector< double > > _prefix_sum;
+    std::vector< std::vector< double > > _prefix_square;
+    std::vector< std::vector< uint64_t > > _prefix_count;
+
+    // Only set for live pyramids, see append()
+    std::unique_ptr< Accumulator > _live;
+    std::unique_ptr< SampleStatistics > _live_statistics;
+
+    std::atomic< bool > _building;
+    // Notified once _building turns false
+    mutable std::condition_variable _built;
+    std::atomic< bool > _ready;
+    std::atomic< bool > _cancel;
+    std::thread _builder;
+
+    private:
+    void build(double samplingInterval);
+    Level buildBaseLevel(
+        double samplingInterval, SampleStatistics& statistics);
+    Level buildNextLevel(const Level& lower) const;
+    void buildPrefix();
+    void appendPrefix(size_t bucket);
+    void appendBucket();
+
+    static Level emptyLevel(double interval, size_t sensorCount);
+    // Adds bucket of the level below to the last bucket of level, or starts
+    // a new one with it if that is full or bucket starts outside of its
+    // interval. Buckets have to be passed in order, the last one may be
+    // passed again once it changed.
+    static void combine(const Level& lower, size_t bucket, Level& level);
+    // Children of bucket b of level, within the level below
+    static std::pair< size_t, size_t > children(
+        const Level& lower, const Level& level, size_t b);
+    // Restores the first children of levels read from a sidecar
+    static void link(std::vector< Level >& levels);
+
+    SamplePyramid(std::shared_ptr< rlib::common::reader > reader,
+        double samplingInterval);
+
+    public:
+    SamplePyramid(std::shared_ptr< rlib::common::reader > reader,
+        std::shared_ptr< grimcache::Writer > writer = nullptr);
+    // Pyramid of an earlier build, ready at once
+    SamplePyramid(std::shared_ptr< rlib::common::reader > reader,
+        std::vector< Level > levels,
+        std::vector< SensorStatistic > statistics);
+    ~SamplePyramid();
+
+    // Empty pyramid which grows with append(), e.g. for a live source.
+    // Returns nullptr if the reader has no fixed sampling interval.
+    static std::shared_ptr< SamplePyramid > live(
+        std::shared_ptr< rlib::common::reader > reader);
+
+    SamplePyramid(const SamplePyramid&) = delete;
+    SamplePyramid& operator=(const SamplePyramid&) = delete;
+
+    // True once all levels have been built (live: the first bucket)
+    bool ready() const;
+    // True while the build is running, false once it is done or if the
+    // reader can not be indexed at all
+    bool building() const;
+    // Blocks until building() turns false, for callers which need the whole
+    // pyramid and have nothing else to do
+    void wait() const;
+    bool live() const;
+
+    // Time of the first sample and end of the last base bucket, nothing
+    // until the pyramid is ready
+    std::experimental::optional< std::pair< double, double > > extent() const;
+
+    // Live pyramids only: adds samples of every sensor (in sensor order)
+    // behind all earlier ones. Levels, running totals and statistics are
+    // updated incrementally, a full base bucket costs O(levels).
+    void append(const SampleBlock& block);
+
+    // Statistics of every sensor, nothing until the pyramid is ready
+    std::experimental::optional< std::vector< SensorStatistic > >
+        statistics() const;
+
+    // Figures of one sensor over the samples in [begin, end). Whole buckets
+    // are answered from the running totals and the min/max levels, only the
+    // partial buckets at both borders are read from the reader, so the cost
+    // does not depend on the length of the range. Reads the reader, so it
+    // belongs on a worker thread. Returns nothing if the pyramid is not
+    // ready.
+    std::experimental::optional< RangeStatistic > range(
+        size_t sensor, double begin, double end) const;
+
+    // Samples in [begin, end] from the coarsest level which is still at
+    // least as fine as the requested resolution (samples per second). Every
+    // bucket yields two samples holding its minimum and maximum in the order
+    // they occurred. Returns nothing if the pyramid is not ready or too
+    // coarse for the resolution, in which case the reader has to be asked.
+    // The columns of the block are the given sensors (in that order).
+    std::experimental::optional< SampleBlock > samples(double begin,
+        double end, int_fast32_t resolution,
+        const std::vector< size_t >& channels) const;
+};
+
+#endif // SAMPLE_PYRAMID_H
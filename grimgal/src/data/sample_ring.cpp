@@ -0,0 +1,184 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Qt
+
+// Own
+#include "data/sample_block.h"
+#include "data/sample_ring.h"
+
+// StdLib
+#include <algorithm>
+#include <limits>
+
+constexpr size_t SampleRing::DEFAULT_CAPACITY;
+
+SampleRing::SampleRing(size_t sensors, size_t capacity)
+    : _sensors(sensors)
+    , _capacity(std::max(capacity, size_t(1)))
+    , _time(new std::atomic< double >[ this->_capacity ])
+    , _values(new std::atomic< double >[ this->_capacity * sensors ])
+    , _head(0)
+    , _claimed(0)
+{
+}
+
+size_t SampleRing::sensors() const
+{
+    return this->_sensors;
+}
+
+size_t SampleRing::capacity() const
+{
+    return this->_capacity;
+}
+
+uint64_t SampleRing::written() const
+{
+    return this->_head.load(std::memory_order_acquire);
+}
+
+double SampleRing::timeAt(uint64_t row) const
+{
+    return this->_time[ row % this->_capacity ].load(
+        std::memory_order_relaxed);
+}
+
+void SampleRing::claim(uint64_t row)
+{
+    this->_claimed.store(row + 1, std::memory_order_relaxed);
+    // Orders the claim before the stores into the slot, a reader which
+    // copied any of them sees the claim after its acquire fence
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void SampleRing::append(const SampleBlock& block)
+{
+    auto nan = std::numeric_limits< double >::quiet_NaN();
+    auto head = this->_head.load(std::memory_order_relaxed);
+    auto columns = std::min(block.channels().size(), this->_sensors);
+    for (size_t r = 0; r < block.size(); ++r, ++head) {
+        auto slot = head % this->_capacity;
+        this->claim(head);
+        this->_time[ slot ].store(block.time()[ r ], std::memory_order_relaxed);
+        for (size_t s = 0; s < this->_sensors; ++s) {
+            auto value = s < columns ? block.values(s)[ r ] : nan;
+            this->_values[ s * this->_capacity + slot ].store(
+                value, std::memory_order_relaxed);
+        }
+        // Publish row by row, so readers never wait for a whole block
+        this->_head.store(head + 1, std::memory_order_release);
+    }
+}
+
+void SampleRing::append(double time, const double* values)
+{
+    auto head = this->_head.load(std::memory_order_relaxed);
+    auto slot = head % this->_capacity;
+    this->claim(head);
+    this->_time[ slot ].store(time, std::memory_order_relaxed);
+    for (size_t s = 0; s < this->_sensors; ++s) {
+        this->_values[ s * this->_capacity + slot ].store(
+            values[ s ], std::memory_order_relaxed);
+    }
+    this->_head.store(head + 1, std::memory_order_release);
+}
+
+SampleBlock SampleRing::read(double begin, double end,
+    const std::vector< size_t >& channels,
+    std::shared_ptr< SampleArena > arena) const
+{
+    auto head = this->_head.load(std::memory_order_acquire);
+    auto tail = head > this->_capacity ? head - this->_capacity : 0;
+
+    // Rows overwritten during the search only move first further back, the
+    // extra rows are cropped below
+    auto first = tail;
+    for (auto count = head - tail; count > 0;) {
+        auto step = count / 2;
+        if (this->timeAt(first + step) < begin) {
+            first += step + 1;
+            count -= step + 1;
+        }
+        else {
+            count = step;
+        }
+    }
+    auto last = first;
+    while (last < head && this->timeAt(last) < end) {
+        ++last;
+    }
+
+    SampleBlock block(channels, last - first, arena);
+    block.resize(last - first);
+    for (auto row = first; row < last; ++row) {
+        auto slot = row % this->_capacity;
+        block.time()[ row - first ] =
+            this->_time[ slot ].load(std::memory_order_relaxed);
+        for (size_t c = 0; c < channels.size(); ++c) {
+            if (channels[ c ] < this->_sensors) {
+                block.values(c)[ row - first ] =
+                    this->_values[ channels[ c ] * this->_capacity + slot ]
+                        .load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Drop the rows whose slots the writer claimed while they were copied,
+    // including the one it may be writing right now
+    std::atomic_thread_fence(std::memory_order_acquire);
+    auto claimed = this->_claimed.load(std::memory_order_relaxed);
+    auto valid = claimed > this->_capacity ? claimed - this->_capacity : 0;
+    if (valid > first) {
+        auto lost = std::min(valid, last) - first;
+        auto kept = block.size() - lost;
+        std::copy(block.time() + lost, block.time() + block.size(),
+            block.time());
+        for (size_t c = 0; c < channels.size(); ++c) {
+            std::copy(block.values(c) + lost,
+                block.values(c) + block.size(), block.values(c));
+        }
+        block.resize(kept);
+    }
+    block.crop(begin, end);
+    return block;
+}
+
+std::experimental::optional< double > SampleRing::oldest() const
+{
+    auto head = this->_head.load(std::memory_order_acquire);
+    if (head == 0) {
+        return {};
+    }
+    auto tail = head > this->_capacity ? head - this->_capacity : 0;
+    return this->timeAt(tail);
+}
+
+std::experimental::optional< double > SampleRing::newest() const
+{
+    auto head = this->_head.load(std::memory_order_acquire);
+    if (head == 0) {
+        return {};
+    }
+    return this->timeAt(head - 1);
+}
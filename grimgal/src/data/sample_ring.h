@@ -0,0 +1,94 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#ifndef SAMPLE_RING_H
+#define SAMPLE_RING_H
+
+// Qt
+
+// Own
+#include "data/sample_block.h"
+
+// StdLib
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <experimental/optional>
+#include <memory>
+#include <vector>
+
+// Bounded ring of the newest samples of a live source, one time ring plus
+// one value ring per sensor. A single writer appends, any number of readers
+// copy out concurrently without a lock: like a seqlock the writer claims a
+// slot before overwriting it and publishes the row by advancing the head,
+// readers check the claims again after copying and drop the rows whose
+// slots were claimed meanwhile. Rows have to be appended in
+// ascending time order; the oldest rows are overwritten once it is full.
+class SampleRing {
+    public:
+    // Rows kept by default, per sensor
+    static constexpr size_t DEFAULT_CAPACITY = size_t(1) << 20;
+
+    private:
+    size_t _sensors;
+    size_t _capacity;
+    std::unique_ptr< std::atomic< double >[] > _time;
+    // Sensor s of slot i is at s * _capacity + i
+    std::unique_ptr< std::atomic< double >[] > _values;
+    // Number of rows ever appended, the newest row is _head - 1
+    std::atomic< uint64_t > _head;
+    // Number of rows the writer started to write, _head or _head + 1. The
+    // slot of row r is no longer valid once r + _capacity is claimed.
+    std::atomic< uint64_t > _claimed;
+
+    // Writer only, announces that the slot of row is about to be reused
+    void claim(uint64_t row);
+
+    double timeAt(uint64_t row) const;
+
+    public:
+    SampleRing(size_t sensors, size_t capacity = DEFAULT_CAPACITY);
+
+    SampleRing(const SampleRing&) = delete;
+    SampleRing& operator=(const SampleRing&) = delete;
+
+    size_t sensors() const;
+    size_t capacity() const;
+    // Rows ever appended (not only the resident ones)
+    uint64_t written() const;
+
+    // Writer only. The columns of block have to be sensors 0..n-1.
+    void append(const SampleBlock& block);
+    void append(double time, const double* values);
+
+    // Resident rows in [begin, end) as block of the given sensors
+    SampleBlock read(double begin, double end,
+        const std::vector< size_t >& channels,
+        std::shared_ptr< SampleArena > arena = SampleArena::global()) const;
+
+    // Time of the oldest and the newest resident row
+    std::experimental::optional< double > oldest() const;
+    std::experimental::optional< double > newest() const;
+};
+
+#endif // SAMPLE_RING_H
@@ -0,0 +1,230 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Qt
+
+// Own
+#include "data/sample_statistics.h"
+#include <rlib/common/statistic_reader.h>
+
+// StdLib
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+
+void SampleStatistics::Median::add(double value)
+{
+    if (this->count < 5) {
+        this->height[ this->count++ ] = value;
+        if (this->count == 5) {
+            std::sort(this->height, this->height + 5);
+            for (int i = 0; i < 5; ++i) {
+                this->position[ i ] = i;
+            }
+            this->desired[ 0 ] = 0.0;
+            this->desired[ 1 ] = 1.0;
+            this->desired[ 2 ] = 2.0;
+            this->desired[ 3 ] = 3.0;
+            this->desired[ 4 ] = 4.0;
+        }
+        return;
+    }
+    ++this->count;
+
+    // Cell of the new value, the outer markers follow the extremes
+    int cell;
+    if (value < this->height[ 0 ]) {
+        this->height[ 0 ] = value;
+        cell = 0;
+    }
+    else if (value >= this->height[ 4 ]) {
+        this->height[ 4 ] = value;
+        cell = 3;
+    }
+    else {
+        cell = 0;
+        while (value >= this->height[ cell + 1 ]) {
+            ++cell;
+        }
+    }
+    for (int i = cell + 1; i < 5; ++i) {
+        this->position[ i ] += 1.0;
+    }
+    // Desired positions of the 0, 0.25, 0.5, 0.75 and 1 quantiles
+    this->desired[ 1 ] += 0.25;
+    this->desired[ 2 ] += 0.5;
+    this->desired[ 3 ] += 0.75;
+    this->desired[ 4 ] += 1.0;
+
+    auto& q = this->height;
+    auto& n = this->position;
+    for (int i = 1; i < 4; ++i) {
+        auto d = this->desired[ i ] - n[ i ];
+        if ((d >= 1.0 && n[ i + 1 ] - n[ i ] > 1.0) ||
+            (d <= -1.0 && n[ i - 1 ] - n[ i ] < -1.0)) {
+            int s = d > 0.0 ? 1 : -1;
+            // Piecewise parabolic prediction, linear if it leaves the cell
+            auto parabolic = q[ i ] +
+                             s / (n[ i + 1 ] - n[ i - 1 ]) *
+                                 ((n[ i ] - n[ i - 1 ] + s) *
+                                         (q[ i + 1 ] - q[ i ]) /
+                                         (n[ i + 1 ] - n[ i ]) +
+                                     (n[ i + 1 ] - n[ i ] - s) *
+                                         (q[ i ] - q[ i - 1 ]) /
+                                         (n[ i ] - n[ i - 1 ]));
+            if (q[ i - 1 ] < parabolic && parabolic < q[ i + 1 ]) {
+                q[ i ] = parabolic;
+            }
+            else {
+                q[ i ] += s * (q[ i + s ] - q[ i ]) / (n[ i + s ] - n[ i ]);
+            }
+            n[ i ] += s;
+        }
+    }
+}
+
+double SampleStatistics::Median::value() const
+{
+    if (this->count == 0) {
+        return std::numeric_limits< double >::quiet_NaN();
+    }
+    if (this->count >= 5) {
+        return this->height[ 2 ];
+    }
+    double sorted[ 5 ];
+    std::copy(this->height, this->height + this->count, sorted);
+    std::sort(sorted, sorted + this->count);
+    if (this->count % 2 == 1) {
+        return sorted[ this->count / 2 ];
+    }
+    return (sorted[ this->count / 2 - 1 ] + sorted[ this->count / 2 ]) / 2.0;
+}
+
+SampleStatistics::SampleStatistics(size_t sensors)
+    : _sensors(sensors)
+{
+}
+
+void SampleStatistics::add(size_t sensor, const double* values, size_t count)
+{
+    if (sensor >= this->_sensors.size()) {
+        return;
+    }
+
+    // Figures of this column alone
+    uint64_t n = 0;
+    double min = std::numeric_limits< double >::infinity();
+    double max = -std::numeric_limits< double >::infinity();
+    double sum = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        auto value = values[ i ];
+        if (std::isnan(value)) {
+            continue;
+        }
+        ++n;
+        min = std::min(min, value);
+        max = std::max(max, value);
+        sum += value;
+    }
+    if (n == 0) {
+        return;
+    }
+    double mean = sum / double(n);
+    double m2 = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        auto value = values[ i ];
+        if (!std::isnan(value)) {
+            m2 += (value - mean) * (value - mean);
+        }
+    }
+
+    // Merge (Chan et al.)
+    auto& acc = this->_sensors[ sensor ];
+    if (acc.count == 0) {
+        acc.min = min;
+        acc.max = max;
+    }
+    else {
+        acc.min = std::min(acc.min, min);
+        acc.max = std::max(acc.max, max);
+    }
+    auto total = acc.count + n;
+    auto delta = mean - acc.mean;
+    acc.mean += delta * double(n) / double(total);
+    acc.m2 += m2 + delta * delta * double(acc.count) * double(n) /
+                       double(total);
+    acc.count = total;
+
+    for (size_t i = 0; i < count; ++i) {
+        if (!std::isnan(values[ i ])) {
+            acc.median.add(values[ i ]);
+        }
+    }
+}
+
+void SampleStatistics::add(const SampleBlock& block)
+{
+    for (size_t c = 0; c < block.channels().size(); ++c) {
+        this->add(block.channels()[ c ], block.values(c), block.size());
+    }
+}
+
+std::vector< SensorStatistic > SampleStatistics::result() const
+{
+    auto nan = std::numeric_limits< double >::quiet_NaN();
+    std::vector< SensorStatistic > result;
+    for (auto& acc : this->_sensors) {
+        if (acc.count == 0) {
+            result.push_back({ 0, nan, nan, nan, nan, nan });
+            continue;
+        }
+        result.push_back({ acc.count, acc.min, acc.max, acc.mean,
+            acc.m2 / double(acc.count), acc.median.value() });
+    }
+    return result;
+}
+
+std::vector< SensorStatistic > readerStatistics(
+    std::shared_ptr< rlib::common::reader > reader, size_t sensors)
+{
+    auto nan = std::numeric_limits< double >::quiet_NaN();
+    std::vector< SensorStatistic > result(
+        sensors, SensorStatistic{ 0, nan, nan, nan, nan, nan });
+    auto statistic = std::make_shared< rlib::common::statistic_reader >(reader);
+    auto fill = [&](rlib::common::statistic_data data,
+                    double SensorStatistic::*field) {
+        auto values = statistic->statistic(data);
+        for (size_t s = 0; s < values.size() && s < sensors; ++s) {
+            if (values[ s ]) {
+                result[ s ].*field = *values[ s ];
+            }
+        }
+    };
+    fill(rlib::common::statistic_data::MIN_VALUE, &SensorStatistic::min);
+    fill(rlib::common::statistic_data::MAX_VALUE, &SensorStatistic::max);
+    fill(rlib::common::statistic_data::AVG_VALUE, &SensorStatistic::mean);
+    fill(rlib::common::statistic_data::MEDIAN_VALUE, &SensorStatistic::median);
+    fill(rlib::common::statistic_data::VAR_VALUE, &SensorStatistic::variance);
+    return result;
+}
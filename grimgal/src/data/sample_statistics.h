@@ -0,0 +1,96 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#ifndef SAMPLE_STATISTICS_H
+#define SAMPLE_STATISTICS_H
+
+// Qt
+
+// Own
+#include "data/sample_block.h"
+#include <rlib/common/reader.h>
+
+// StdLib
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Summary of all values of one sensor, NaN if it has none
+struct SensorStatistic {
+    uint64_t count;
+    double min;
+    double max;
+    double mean;
+    double variance;
+    // Estimate, exact for less than five values
+    double median;
+};
+
+// One pass statistics over the columns of consecutive sample blocks. Each
+// column is reduced on its own (min, max, sum and squared deviation are
+// plain loops over contiguous memory) and merged into the running figures
+// with the parallel variant of Welford's algorithm. The median is tracked
+// with the P-square estimator, so memory stays constant.
+class SampleStatistics {
+    private:
+    // P-square markers of the median
+    struct Median {
+        double height[ 5 ];
+        double position[ 5 ];
+        double desired[ 5 ];
+        uint64_t count = 0;
+
+        void add(double value);
+        double value() const;
+    };
+
+    struct Accumulator {
+        uint64_t count = 0;
+        double min = 0.0;
+        double max = 0.0;
+        double mean = 0.0;
+        double m2 = 0.0;
+        Median median;
+    };
+
+    std::vector< Accumulator > _sensors;
+
+    public:
+    SampleStatistics(size_t sensors);
+
+    // Adds count values of one sensor, NaN is skipped
+    void add(size_t sensor, const double* values, size_t count);
+    // Adds every column of the block to the sensor it holds
+    void add(const SampleBlock& block);
+
+    std::vector< SensorStatistic > result() const;
+};
+
+// Figures the reader reports itself (count is 0), for readers which are not
+// indexed by a pyramid. Same as Settings->Use statistic reader, reads the
+// whole file.
+std::vector< SensorStatistic > readerStatistics(
+    std::shared_ptr< rlib::common::reader > reader, size_t sensors);
+
+#endif // SAMPLE_STATISTICS_H
@@ -0,0 +1,83 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Qt
+
+// Own
+#include "data/serial_reader.h"
+
+// StdLib
+
+SerialReader::SerialReader(std::shared_ptr< rlib::common::reader > reader)
+    : _reader(reader)
+    , _filename(reader->filename())
+    , _sensors(reader->sensors())
+{
+}
+
+SampleBlock SerialReader::block(double begin, double end,
+    int_fast32_t resolution, std::vector< size_t > channels,
+    std::shared_ptr< SampleArena > arena)
+{
+    std::lock_guard< std::mutex > lock(this->_mutex);
+    return readSamples(
+        *this->_reader, begin, end, resolution, std::move(channels), arena);
+}
+
+std::string SerialReader::filename()
+{
+    return this->_filename;
+}
+
+std::vector< rlib::common::sensor > SerialReader::sensors()
+{
+    return this->_sensors;
+}
+
+std::vector< rlib::common::sample > SerialReader::samples(
+    double begin, double end, int_fast32_t resolution)
+{
+    std::lock_guard< std::mutex > lock(this->_mutex);
+    return this->_reader->samples(begin, end, resolution);
+}
+
+rlib::common::sample SerialReader::sample(
+    double time, int_fast32_t resolution)
+{
+    std::lock_guard< std::mutex > lock(this->_mutex);
+    return this->_reader->sample(time, resolution);
+}
+
+std::vector< rlib::common::event_data > SerialReader::events(
+    double begin, double end)
+{
+    std::lock_guard< std::mutex > lock(this->_mutex);
+    return this->_reader->events(begin, end);
+}
+
+std::vector< std::experimental::optional< double > > SerialReader::statistic(
+    rlib::common::statistic_data data)
+{
+    std::lock_guard< std::mutex > lock(this->_mutex);
+    return this->_reader->statistic(data);
+}
@@ -0,0 +1,74 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#ifndef SERIAL_READER_H
+#define SERIAL_READER_H
+
+// Qt
+
+// Own
+#include "data/sample_block.h"
+#include <rlib/common/reader.h>
+
+// StdLib
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Makes a reader which is not thread safe usable from several threads. The
+// pyramid builder, the tile loader and the exporter all read the same file,
+// their requests take turns on the mutex. Name and sensors do not change
+// while a file is open, they are answered from a copy without waiting.
+class SerialReader : public rlib::common::reader, public BlockSource {
+    private:
+    std::shared_ptr< rlib::common::reader > _reader;
+    std::mutex _mutex;
+    std::string _filename;
+    std::vector< rlib::common::sensor > _sensors;
+
+    public:
+    SerialReader(std::shared_ptr< rlib::common::reader > reader);
+
+    SerialReader(const SerialReader&) = delete;
+    SerialReader& operator=(const SerialReader&) = delete;
+
+    virtual SampleBlock block(double begin, double end,
+        int_fast32_t resolution, std::vector< size_t > channels,
+        std::shared_ptr< SampleArena > arena =
+            SampleArena::global()) override;
+
+    virtual std::string filename() override;
+    virtual std::vector< rlib::common::sensor > sensors() override;
+    virtual std::vector< rlib::common::sample > samples(
+        double begin, double end, int_fast32_t resolution) override;
+    virtual rlib::common::sample sample(
+        double time, int_fast32_t resolution) override;
+    virtual std::vector< rlib::common::event_data > events(
+        double begin, double end) override;
+    virtual std::vector< std::experimental::optional< double > > statistic(
+        rlib::common::statistic_data data) override;
+};
+
+#endif // SERIAL_READER_H
@@ -26,13 +26,25 @@
 #include <QDomElement>
 #include <QFileDialog>
 #include <QFileInfo>
+#include <QHBoxLayout>
+#include <QInputDialog>
 #include <QItemSelectionModel>
+#include <QLabel>
 #include <QMessageBox>
 #include <QObject>
+#include <QProgressBar>
+#include <QProgressDialog>
+#include <QStatusBar>
+#include <QToolButton>
 #include <QXmlStreamWriter>
 
 // Own
 #include "data/configuration.h"
+#include "data/derived_reader.h"
+#include "data/measurement_loader.h"
+#include "data/project_file.h"
+#include "data/sample_exporter.h"
+#include "data/serial_reader.h"
 #include "eventfilter/probeview/removeprobe.h"
 #include "form/mainwindow.h"
 #include "model/eventtablemodel.h"
@@ -41,19 +53,12 @@
 #include "model/propertytablemodel.h"
 #include "model/statistictablemodel.h"
 #include "ui_mainwindow.h"
-#include <rlib/android/meta_reader.h>
-#include <rlib/common/cached_reader.h>
 #include <rlib/common/reader.h>
-#include <rlib/common/statistic_reader.h>
-#include <rlib/csv/csv_reader.h>
-#include <rlib/grim/grim_reader.h>
-#include <rlib/keysight/dlog_reader.h>
-#include <rlib/powerscale/psi_reader.h>
-#include <rlib/remote/reader.h>
-#include <rlib/xml/xml_reader.h>
 
 // StdLib
+#include <algorithm>
 #include <iostream>
+#include <numeric>
 
 //--//PUBLIC
 MainWindow::MainWindow(QWidget* parent)
@@ -94,6 +99,9 @@ MainWindow::MainWindow(QWidget* parent)
         std::make_shared< eventfilter::probeview::RemoveProbe >(
             this->_configuration, this->_project);
 
+    // Set Members :: Loader
+    this->_loader = std::make_unique< MeasurementLoader >();
+
     // Config Ui
     this->_ui->glWidget->setProject(this->_project);
     this->_ui->glWidget->setConfiguration(this->_configuration);
@@ -120,6 +128,9 @@ MainWindow::MainWindow(QWidget* parent)
     QObject::connect(this->_ui->glWidget,
         SIGNAL(resolutionChanged(int_fast32_t)), this->_probe_model.get(),
         SLOT(setResolution(int_fast32_t)));
+    QObject::connect(this->_ui->glWidget,
+        SIGNAL(windowChanged(double, double)), this->_statistic_model.get(),
+        SLOT(setWindow(double, double)));
     QObject::connect(this->_ui->probeTable->horizontalHeader(),
         SIGNAL(sectionClicked(int)), this->_probe_model.get(),
         SLOT(sectionClicked(int)));
@@ -130,6 +141,8 @@ MainWindow::MainWindow(QWidget* parent)
         this->_ui->glWidget, SLOT(goTo(double)));
     QObject::connect(this->_event_model.get(), SIGNAL(goTo(double)),
         this->_ui->glWidget, SLOT(goTo(double)));
+    QObject::connect(this->_loader.get(), &MeasurementLoader::loaded, this,
+        &MainWindow::measurementLoaded);
 
     // Nofity Project / Measurement / Probe add/update/remove
     MACRO_CONNECT_TO_PROJECT(
@@ -144,37 +157,12 @@ MainWindow::MainWindow(QWidget* parent)
         this->_project.get(), this->_probe_model.get(), ProbeTableModel);
     MACRO_CONNECT_TO_PROJECT(this->_project.get(), this->_statistic_model.get(),
         StatisticTableModel);
-
-    // Add Reader
-    this->_reader.insert_or_assign("Keysight;.dlog", [](QString file) {
-        return std::make_shared< rlib::keysight::dlog_reader >(
-            file.toStdString());
-    });
-    this->_reader.insert_or_assign("Powerscale;.psi", [](QString file) {
-        return std::make_shared< rlib::powerscale::psi_reader >(
-            file.toStdString());
-    });
-    this->_reader.insert_or_assign("Android;.meta", [](QString file) {
-        return std::make_shared< rlib::android::meta_reader >(
-            file.toStdString());
-    });
-    this->_reader.insert_or_assign("Grimgal;.grim", [](QString file) {
-        return std::make_shared< rlib::grim::grim_reader >(file.toStdString());
-    });
-    this->_reader.insert_or_assign("Grimgal CSV;.csv", [](QString file) {
-        return std::make_shared< rlib::csv::csv_reader >(file.toStdString());
-    });
-    this->_reader.insert_or_assign("Grimgal XML;.xml", [](QString file) {
-        return std::make_shared< rlib::xml::xml_reader >(file.toStdString());
-    });
-    this->_reader.insert_or_assign("Remote;.remote", [](QString file) {
-        return std::make_shared< rlib::remote::reader >(
-            file.toStdString(), 1, 8888, 1);
-    });
 }
 
 MainWindow::~MainWindow()
 {
+    // Waits for readers which are still being constructed
+    this->_loader.reset();
     delete _ui;
 }
 
@@ -219,123 +207,48 @@ std::experimental::optional< std::shared_ptr< Project > > MainWindow::
         ++i;
     }
 
-    this->newProject();
-    this->_project->file = filename;
-
-    QDomDocument projectXml;
-    {
-        QFile file(filename);
-        file.open(QIODevice::ReadOnly);
-        projectXml.setContent(&file);
-        file.close();
+    auto projectFile = ProjectFile::read(filename);
+    if (!projectFile) {
+        std::cout << QObject::tr("Could not load file ").toStdString()
+                  << filename.toStdString()
+                  << QObject::tr(" Reason: Not a project").toStdString()
+                  << std::endl;
+        return {};
     }
-    QDomElement projectElement = projectXml.documentElement();
-    QDomElement measurementsElement =
-        projectElement.firstChildElement("measurements");
-    QDomNodeList measurementsChildNodes = measurementsElement.childNodes();
-    for (int i = 0; i < measurementsChildNodes.length(); i++) {
 
-        QDomElement measurementElement =
-            measurementsChildNodes.at(i).toElement();
-
-        auto measurementFile =
-            measurementElement.firstChildElement("file").text();
+    this->newProject();
+    this->_project->file = filename;
 
-        auto opt_measurment = this->add_measurment(measurementFile);
-        if (!opt_measurment) {
+    for (auto& entry : projectFile->measurements) {
+        // Derived measurements need the files they are computed from
+        if (entry.file.startsWith("=")) {
+            this->_pending_derived.push_back(entry);
             continue;
         }
-        auto measurement = *(opt_measurment);
-
-        measurement->name = measurementElement.firstChildElement("name").text();
-
-        for (int k = 0; k < measurementElement.firstChildElement("sensorname")
-                                .childNodes()
-                                .size();
-             k++) {
-            auto value = measurementElement.firstChildElement("sensorname")
-                             .childNodes()
-                             .at(k);
-            measurement->sensorName[ k ] = (value.toElement().text());
-        }
-        for (int k = 0; k < measurementElement.firstChildElement("unitfactor")
-                                .childNodes()
-                                .size();
-             k++) {
-            auto value = measurementElement.firstChildElement("unitfactor")
-                             .childNodes()
-                             .at(k);
-            measurement->unitFactor[ k ] =
-                (value.toElement().text().toLongLong());
-        }
-        for (int k = 0; k < measurementElement.firstChildElement("offsetx")
-                                .childNodes()
-                                .size();
-             k++) {
-            auto value =
-                measurementElement.firstChildElement("offsetx").childNodes().at(
-                    k);
-            measurement->offsetX[ k ] = (value.toElement().text().toDouble());
-        }
-        for (int k = 0; k < measurementElement.firstChildElement("offsety")
-                                .childNodes()
-                                .size();
-             k++) {
-            auto value =
-                measurementElement.firstChildElement("offsety").childNodes().at(
-                    k);
-            measurement->offsetY[ k ] = (value.toElement().text().toDouble());
-        }
-        for (int k = 0; k < measurementElement.firstChildElement("visible")
-                                .childNodes()
-                                .size();
-             k++) {
-            auto value =
-                measurementElement.firstChildElement("visible").childNodes().at(
-                    k);
-            if (value.toElement().text().toInt() == 1) {
-                measurement->visible[ k ] = (true);
-            }
-            else {
-                measurement->visible[ k ] = (false);
-            }
-        }
-        for (int k = 0;
-             k <
-             measurementElement.firstChildElement("color").childNodes().size();
-             k++) {
-            auto value =
-                measurementElement.firstChildElement("color").childNodes().at(
-                    k);
-            measurement->color[ k ] = (QColor(value.toElement().text()));
-        }
-        for (int k = 0; k < measurementElement.firstChildElement("comment")
-                                .childNodes()
-                                .size();
-             k++) {
-            auto value =
-                measurementElement.firstChildElement("comment").childNodes().at(
-                    k);
-            measurement->comment[ k ] = (value.toElement().text());
-        }
+        // Properties are applied once the file is open
+        auto measurementElement = entry.element;
+        this->add_measurment_async(entry.file,
+            [this, measurementElement](
+                std::shared_ptr< Measurement > measurement) {
+                this->load_measurment_properties(
+                    measurement, measurementElement);
+            });
     }
 
-    QDomElement probeElement = projectElement.firstChildElement("probes");
-    for (int k = 0; k < probeElement.childNodes().size(); k++) {
-        auto probeNode = probeElement.childNodes().at(k);
+    for (auto time : projectFile->probes) {
         auto probe = std::make_shared< Probe >();
         {
-            probe->time = probeNode.toElement().text().toDouble();
+            probe->time = time;
         }
         this->_project->probes.push_back(probe);
     }
 
     this->_project->updatedProject();
+    this->load_pending_derived();
     return this->_project;
 }
 
-std::experimental::optional< std::shared_ptr< Measurement > > MainWindow::
-    add_measurment(QString filename)
+bool MainWindow::check_measurment(QString filename)
 {
     QFileInfo check_file(filename);
     if (!check_file.exists() || !check_file.isFile()) {
@@ -343,7 +256,7 @@ std::experimental::optional< std::shared_ptr< Measurement > > MainWindow::
                   << filename.toStdString()
                   << QObject::tr(" Reason: File Not Found").toStdString()
                   << std::endl;
-        return {};
+        return false;
     }
 
     std::shared_ptr< QAction > action;
@@ -374,64 +287,280 @@ std::experimental::optional< std::shared_ptr< Measurement > > MainWindow::
             "&" + QString::number(i) + " " + recent_action->data().toString());
         ++i;
     }
+    return true;
+}
 
-    auto measurement = std::make_shared< Measurement >();
-
-    // Look for a reader object which already reads the same file
-    bool foundReader = false;
+std::shared_ptr< Measurement > MainWindow::find_measurment(QString filename)
+{
     for (auto& m : this->_project->measurements) {
         if (QString::fromStdString(m->reader->filename()) == filename) {
-            measurement->setReader(m->reader);
-            foundReader = true;
-            break;
+            return m;
         }
     }
-    if (!foundReader) {
-        // Look for a reader
-        for (auto& tuple : this->_reader) {
-            auto ext = std::get< 0 >(tuple).section(';', 1, 1);
-            if (filename.endsWith(ext)) {
-                auto reader = std::get< 1 >(tuple)(filename);
-                std::shared_ptr< rlib::common::reader > measurement_reader =
-                    reader;
-                if (this->_configuration->_use_statistic_reader) {
-                    measurement_reader =
-                        std::make_shared< rlib::common::statistic_reader >(
-                            measurement_reader);
-                }
-                if (this->_configuration->_use_cached_reader) {
-                    measurement_reader =
-                        std::make_shared< rlib::common::cached_reader >(
-                            measurement_reader);
-                }
-                measurement->setReader(measurement_reader);
-                foundReader = true;
-                break;
-            }
-        }
+    return nullptr;
+}
+
+MeasurementLoader::Opened MainWindow::reuse(const Measurement& measurement)
+{
+    return MeasurementLoader::Opened{ measurement.reader, measurement.pyramid,
+        measurement.events, measurement.eventData, measurement.source };
+}
+
+std::shared_ptr< Measurement > MainWindow::insert_measurment(
+    const MeasurementLoader::Opened& opened)
+{
+    auto measurement = std::make_shared< Measurement >();
+    measurement->setReader(opened.reader, opened.pyramid, opened.events,
+        opened.eventData, opened.source);
+
+    // Add Measurement to current Project
+    this->_project->measurements.push_back(measurement);
+    this->_project->addedMeasurement(
+        measurement, this->_project->measurements.size() - 1);
+    return measurement;
+}
+
+void MainWindow::load_measurment_properties(
+    std::shared_ptr< Measurement > measurement, QDomElement measurementElement)
+{
+    ProjectFile::apply(*measurement, measurementElement);
+
+    auto found = std::find(this->_project->measurements.begin(),
+        this->_project->measurements.end(), measurement);
+    if (found != this->_project->measurements.end()) {
+        this->_project->updatedMeasurement(measurement,
+            static_cast< size_t >(
+                found - this->_project->measurements.begin()));
+    }
+}
+
+std::experimental::optional< std::shared_ptr< Measurement > > MainWindow::
+    add_measurment(QString filename)
+{
+    if (!this->check_measurment(filename)) {
+        return {};
     }
+
+    // Look for a reader object which already reads the same file
+    auto existing = this->find_measurment(filename);
+    if (existing) {
+        return this->insert_measurment(reuse(*existing));
+    }
+
+    auto opened = this->_reader.open(filename,
+        this->_configuration->_use_statistic_reader,
+        this->_configuration->_use_cached_reader,
+        this->_configuration->_use_sidecar_cache);
     // Skip file without reader
-    if (!foundReader) {
+    if (!opened) {
         std::cout << QObject::tr("Could not load file ").toStdString()
                   << filename.toStdString()
                   << QObject::tr(" Reason: No reader found").toStdString()
                   << std::endl;
         return {};
     }
-    // Add Measurement to current Project
-    this->_project->measurements.push_back(measurement);
-    this->_project->addedMeasurement(
-        measurement, this->_project->measurements.size() - 1);
-    return measurement;
+    return this->insert_measurment(*opened);
+}
+
+void MainWindow::add_measurment_async(QString filename,
+    std::function< void(std::shared_ptr< Measurement >) > done)
+{
+    if (!this->check_measurment(filename)) {
+        return;
+    }
+
+    // Look for a reader object which already reads the same file
+    auto load = std::make_shared< PendingLoad >();
+    load->filename = filename;
+    load->done = done;
+    this->_load_order.push_back(load);
+    auto existing = this->find_measurment(filename);
+    if (existing) {
+        // Still inserted behind the files requested before
+        load->finished = true;
+        load->opened = reuse(*existing);
+        this->insert_loaded();
+        return;
+    }
+
+    // Settings at the time of the request, the worker must not touch them
+    auto useStatisticReader = this->_configuration->_use_statistic_reader;
+    auto useCachedReader = this->_configuration->_use_cached_reader;
+    auto useSidecarCache = this->_configuration->_use_sidecar_cache;
+    auto id = this->_loader->load(filename, [=]() {
+        return this->_reader.open(
+            filename, useStatisticReader, useCachedReader, useSidecarCache);
+    });
+    this->_pending_loads[ id ] = load;
+
+    // Readers do not report how far they are, so the bar only shows that
+    // the file is still being opened
+    auto widget = new QWidget(this->_ui->statusbar);
+    {
+        auto layout = new QHBoxLayout(widget);
+        layout->setContentsMargins(0, 0, 0, 0);
+        auto label = new QLabel(QFileInfo(filename).fileName(), widget);
+        auto progress = new QProgressBar(widget);
+        progress->setRange(0, 0);
+        progress->setMaximumWidth(80);
+        auto cancel = new QToolButton(widget);
+        cancel->setText(QObject::tr("Cancel"));
+        QObject::connect(cancel, &QToolButton::clicked, this,
+            [this, id]() { this->cancel_load(id); });
+        layout->addWidget(label);
+        layout->addWidget(progress);
+        layout->addWidget(cancel);
+    }
+    this->_ui->statusbar->addPermanentWidget(widget);
+    this->_load_progress[ id ] = widget;
+}
+
+void MainWindow::remove_load_progress(quint64 id)
+{
+    auto found = this->_load_progress.find(id);
+    if (found != this->_load_progress.end()) {
+        this->_ui->statusbar->removeWidget(found->second);
+        found->second->deleteLater();
+        this->_load_progress.erase(found);
+    }
+}
+
+void MainWindow::cancel_load(quint64 id)
+{
+    this->_loader->cancel(id);
+    auto pending = this->_pending_loads.find(id);
+    if (pending != this->_pending_loads.end()) {
+        this->_load_order.erase(std::remove(this->_load_order.begin(),
+                                    this->_load_order.end(), pending->second),
+            this->_load_order.end());
+        this->_pending_loads.erase(pending);
+    }
+    this->remove_load_progress(id);
+    // Files requested after it may be waiting for it
+    this->insert_loaded();
+}
+
+void MainWindow::insert_loaded()
+{
+    while (!this->_load_order.empty() &&
+           this->_load_order.front()->finished) {
+        auto load = this->_load_order.front();
+        this->_load_order.pop_front();
+
+        // Skip file without reader
+        if (!load->opened) {
+            std::cout << QObject::tr("Could not load file ").toStdString()
+                      << load->filename.toStdString()
+                      << QObject::tr(" Reason: No reader found").toStdString()
+                      << std::endl;
+            continue;
+        }
+        // Another load of the same file may have been inserted first
+        auto opened = *load->opened;
+        auto existing = this->find_measurment(load->filename);
+        if (existing) {
+            opened = reuse(*existing);
+        }
+        auto measurement = this->insert_measurment(opened);
+        if (load->done) {
+            load->done(measurement);
+        }
+    }
+    this->load_pending_derived();
+}
+
+std::shared_ptr< Measurement > MainWindow::add_derived_measurment(
+    QString expression, QString& error)
+{
+    // Derived measurements can not be operands, their expression could not
+    // be stored as a file reference
+    auto resolve = [this](const QString& reference) {
+        std::shared_ptr< Measurement > found;
+        bool isIndex = false;
+        auto index = reference.mid(1).toUInt(&isIndex);
+        if (reference.startsWith("m") && isIndex) {
+            if (index < this->_project->measurements.size()) {
+                found = this->_project->measurements[ index ];
+            }
+        }
+        else {
+            found = this->find_measurment(reference);
+        }
+        if (found &&
+            std::dynamic_pointer_cast< DerivedReader >(found->reader)) {
+            found = nullptr;
+        }
+        return found;
+    };
+
+    auto parsed = ChannelExpression::parse(expression, resolve, error);
+    if (!parsed) {
+        return nullptr;
+    }
+    // Coarse tiles and the statistics come from a pyramid of the exact
+    // derived values, unless a live operand would outrun it
+    auto reader = std::make_shared< DerivedReader >(*parsed);
+    std::shared_ptr< SamplePyramid > pyramid;
+    if (!reader->growing()) {
+        pyramid = std::make_shared< SamplePyramid >(reader);
+    }
+    return this->insert_measurment(MeasurementLoader::Opened{
+        reader, pyramid, nullptr, nullptr, nullptr });
+}
+
+void MainWindow::load_pending_derived()
+{
+    if (!this->_load_order.empty() || this->_pending_derived.empty()) {
+        return;
+    }
+    auto entries = std::move(this->_pending_derived);
+    this->_pending_derived.clear();
+
+    for (auto& entry : entries) {
+        QString error;
+        auto measurement =
+            this->add_derived_measurment(entry.file.mid(1), error);
+        if (!measurement) {
+            std::cout << QObject::tr("Could not load derived sensor ")
+                             .toStdString()
+                      << entry.file.toStdString()
+                      << QObject::tr(" Reason: ").toStdString()
+                      << error.toStdString() << std::endl;
+            continue;
+        }
+        this->load_measurment_properties(measurement, entry.element);
+    }
 }
 
 //--//PUBLIC SLOTS
 void MainWindow::newProject()
 {
+    // Files of the old project which are still opening
+    this->_pending_derived.clear();
+    this->_load_order.clear();
+    while (!this->_pending_loads.empty()) {
+        this->cancel_load(this->_pending_loads.begin()->first);
+    }
     this->_project->clear();
     this->_project->updatedProject();
 }
 
+void MainWindow::measurementLoaded(quint64 id)
+{
+    auto opened = this->_loader->take(id);
+    this->remove_load_progress(id);
+
+    auto pending = this->_pending_loads.find(id);
+    if (pending == this->_pending_loads.end()) {
+        // Cancelled while the result was on its way
+        return;
+    }
+    pending->second->finished = true;
+    pending->second->opened = opened;
+    this->_pending_loads.erase(pending);
+    this->insert_loaded();
+}
+
 void MainWindow::openProject()
 {
     QFileInfo info(this->_project->file);
@@ -581,7 +710,7 @@ void MainWindow::addMeasurement()
 {
     QFileInfo info(this->_project->file);
     QString exts = "";
-    for (auto& tuple : this->_reader) {
+    for (auto& tuple : this->_reader.formats()) {
         auto name = std::get< 0 >(tuple).section(';', 0, 0);
         auto ext = std::get< 0 >(tuple).section(';', 1, 1);
         exts += ";;" + name + "(*" + ext + ")";
@@ -589,54 +718,76 @@ void MainWindow::addMeasurement()
     auto filenames =
         QFileDialog::getOpenFileNames(this, QObject::tr("Add Measurement"),
             info.canonicalPath(), QObject::tr("All Files (*.*)") + exts);
+    // All files are opened at the same time
     for (auto& filename : filenames) {
-        this->add_measurment(filename);
+        this->add_measurment_async(filename);
+    }
+}
+
+void MainWindow::addDerivedSensor()
+{
+    bool ok = false;
+    auto expression = QInputDialog::getText(this,
+        QObject::tr("Add Derived Sensor"),
+        QObject::tr("Sensors are m<measurement>.s<sensor>, e.g. "
+                    "m0.s1 * m0.s2 or abs(m0.s0 - m1.s0) / 2"),
+        QLineEdit::Normal, QString(), &ok);
+    if (!ok || expression.trimmed().isEmpty()) {
+        return;
+    }
+
+    QString error;
+    if (!this->add_derived_measurment(expression, error)) {
+        QMessageBox::warning(this, QObject::tr("Add Derived Sensor"), error);
     }
 }
 
 void MainWindow::removeMeasurement()
+{
+    auto foundIndex = this->selected_measurment();
+    if (!foundIndex) {
+        return;
+    }
+
+    auto measurmentToBeRemoved =
+        this->_project->measurements[ foundIndex.value() ];
+
+    // Remove Measurement from current Project
+    this->_project->measurements.erase(
+        this->_project->measurements.begin() + foundIndex.value());
+    this->_project->removedMeasurement(
+        measurmentToBeRemoved, foundIndex.value());
+}
+
+std::experimental::optional< size_t > MainWindow::selected_measurment()
 {
     auto selectedMeasurmentList =
         this->_ui->measurementTree->selectionModel()->selectedIndexes();
     if (selectedMeasurmentList.size() != 1) {
-        return;
+        return {};
     }
 
     // Get selected item
     QModelIndex selectedMeasurment = selectedMeasurmentList.at(0);
 
     // Identify index of selected items
-    std::experimental::optional< size_t > foundIndex;
     for (size_t index = 0; index < this->_project->measurements.size();
          ++index) {
         if (selectedMeasurment.internalPointer() ==
                 this->_project->measurements[ index ].get() ||
             selectedMeasurment.internalPointer() ==
                 this->_project->measurements[ index ]->reader.get()) {
-            foundIndex = index;
-            break;
+            return index;
         }
     }
-
-    if (!foundIndex) {
-        return;
-    }
-
-    auto measurmentToBeRemoved =
-        this->_project->measurements[ foundIndex.value() ];
-
-    // Remove Measurement from current Project
-    this->_project->measurements.erase(
-        this->_project->measurements.begin() + foundIndex.value());
-    this->_project->removedMeasurement(
-        measurmentToBeRemoved, foundIndex.value());
+    return {};
 }
 
 void MainWindow::open_recent_measurments()
 {
     QAction* action = qobject_cast< QAction* >(sender());
     if (action) {
-        this->add_measurment(action->data().toString());
+        this->add_measurment_async(action->data().toString());
     }
 }
 
@@ -678,97 +829,50 @@ void MainWindow::about()
 void MainWindow::setUseCachedReader(bool use)
 {
     if (use != this->_configuration->_use_cached_reader) {
-        if (use) {
-            // Wrap each non cached_reader reader in a cached_reader
-            for (auto& measurement : this->_project->measurements) {
-                auto dyn_cast = dynamic_cast< rlib::common::cached_reader* >(
-                    measurement->reader.get());
-                if (dyn_cast == nullptr) {
-                    measurement->reader =
-                        std::make_shared< rlib::common::cached_reader >(
-                            measurement->reader);
-                }
-            }
-        }
-        else {
-            // Unwrap each reader from the cached_reader
-            for (auto& measurement : this->_project->measurements) {
-                auto dyn_cast = dynamic_cast< rlib::common::cached_reader* >(
-                    measurement->reader.get());
-                if (dyn_cast != nullptr) {
-                    measurement->reader = dyn_cast->_reader;
-                }
-            }
-        }
-        this->_project->updatedProject();
         this->_configuration->_use_cached_reader = use;
+        this->rewrap_readers();
     }
 }
 
 void MainWindow::setUseStatisticReader(bool use)
 {
     if (use != this->_configuration->_use_statistic_reader) {
-        if (use) {
-            for (auto& measurement : this->_project->measurements) {
-                auto dyn_cast_statistic_reader =
-                    dynamic_cast< rlib::common::statistic_reader* >(
-                        measurement->reader.get());
-                if (dyn_cast_statistic_reader != nullptr) {
-                    continue;
-                }
-                auto dyn_cast_cached_reader =
-                    dynamic_cast< rlib::common::cached_reader* >(
-                        measurement->reader.get());
-                if (dyn_cast_cached_reader != nullptr) {
-                    auto dyn_cast_inner_reader =
-                        dynamic_cast< rlib::common::statistic_reader* >(
-                            dyn_cast_cached_reader->_reader.get());
-                    if (dyn_cast_inner_reader != nullptr) {
-                        continue;
-                    }
-                    dyn_cast_cached_reader->_reader =
-                        std::make_shared< rlib::common::statistic_reader >(
-                            dyn_cast_cached_reader->_reader);
-                    dyn_cast_cached_reader->reset();
-                }
-                else {
-                    measurement->reader =
-                        std::make_shared< rlib::common::statistic_reader >(
-                            measurement->reader);
-                }
-            }
-        }
-        else {
-            // Unwrap each reader
-            for (auto& measurement : this->_project->measurements) {
-                auto dyn_cast_statistic_reader =
-                    dynamic_cast< rlib::common::statistic_reader* >(
-                        measurement->reader.get());
-                if (dyn_cast_statistic_reader != nullptr) {
-                    measurement->reader = dyn_cast_statistic_reader->_reader;
-                    continue;
-                }
-                auto dyn_cast_cached_reader =
-                    dynamic_cast< rlib::common::cached_reader* >(
-                        measurement->reader.get());
-                if (dyn_cast_cached_reader != nullptr) {
-                    auto dyn_cast_inner_reader =
-                        dynamic_cast< rlib::common::statistic_reader* >(
-                            dyn_cast_cached_reader->_reader.get());
-                    if (dyn_cast_inner_reader != nullptr) {
-                        dyn_cast_cached_reader->_reader =
-                            dyn_cast_inner_reader->_reader;
-                        dyn_cast_cached_reader->reset();
-                        continue;
-                    }
-                }
-            }
-        }
-        this->_project->updatedProject();
         this->_configuration->_use_statistic_reader = use;
+        this->rewrap_readers();
     }
 }
 
+void MainWindow::rewrap_readers()
+{
+    for (auto& measurement : this->_project->measurements) {
+        // Only files are read through a SerialReader, sidecars, live and
+        // derived readers are never wrapped (see ReaderRegistry::open())
+        auto source = measurement->source;
+        if (!dynamic_cast< SerialReader* >(source.get())) {
+            continue;
+        }
+        // The tile loader may still read the old chain, it is replaced
+        // instead of changed. Pyramid and source stay valid.
+        measurement->reader = ReaderRegistry::wrap(source,
+            this->_configuration->_use_statistic_reader,
+            this->_configuration->_use_cached_reader);
+    }
+    // Drops the tiles read through the old chains
+    this->_project->updatedProject();
+}
+
+void MainWindow::setUseGlRenderer(bool use)
+{
+    this->_configuration->_use_gl_renderer = use;
+    this->_ui->glWidget->update();
+}
+
+void MainWindow::setUseSidecarCache(bool use)
+{
+    // Only affects measurements opened from now on
+    this->_configuration->_use_sidecar_cache = use;
+}
+
 void MainWindow::showOtherSettings()
 {
     this->_other_settings->show();
@@ -782,3 +886,112 @@ void MainWindow::takeScreenshot()
         this, QObject::tr("Save Screenshot"), "", "Image (*.png)");
     frame_buffer.save(filename, "PNG");
 }
+
+void MainWindow::export_range(double begin, double end)
+{
+    auto index = this->selected_measurment();
+    if (!index && this->_project->measurements.size() == 1) {
+        index = size_t(0);
+    }
+    if (!index) {
+        QMessageBox::information(this, QObject::tr("Export"),
+            QObject::tr("Select the measurement to export."));
+        return;
+    }
+    auto measurement = this->_project->measurements[ *index ];
+
+    QString filename = QFileDialog::getSaveFileName(this,
+        QObject::tr("Export"), "",
+        "Comma-separated values (*.csv);;Little endian doubles (*.bin)");
+    if (filename.isEmpty()) {
+        return;
+    }
+
+    // Visible sensors, all of them if none is
+    SampleExporter::Options options;
+    options.format = SampleExporter::formatOf(filename);
+    for (size_t s = 0; s < measurement->visible.size(); ++s) {
+        if (measurement->visible[ s ]) {
+            options.sensors.push_back(s);
+        }
+    }
+    if (options.sensors.empty()) {
+        options.sensors.resize(measurement->visible.size());
+        std::iota(options.sensors.begin(), options.sensors.end(), size_t(0));
+    }
+    // The range is given in view time, every sensor is drawn shifted by its
+    // own offsetX
+    options.begin = begin;
+    options.end = end;
+    for (auto s : options.sensors) {
+        options.shift.push_back(measurement->offsetX.at(s));
+    }
+    // Values as drawn, i.e. also scaled by the unit factor
+    if (this->_ui->actionExport_With_Offsets->isChecked()) {
+        for (auto s : options.sensors) {
+            options.offsetX.push_back(measurement->offsetX.at(s));
+            options.offsetY.push_back(measurement->offsetY.at(s));
+            options.factor.push_back(double(measurement->unitFactor.at(s)));
+        }
+    }
+
+    // Reading and encoding run on worker threads, only the writes (and the
+    // events of the dialog) happen here. The tile loader keeps reading, so
+    // the export goes through the thread safe source.
+    QProgressDialog dialog(QObject::tr("Exporting ") + filename,
+        QObject::tr("Cancel"), 0, 1000, this);
+    dialog.setWindowModality(Qt::WindowModal);
+    dialog.setMinimumDuration(500);
+    auto result = SampleExporter(measurement->source, options)
+                      .write(filename, [&dialog](double done) {
+                          dialog.setValue(static_cast< int >(done * 1000.0));
+                          return !dialog.wasCanceled();
+                      });
+    dialog.reset();
+    if (!result.error.isEmpty() && !dialog.wasCanceled()) {
+        QMessageBox::warning(this, QObject::tr("Export"), result.error);
+    }
+}
+
+void MainWindow::exportVisibleRange()
+{
+    auto window = this->_ui->glWidget->timeWindow();
+    this->export_range(window.first, window.second);
+}
+
+void MainWindow::exportProbeRange()
+{
+    if (this->_project->probes.size() < 2) {
+        QMessageBox::information(this, QObject::tr("Export"),
+            QObject::tr("Place two probes around the range to export."));
+        return;
+    }
+    auto probes = std::minmax_element(this->_project->probes.begin(),
+        this->_project->probes.end(),
+        [](auto a, auto b) { return a->time < b->time; });
+    this->export_range((*probes.first)->time, (*probes.second)->time);
+}
+
+void MainWindow::showFrameTiming(bool show)
+{
+    this->_ui->glWidget->setShowFrameStats(show);
+}
+
+void MainWindow::logFrameTiming(bool log)
+{
+    auto stats = this->_ui->glWidget->frameStats();
+    if (!log) {
+        stats->setLogFile(QString());
+        return;
+    }
+    QString filename = QFileDialog::getSaveFileName(this,
+        QObject::tr("Log Frame Timing"), "", "Comma-separated values (*.csv)");
+    if (filename.isEmpty() || !stats->setLogFile(filename)) {
+        this->_ui->actionLog_Frame_Timing->setChecked(false);
+    }
+}
+
+void MainWindow::followLiveData(bool follow)
+{
+    this->_ui->glWidget->setFollowLive(follow);
+}
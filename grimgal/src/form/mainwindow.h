@@ -25,11 +25,16 @@
 #define MAINWINDOW_H
 
 // Qt
+#include <QDomElement>
 #include <QMainWindow>
+#include <QWidget>
 
 // Own
 #include "data/configuration.h"
+#include "data/measurement_loader.h"
 #include "data/project.h"
+#include "data/project_file.h"
+#include "data/reader_registry.h"
 #include "eventfilter/probeview/removeprobe.h"
 #include "form/settings_dialog.h"
 #include "model/eventtablemodel.h"
@@ -40,9 +45,11 @@
 #include <rlib/common/reader.h>
 
 // StdLib
+#include <deque>
 #include <functional>
 #include <map>
 #include <memory>
+#include <vector>
 
 // Macros
 #define MACRO_CONNECT_TO_PROJECT(_SIGNAL, _SLOT, _TYPE)                        \
@@ -87,9 +94,7 @@ class MainWindow : public QMainWindow {
     std::shared_ptr< eventfilter::probeview::RemoveProbe >
         _event_filter_probe_view_remove_probe;
 
-    std::map< QString,
-        std::function< std::shared_ptr< rlib::common::reader >(QString) > >
-        _reader;
+    ReaderRegistry _reader;
 
     // Dialogs
     std::unique_ptr< settings_dialog > _other_settings;
@@ -98,6 +103,57 @@ class MainWindow : public QMainWindow {
     std::vector< std::shared_ptr< QAction > > _recent_projects;
     std::vector< std::shared_ptr< QAction > > _recent_measurments;
 
+    // Files being opened in the background, with the callback to run once
+    // they are part of the project and their status bar entry. They become
+    // part of the project in the order they were requested, m<index>
+    // references of derived expressions depend on it.
+    struct PendingLoad {
+        QString filename;
+        std::function< void(std::shared_ptr< Measurement >) > done;
+        bool finished = false;
+        std::experimental::optional< MeasurementLoader::Opened > opened;
+    };
+    std::unique_ptr< MeasurementLoader > _loader;
+    std::map< quint64, std::shared_ptr< PendingLoad > > _pending_loads;
+    std::deque< std::shared_ptr< PendingLoad > > _load_order;
+    std::map< quint64, QWidget* > _load_progress;
+    // Derived measurements of the project being opened, created once all
+    // of its files are open
+    std::vector< ProjectFile::Entry > _pending_derived;
+
+    private:
+    // Checks that the file exists and adds it to the recent measurements
+    bool check_measurment(QString filename);
+    // Measurement of the project which already reads the file (if any)
+    std::shared_ptr< Measurement > find_measurment(QString filename);
+    std::shared_ptr< Measurement > insert_measurment(
+        const MeasurementLoader::Opened& opened);
+    // Reader, pyramid and events of an existing measurement, to open the
+    // same file again
+    static MeasurementLoader::Opened reuse(const Measurement& measurement);
+    // Applies the properties stored in a project file
+    void load_measurment_properties(std::shared_ptr< Measurement > measurement,
+        QDomElement measurementElement);
+    // Index of the measurement selected in the measurement tree (if any)
+    std::experimental::optional< size_t > selected_measurment();
+    // Asks for a file and streams [begin, end] (view time) of the visible
+    // sensors of the selected measurement into it
+    void export_range(double begin, double end);
+    void remove_load_progress(quint64 id);
+    void cancel_load(quint64 id);
+    // Inserts the finished loads up to the first one still being opened
+    void insert_loaded();
+    // Adds a measurement with a single sensor computed from the expression,
+    // returns nullptr and sets error if it can not be parsed
+    std::shared_ptr< Measurement > add_derived_measurment(
+        QString expression, QString& error);
+    // Creates the derived measurements of an opened project as soon as no
+    // file is being opened anymore
+    void load_pending_derived();
+    // Replaces the readers of the files by new chains with the rlib caches
+    // of the current settings
+    void rewrap_readers();
+
     public:
     explicit MainWindow(QWidget* parent = 0);
     ~MainWindow();
@@ -110,7 +166,16 @@ class MainWindow : public QMainWindow {
     std::experimental::optional< std::shared_ptr< Measurement > >
         add_measurment(QString filename);
 
+    // Opens the file on a worker thread and adds it once it is open, done
+    // is then called with the new measurement
+    void add_measurment_async(QString filename,
+        std::function< void(std::shared_ptr< Measurement >) > done =
+            nullptr);
+
     public slots:
+    // MeasurementLoader
+    void measurementLoaded(quint64 id);
+
     // menubar->Project
     void newProject();
     void openProject();
@@ -124,6 +189,9 @@ class MainWindow : public QMainWindow {
     // menbubar->Measurement->Recent Measurements
     void open_recent_measurments();
 
+    // menubar->Measurement->Add derived sensor
+    void addDerivedSensor();
+
     // Minus-Button in Measurements dock
     void removeMeasurement();
 
@@ -142,11 +210,32 @@ class MainWindow : public QMainWindow {
     // Settings->Use statistic reader
     void setUseStatisticReader(bool use);
 
+    // Settings->Use OpenGL renderer
+    void setUseGlRenderer(bool use);
+
+    // Settings->Use sidecar cache
+    void setUseSidecarCache(bool use);
+
     // Settings->Other Settings
     void showOtherSettings();
 
     // Extras->Screenshot
     void takeScreenshot();
+
+    // Extras->Export visible range
+    void exportVisibleRange();
+
+    // Extras->Export probe range
+    void exportProbeRange();
+
+    // Extras->Show frame timing
+    void showFrameTiming(bool show);
+
+    // Extras->Log frame timing
+    void logFrameTiming(bool log);
+
+    // Extras->Follow live data
+    void followLiveData(bool follow);
 };
 
 #endif // MAINWINDOW_H
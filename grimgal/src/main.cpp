@@ -23,14 +23,27 @@
 
 // Qt
 #include <QApplication>
+#include <QGuiApplication>
+#include <QtGlobal>
 
 // Own
+#include "cli/batch.h"
 #include "form/mainwindow.h"
 
 // StdLib
 
 int main(int argc, char* argv[])
 {
+    // Batch runs must work without a display, rendering only needs fonts
+    // and a QImage, which the offscreen platform provides
+    if (cli::isBatch(argc, argv)) {
+        if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+            qputenv("QT_QPA_PLATFORM", "offscreen");
+        }
+        QGuiApplication app(argc, argv);
+        return cli::batch(app);
+    }
+
     QApplication app(argc, argv);
     {
         app.setAttribute(Qt::AA_UseHighDpiPixmaps);
@@ -58,7 +71,7 @@ int main(int argc, char* argv[])
             mainWindow.open_project(filename);
         }
         else {
-            mainWindow.add_measurment(filename);
+            mainWindow.add_measurment_async(filename);
         }
     }
 
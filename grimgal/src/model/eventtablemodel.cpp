@@ -31,6 +31,7 @@
 
 // Own
 #include "data/configuration.h"
+#include "data/event_store.h"
 #include "data/measurement.h"
 #include "data/probe.h"
 #include "data/project.h"
@@ -40,9 +41,12 @@
 
 // StdLib
 #include <algorithm>
+#include <functional>
 #include <future>
 #include <iostream>
 #include <memory>
+#include <queue>
+#include <set>
 #include <thread>
 #include <tuple>
 #include <vector>
@@ -53,7 +57,7 @@ EventTableModel::EventTableModel(std::shared_ptr< Configuration > configuration,
 {
     this->_configuration = configuration;
     this->_project = project;
-    this->rebuildEventCache();
+    this->syncSources();
 }
 
 void EventTableModel::addMeasurement(std::shared_ptr< Measurement > m)
@@ -62,7 +66,7 @@ void EventTableModel::addMeasurement(std::shared_ptr< Measurement > m)
 
 void EventTableModel::removeMeasurement(std::shared_ptr< Measurement > m)
 {
-    this->_event_cache.clear();
+    this->removeSource(m.get());
     this->projectChanged();
 }
 
@@ -73,15 +77,16 @@ QVariant EventTableModel::data(const QModelIndex& index, int role) const
     }
 
     if (role == Qt::DisplayRole) {
-        if (static_cast< size_t >(index.row()) >= this->_event_cache.size()) {
+        this->updateRows();
+        if (static_cast< size_t >(index.row()) >= this->_rows.size()) {
             return QVariant();
         }
-        auto m = std::get< std::shared_ptr< Measurement > >(
-            this->_event_cache[ static_cast< size_t >(index.row()) ]);
-        auto e = std::get< rlib::common::event_data >(
-            this->_event_cache[ static_cast< size_t >(index.row()) ]);
+        auto& row = this->_rows[ static_cast< size_t >(index.row()) ];
+        auto& m = row.source->measurement;
+        auto& e = row.source->events.at(row.event);
         if (index.column() == 0) {
-            return QVariant(util::format_time(e.time));
+            return QVariant(
+                util::format_time(row.source->events.time(row.event)));
         }
         if (index.column() == 1) {
             QString source = m->name;
@@ -140,7 +145,8 @@ QVariant EventTableModel::headerData(
 
 int EventTableModel::rowCount(const QModelIndex& parent) const
 {
-    return static_cast< int >(this->_event_cache.size());
+    this->updateRows();
+    return static_cast< int >(this->_rows.size());
 }
 
 int EventTableModel::columnCount(const QModelIndex& parent) const
@@ -150,72 +156,40 @@ int EventTableModel::columnCount(const QModelIndex& parent) const
 
 void EventTableModel::doubleClicked(const QModelIndex& index)
 {
-    emit this->goTo(std::get< rlib::common::event_data >(
-        this->_event_cache[ static_cast< size_t >(index.row()) ])
-                        .time);
+    this->updateRows();
+    auto& row = this->_rows[ static_cast< size_t >(index.row()) ];
+    emit this->goTo(row.source->events.time(row.event));
 }
 
 void EventTableModel::sectionClicked(int section)
 {
-    emit this->goTo(std::get< rlib::common::event_data >(
-        this->_event_cache[ static_cast< size_t >(section) ])
-                        .time);
+    this->updateRows();
+    auto& row = this->_rows[ static_cast< size_t >(section) ];
+    emit this->goTo(row.source->events.time(row.event));
 }
 
 void EventTableModel::addedMeasurement(
     std::shared_ptr< Measurement > m, size_t index)
 {
-    auto events = m->reader->events(0.0, -1.0);
-    if (!events.empty()) {
-        // Add all events to the event cache
-        for (auto& e : events) {
-            this->_event_cache.push_back({ m, e });
-        }
-
-        this->sortEventCache();
-    }
+    this->addSource(m);
     this->projectChanged();
 }
 void EventTableModel::updatedMeasurement(
     std::shared_ptr< Measurement > m, size_t index)
 {
-    // Remove all events from Measurement m
-    this->_event_cache.erase(
-        std::remove_if(this->_event_cache.begin(), this->_event_cache.end(),
-            [&m](auto t) {
-                return std::get< std::shared_ptr< Measurement > >(t).get() ==
-                       m.get();
-            }),
-        this->_event_cache.end());
-    // Readd events
-    auto events = m->reader->events(0.0, -1.0);
-    if (!events.empty()) {
-        // Add all events to the event cache
-        for (auto& e : events) {
-            this->_event_cache.push_back({ m, e });
-        }
-
-        this->sortEventCache();
-    }
+    this->updateSource(m);
     this->projectChanged();
 }
 void EventTableModel::removedMeasurement(
     std::shared_ptr< Measurement > m, size_t index)
 {
-    // Remove all events from Measurement m
-    this->_event_cache.erase(
-        std::remove_if(this->_event_cache.begin(), this->_event_cache.end(),
-            [&m](auto t) {
-                return std::get< std::shared_ptr< Measurement > >(t).get() ==
-                       m.get();
-            }),
-        this->_event_cache.end());
+    this->removeSource(m.get());
     this->projectChanged();
 }
 
 void EventTableModel::updatedProject()
 {
-    this->rebuildEventCache();
+    this->syncSources();
     this->projectChanged();
 }
 
@@ -236,31 +210,130 @@ void EventTableModel::projectChanged()
     emit this->layoutChanged();
 }
 
-void EventTableModel::rebuildEventCache()
+void EventTableModel::addSource(std::shared_ptr< Measurement > m)
+{
+    if (this->_sources.count(m.get()) != 0) {
+        this->updateSource(m);
+        return;
+    }
+    // Events as read when the file was opened, the reader is not asked again
+    std::unique_ptr< Source > source(
+        new Source{ m, EventStore(*m->eventData) });
+    source->events.setOffsets(m->offsetX);
+    if (!source->events.empty()) {
+        this->_pending.insert(source.get());
+    }
+    this->_sources[ m.get() ] = std::move(source);
+}
+
+void EventTableModel::removeSource(const Measurement* m)
+{
+    auto found = this->_sources.find(m);
+    if (found == this->_sources.end()) {
+        return;
+    }
+    auto source = found->second.get();
+    this->_pending.erase(source);
+    this->_rows.erase(std::remove_if(this->_rows.begin(), this->_rows.end(),
+                          [source](const Row& row) {
+                              return row.source == source;
+                          }),
+        this->_rows.end());
+    this->_sources.erase(found);
+}
+
+void EventTableModel::updateSource(const std::shared_ptr< Measurement >& m)
 {
-    // Clear cache
-    this->_event_cache.clear();
+    auto found = this->_sources.find(m.get());
+    if (found == this->_sources.end()) {
+        this->addSource(m);
+        return;
+    }
+    // Only a moved sensor changes the order, anything else is just repainted
+    if (found->second->events.setOffsets(m->offsetX)) {
+        this->_pending.insert(found->second.get());
+    }
+}
 
-    // Add all events of updated project to cache
+void EventTableModel::syncSources()
+{
+    std::set< const Measurement* > measurements;
     for (auto& m : this->_project->measurements) {
-        auto events = m->reader->events(0.0, -1.0);
-        if (!events.empty()) {
-            // Add all events to cache
-            for (auto& e : events) {
-                this->_event_cache.push_back({ m, e });
-            }
+        measurements.insert(m.get());
+        this->updateSource(m);
+    }
+    for (auto it = this->_sources.begin(); it != this->_sources.end();) {
+        auto m = (it++)->first;
+        if (measurements.count(m) == 0) {
+            this->removeSource(m);
         }
     }
-
-    this->sortEventCache();
 }
 
-void EventTableModel::sortEventCache()
+void EventTableModel::updateRows() const
 {
-    // Sort events by time
-    auto comp = [](auto t1, auto t2) {
-        return std::get< rlib::common::event_data >(t1).time <
-               std::get< rlib::common::event_data >(t2).time;
+    if (this->_rows_valid && this->_pending.empty()) {
+        return;
+    }
+
+    // Sources to merge, the rows of all others count as one more run
+    std::vector< Row > kept;
+    std::vector< const Source* > merge;
+    if (this->_rows_valid) {
+        kept.reserve(this->_rows.size());
+        for (auto& row : this->_rows) {
+            if (this->_pending.count(row.source) == 0) {
+                kept.push_back(row);
+            }
+        }
+        merge.assign(this->_pending.begin(), this->_pending.end());
+    }
+    else {
+        for (auto& source : this->_sources) {
+            merge.push_back(source.second.get());
+        }
+    }
+    this->_pending.clear();
+
+    auto total = kept.size();
+    for (auto source : merge) {
+        total += source->events.size();
+    }
+
+    // k-way merge over (drawn time, run, position), run merge.size() is kept
+    typedef std::tuple< double, size_t, size_t > Head;
+    std::priority_queue< Head, std::vector< Head >, std::greater< Head > >
+        heads;
+    auto rowAt = [&](size_t run, size_t position) {
+        if (run == merge.size()) {
+            return kept[ position ];
+        }
+        return Row{ merge[ run ], position };
+    };
+    auto runSize = [&](size_t run) {
+        return run == merge.size() ? kept.size() : merge[ run ]->events.size();
+    };
+    auto push = [&](size_t run, size_t position) {
+        if (position < runSize(run)) {
+            auto row = rowAt(run, position);
+            heads.emplace(row.source->events.time(row.event), run, position);
+        }
     };
-    std::sort(this->_event_cache.begin(), this->_event_cache.end(), comp);
+    for (size_t run = 0; run <= merge.size(); ++run) {
+        push(run, 0);
+    }
+
+    std::vector< Row > rows;
+    rows.reserve(total);
+    while (!heads.empty()) {
+        auto head = heads.top();
+        heads.pop();
+        auto run = std::get< 1 >(head);
+        auto position = std::get< 2 >(head);
+        rows.push_back(rowAt(run, position));
+        push(run, position + 1);
+    }
+
+    this->_rows = std::move(rows);
+    this->_rows_valid = true;
 }
@@ -30,13 +30,16 @@
 
 // Own
 #include "data/configuration.h"
+#include "data/event_store.h"
 #include "data/measurement.h"
 #include "data/probe.h"
 #include "data/project.h"
 #include <rlib/common/event_data.h>
 
 // StdLib
+#include <map>
 #include <memory>
+#include <set>
 #include <tuple>
 #include <vector>
 
@@ -47,14 +50,30 @@ class EventTableModel : public QAbstractTableModel {
     std::shared_ptr< Project > _project;
     std::shared_ptr< Configuration > _configuration;
 
-    mutable std::vector<
-        std::tuple< std::shared_ptr< Measurement >, rlib::common::event_data > >
-        _event_cache;
+    // Events of each measurement, read once from its reader
+    struct Source {
+        std::shared_ptr< Measurement > measurement;
+        EventStore events;
+    };
+    std::map< const Measurement*, std::unique_ptr< Source > > _sources;
+
+    // Rows in drawn time order, merged lazily from the sources. After a
+    // change of one source only its rows are merged into the others again.
+    struct Row {
+        const Source* source;
+        size_t event;
+    };
+    mutable std::vector< Row > _rows;
+    mutable bool _rows_valid = false;
+    mutable std::set< const Source* > _pending;
 
     private:
     void projectChanged();
-    void rebuildEventCache();
-    void sortEventCache();
+    void addSource(std::shared_ptr< Measurement > m);
+    void removeSource(const Measurement* m);
+    void updateSource(const std::shared_ptr< Measurement >& m);
+    void syncSources();
+    void updateRows() const;
 
     public:
     EventTableModel(std::shared_ptr< Configuration > configuration,
@@ -25,6 +25,7 @@
 #include <QAbstractItemModel>
 #include <QMap>
 #include <QModelIndex>
+#include <QRunnable>
 #include <QTextStream>
 #include <QVariant>
 #include <QVector>
@@ -33,12 +34,37 @@
 #include "data/configuration.h"
 #include "data/measurement.h"
 #include "data/project.h"
+#include "data/sample_block.h"
 #include "model/probetablemodel.h"
 #include "util/number_format.h"
 
 // StdLib
+#include <algorithm>
+#include <cmath>
+#include <functional>
 #include <iostream>
+#include <limits>
 #include <memory>
+#include <numeric>
+#include <set>
+
+namespace {
+    class LookupTask : public QRunnable {
+        private:
+        std::function< void() > _task;
+
+        public:
+        LookupTask(std::function< void() > task)
+            : _task(task)
+        {
+        }
+
+        virtual void run() override
+        {
+            this->_task();
+        }
+    };
+}
 
 ProbeTableModel::ProbeTableModel(std::shared_ptr< Configuration > configuration,
     std::shared_ptr< Project > project, QObject* parent)
@@ -47,11 +73,50 @@ ProbeTableModel::ProbeTableModel(std::shared_ptr< Configuration > configuration,
     this->_configuration = configuration;
     this->_project = project;
     this->_probe_resolution = 1;
+
+    // A single worker, the readers are shared with the tile loader
+    this->_pool.setMaxThreadCount(1);
+    QObject::connect(this, &ProbeTableModel::valuesLoaded, this,
+        [this]() {
+            emit this->dataChanged(this->index(1, 0),
+                this->index(this->rowCount() - 1, this->columnCount() - 1));
+        },
+        Qt::QueuedConnection);
+}
+
+ProbeTableModel::~ProbeTableModel()
+{
+    this->_pool.clear();
+    this->_pool.waitForDone();
 }
 
 void ProbeTableModel::projectChanged()
 {
-    this->_value_cache.clear();
+    this->_rows_valid = false;
+
+    // Forget removed probes and measurements, everything else stays valid
+    std::set< const Probe* > probes;
+    for (auto& probe : this->_project->probes) {
+        probes.insert(probe.get());
+    }
+    std::set< const Measurement* > measurements;
+    for (auto& measurement : this->_project->measurements) {
+        measurements.insert(measurement.get());
+    }
+    std::lock_guard< std::mutex > lock(this->_mutex);
+    for (auto it = this->_values.begin(); it != this->_values.end();) {
+        if (probes.count(std::get< 0 >(it->first)) == 0 ||
+            measurements.count(std::get< 1 >(it->first)) == 0) {
+            it = this->_values.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+    // Removed probes may be followed by new ones at the same address
+    ++this->_generation;
+    this->_pending.clear();
+
     emit this->dataChanged(QModelIndex(),
         this->index(this->rowCount() - 1, this->columnCount() - 1));
     emit this->layoutChanged();
@@ -60,10 +125,41 @@ void ProbeTableModel::projectChanged()
 void ProbeTableModel::setResolution(int_fast32_t newResolution)
 {
     this->_probe_resolution = newResolution;
-    this->_value_cache.clear();
-    emit this->dataChanged(QModelIndex(),
+    emit this->dataChanged(this->index(1, 0),
         this->index(this->rowCount() - 1, this->columnCount() - 1));
-    emit this->layoutChanged();
+}
+
+void ProbeTableModel::dropValues(
+    const Probe* probe, const Measurement* measurement)
+{
+    std::lock_guard< std::mutex > lock(this->_mutex);
+    for (auto it = this->_values.begin(); it != this->_values.end();) {
+        if ((probe == nullptr || std::get< 0 >(it->first) == probe) &&
+            (measurement == nullptr ||
+                std::get< 1 >(it->first) == measurement)) {
+            it = this->_values.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+    ++this->_generation;
+    for (auto it = this->_pending.begin(); it != this->_pending.end();) {
+        if ((probe == nullptr || std::get< 0 >(it->first) == probe) &&
+            (measurement == nullptr ||
+                std::get< 1 >(it->first) == measurement)) {
+            it = this->_pending.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+void ProbeTableModel::emitColumnChanged(int column)
+{
+    emit this->dataChanged(
+        this->index(0, column), this->index(this->rowCount() - 1, column));
 }
 
 void ProbeTableModel::sectionClicked(int section)
@@ -80,6 +176,7 @@ void ProbeTableModel::addedMeasurement(
 void ProbeTableModel::updatedMeasurement(
     std::shared_ptr< Measurement > m, size_t index)
 {
+    this->dropValues(nullptr, m.get());
     this->projectChanged();
 }
 void ProbeTableModel::removedMeasurement(
@@ -99,7 +196,8 @@ void ProbeTableModel::addedProbe(std::shared_ptr< Probe > p, size_t index)
 }
 void ProbeTableModel::updatedProbe(std::shared_ptr< Probe > p, size_t index)
 {
-    this->projectChanged();
+    this->dropValues(p.get(), nullptr);
+    this->emitColumnChanged(static_cast< int >(index));
 }
 void ProbeTableModel::removedProbe(std::shared_ptr< Probe > p, size_t index)
 {
@@ -111,13 +209,11 @@ bool ProbeTableModel::setData(
 {
     if (role == Qt::EditRole || role == Qt::DisplayRole) {
         if (index.row() == 0) {
-            this->_value_cache[ index.column() ].clear();
-            this->_value_cache[ index.column() ][ 0 ] = value.toDouble();
-            this->_project->probes[ static_cast< size_t >(index.column()) ]
-                ->time = value.toDouble();
-            emit this->dataChanged(QModelIndex(),
-                this->index(this->rowCount() - 1, this->columnCount() - 1),
-                QVector< int >(role));
+            auto& probe =
+                this->_project->probes[ static_cast< size_t >(index.column()) ];
+            probe->time = value.toDouble();
+            this->dropValues(probe.get(), nullptr);
+            this->emitColumnChanged(index.column());
             return true;
         }
     }
@@ -138,46 +234,162 @@ QVariant ProbeTableModel::data(const QModelIndex& index, int role) const
                                       .at(static_cast< size_t >(index.column()))
                                       ->time));
         }
-        else if (this->_value_cache.contains(index.column()) &&
-                 this->_value_cache[ index.column() ].contains(index.row())) {
-            auto value = this->_value_cache[ index.column() ][ index.row() ];
-            auto unit = this->_unit_cache[ index.column() ][ index.row() ];
-            return QVariant(util::format_number(value, unit));
+
+        this->updateRows();
+        auto rowIndex = static_cast< size_t >(index.row() - 1);
+        if (rowIndex >= this->_rows.size()) {
+            return QVariant();
         }
-        else {
-            int row = index.row() - 1;
-            for (auto& measurement : this->_project->measurements) {
-                if (static_cast< size_t >(row) <
-                    measurement->reader->sensors().size()) {
-                    size_t datumIndex = static_cast< size_t >(row);
-                    double time = this->_project->probes
-                                      .at(static_cast< size_t >(index.column()))
-                                      ->time +
-                                  measurement->offsetX.at(datumIndex);
-                    auto datum = measurement->reader->sample(
-                        time, int_fast32_t(this->_probe_resolution));
-                    if (datum.values.size() != measurement->offsetY.size()) {
-                        return QVariant("---");
-                    }
-                    auto value = datum.values.at(datumIndex) +
-                                 measurement->offsetY.at(datumIndex);
-                    this->_value_cache[ index.column() ].insert(
-                        index.row(), value);
-                    auto unit = QString::fromStdString(
-                        measurement->reader->sensors()[ datumIndex ].unit);
-                    this->_unit_cache[ index.column() ].insert(
-                        index.row(), unit);
-                    return QVariant(util::format_number(value, unit));
-                }
-                row -= measurement->reader->sensors().size();
+        auto& row = this->_rows[ rowIndex ];
+        auto& probe =
+            this->_project->probes.at(static_cast< size_t >(index.column()));
+        ValueKey key(
+            probe.get(), row.measurement.get(), this->_probe_resolution);
+        std::unique_lock< std::mutex > lock(this->_mutex);
+        auto found = this->_values.find(key);
+        if (found == this->_values.end()) {
+            if (this->_pending.count(key) == 0) {
+                lock.unlock();
+                this->evaluate(row.measurement);
             }
+            return QVariant("...");
         }
-        return QVariant();
+        if (row.sensor >= found->second.size() ||
+            std::isnan(found->second[ row.sensor ])) {
+            return QVariant("---");
+        }
+        return QVariant(
+            util::format_number(found->second[ row.sensor ], row.unit));
     }
 
     return QVariant();
 }
 
+void ProbeTableModel::updateRows() const
+{
+    if (this->_rows_valid) {
+        return;
+    }
+    this->_rows.clear();
+    for (auto& measurement : this->_project->measurements) {
+        auto sensors = measurement->reader->sensors();
+        for (size_t i = 0; i < sensors.size(); ++i) {
+            this->_rows.push_back({ measurement, i,
+                QString::fromStdString(sensors[ i ].unit) });
+        }
+    }
+    this->_rows_valid = true;
+}
+
+void ProbeTableModel::evaluate(
+    const std::shared_ptr< Measurement >& measurement) const
+{
+    auto resolution = this->_probe_resolution;
+    auto sensorCount = measurement->reader->sensors().size();
+
+    // Sensors are drawn shifted by their offsetX, so a probe hits each group
+    // of equally shifted sensors at its own sample time
+    std::map< double, std::vector< size_t > > groups;
+    for (size_t s = 0; s < sensorCount; ++s) {
+        groups[ measurement->offsetX.at(s) ].push_back(s);
+    }
+
+    // Everything the worker needs is copied, the project may change while
+    // the lookup runs
+    struct Query {
+        double time;
+        ValueKey key;
+        std::vector< size_t > sensors;
+    };
+    std::vector< Query > queries;
+    std::vector< ValueKey > keys;
+    uint64_t generation;
+    {
+        std::lock_guard< std::mutex > lock(this->_mutex);
+        generation = this->_generation;
+        for (auto& probe : this->_project->probes) {
+            ValueKey key(probe.get(), measurement.get(), resolution);
+            if (this->_values.count(key) != 0 ||
+                this->_pending.count(key) != 0) {
+                continue;
+            }
+            this->_pending[ key ] = generation;
+            keys.push_back(key);
+            for (auto& group : groups) {
+                queries.push_back(
+                    { probe->time - group.first, key, group.second });
+            }
+        }
+    }
+    if (keys.empty()) {
+        return;
+    }
+    std::sort(queries.begin(), queries.end(),
+        [](const Query& a, const Query& b) { return a.time < b.time; });
+
+    // Values as the trace draws them
+    auto source = measurement->source;
+    auto factor = measurement->unitFactor;
+    auto offsetY = measurement->offsetY;
+    this->_pool.start(new LookupTask([this, source, factor, offsetY,
+                                         sensorCount, resolution, queries,
+                                         keys, generation]() {
+        auto nan = std::numeric_limits< double >::quiet_NaN();
+        std::map< ValueKey, std::vector< double > > values;
+        for (auto& key : keys) {
+            values[ key ].assign(sensorCount, nan);
+        }
+
+        std::vector< size_t > channels(sensorCount);
+        std::iota(channels.begin(), channels.end(), size_t(0));
+        auto halfWidth = 1.0 / double(std::max(resolution, int_fast32_t(1)));
+
+        // One forward pass: queries whose windows overlap share a single read
+        for (size_t first = 0; first < queries.size();) {
+            auto last = first + 1;
+            while (last < queries.size() &&
+                   queries[ last ].time - halfWidth <=
+                       queries[ last - 1 ].time + halfWidth) {
+                ++last;
+            }
+            auto block = readSamples(*source,
+                queries[ first ].time - halfWidth,
+                queries[ last - 1 ].time + halfWidth, resolution, channels);
+
+            for (auto q = first; q < last && !block.empty(); ++q) {
+                auto& query = queries[ q ];
+                // Nearest sample to the probe
+                auto r =
+                    std::min(block.lowerBound(query.time), block.size() - 1);
+                if (r > 0 && query.time - block.time()[ r - 1 ] <
+                                 block.time()[ r ] - query.time) {
+                    --r;
+                }
+                auto& value = values[ query.key ];
+                for (auto s : query.sensors) {
+                    value[ s ] = block.values(s)[ r ] * double(factor.at(s)) +
+                                 offsetY.at(s);
+                }
+            }
+            first = last;
+        }
+
+        std::lock_guard< std::mutex > lock(this->_mutex);
+        for (auto& value : values) {
+            auto pending = this->_pending.find(value.first);
+            if (pending == this->_pending.end() ||
+                pending->second != generation) {
+                // Dropped while being looked up
+                continue;
+            }
+            this->_pending.erase(pending);
+            this->_values[ value.first ] = std::move(value.second);
+        }
+        emit this->valuesLoaded();
+    }));
+}
+
+
 Qt::ItemFlags ProbeTableModel::flags(const QModelIndex& index) const
 {
     if (!index.isValid()) {
@@ -204,17 +416,14 @@ QVariant ProbeTableModel::headerData(
                 QTextStream(&header) << QObject::tr("Time");
             }
             else {
-                size_t row = 1;
-                for (auto& measurement : this->_project->measurements) {
-                    if (row + measurement->reader->sensors().size() >
-                        static_cast< size_t >(section)) {
-                        size_t index = static_cast< size_t >(section) - row;
-                        QTextStream(&header)
-                            << measurement->name << " - "
-                            << measurement->sensorName.at(index);
-                        break;
-                    }
-                    row += measurement->reader->sensors().size();
+                this->updateRows();
+                auto row = static_cast< size_t >(section - 1);
+                if (row < this->_rows.size()) {
+                    auto& measurement = this->_rows[ row ].measurement;
+                    auto sensor = this->_rows[ row ].sensor;
+                    QTextStream(&header)
+                        << measurement->name << " - "
+                        << measurement->sensorName.at(sensor);
                 }
             }
             return QVariant(header);
@@ -225,11 +434,8 @@ QVariant ProbeTableModel::headerData(
 
 int ProbeTableModel::rowCount(const QModelIndex& parent) const
 {
-    int rows = 1;
-    for (auto& measurement : this->_project->measurements) {
-        rows += measurement->reader->sensors().size();
-    }
-    return rows;
+    this->updateRows();
+    return static_cast< int >(this->_rows.size()) + 1;
 }
 
 int ProbeTableModel::columnCount(const QModelIndex& parent) const
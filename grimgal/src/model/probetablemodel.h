@@ -27,6 +27,7 @@
 // Qt
 #include <QAbstractItemModel>
 #include <QMap>
+#include <QThreadPool>
 
 // Own
 #include "data/configuration.h"
@@ -34,7 +35,12 @@
 #include "data/project.h"
 
 // StdLib
+#include <cstdint>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
 
 class ProbeTableModel : public QAbstractTableModel {
     Q_OBJECT
@@ -42,14 +48,45 @@ class ProbeTableModel : public QAbstractTableModel {
     private:
     std::shared_ptr< Project > _project;
     std::shared_ptr< Configuration > _configuration;
-    mutable QMap< int, QMap< int, double > > _value_cache;
-    mutable QMap< int, QMap< int, QString > > _unit_cache;
     int_fast32_t _probe_resolution;
 
+    // Measurement and sensor of each row below the time row
+    struct Row {
+        std::shared_ptr< Measurement > measurement;
+        size_t sensor;
+        QString unit;
+    };
+    mutable std::vector< Row > _rows;
+    mutable bool _rows_valid = false;
+
+    // Values of every sensor of a measurement at a probe (NaN if there is no
+    // sample), filled for all probes of a measurement at once. Entries are
+    // dropped only for the probe or measurement which changed, other
+    // resolutions are kept for zooming back.
+    typedef std::tuple< const Probe*, const Measurement*, int_fast32_t >
+        ValueKey;
+    mutable std::map< ValueKey, std::vector< double > > _values;
+
+    // Values are looked up on a worker, never by the GUI thread. Keys being
+    // looked up map to the generation they were requested in, values of a
+    // dropped request are discarded.
+    mutable QThreadPool _pool;
+    mutable std::mutex _mutex;
+    mutable std::map< ValueKey, uint64_t > _pending;
+    mutable uint64_t _generation = 0;
+
+    void updateRows() const;
+    // Schedules the lookup of every probe without values for the measurement,
+    // done in one pass on the worker
+    void evaluate(const std::shared_ptr< Measurement >& measurement) const;
+    // Drops the values of the probe and/or measurement (nullptr for any)
+    void dropValues(const Probe* probe, const Measurement* measurement);
+    void emitColumnChanged(int column);
+
     public:
     ProbeTableModel(std::shared_ptr< Configuration > configuration,
         std::shared_ptr< Project > project, QObject* parent = 0);
-    virtual ~ProbeTableModel() = default;
+    virtual ~ProbeTableModel();
 
     public:
     virtual bool setData(const QModelIndex& index, const QVariant& value,
@@ -65,6 +102,8 @@ class ProbeTableModel : public QAbstractTableModel {
 
     signals:
     void goTo(double time);
+    // Emitted by the worker once values were looked up
+    void valuesLoaded() const;
     public slots:
     void projectChanged();
     void setResolution(int_fast32_t newResolution);
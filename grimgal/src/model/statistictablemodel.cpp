@@ -26,6 +26,7 @@
 #include <QMap>
 #include <QMetaType>
 #include <QModelIndex>
+#include <QRunnable>
 #include <QTextStream>
 #include <QVariant>
 
@@ -39,14 +40,35 @@
 
 // StdLib
 #include <algorithm>
+#include <cmath>
+#include <functional>
 #include <future>
 #include <iostream>
 #include <memory>
+#include <set>
 #include <string>
 #include <thread>
 #include <tuple>
 #include <vector>
 
+namespace {
+    class StatisticTask : public QRunnable {
+        private:
+        std::function< void() > _task;
+
+        public:
+        StatisticTask(std::function< void() > task)
+            : _task(task)
+        {
+        }
+
+        virtual void run() override
+        {
+            this->_task();
+        }
+    };
+}
+
 StatisticTableModel::StatisticTableModel(
     std::shared_ptr< Configuration > configuration,
     std::shared_ptr< Project > project, QObject* parent)
@@ -54,10 +76,47 @@ StatisticTableModel::StatisticTableModel(
 {
     this->_configuration = configuration;
     this->_project = project;
+
+    // A single worker, the readers are shared with the tile loader
+    this->_pool.setMaxThreadCount(1);
+    QObject::connect(this, &StatisticTableModel::statisticLoaded, this,
+        [this]() {
+            emit this->dataChanged(this->index(0, 1),
+                this->index(this->rowCount() - 1, this->columnCount() - 1));
+        },
+        Qt::QueuedConnection);
+
+    this->_refresh.setSingleShot(true);
+    this->_refresh.setInterval(500);
+    QObject::connect(&this->_refresh, &QTimer::timeout, this, [this]() {
+        // Live pyramids grow, their ranges have to be taken again
+        std::lock_guard< std::mutex > lock(this->_mutex);
+        for (auto it = this->_ranges.begin(); it != this->_ranges.end();) {
+            auto row = it->first;
+            if (row >= this->_rows.size() ||
+                (this->_rows[ row ].measurement->pyramid &&
+                    this->_rows[ row ].measurement->pyramid->live())) {
+                it = this->_ranges.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+        emit this->dataChanged(this->index(0, 1),
+            this->index(this->rowCount() - 1, this->columnCount() - 1));
+    });
+}
+
+StatisticTableModel::~StatisticTableModel()
+{
+    this->_pool.clear();
+    this->_pool.waitForDone();
 }
 
 void StatisticTableModel::projectChanged()
 {
+    this->_rows_valid = false;
+    this->dropRanges();
     emit this->dataChanged(QModelIndex(),
         this->index(this->rowCount() - 1, this->columnCount() - 1));
     emit this->layoutChanged();
@@ -86,12 +145,272 @@ void StatisticTableModel::updatedProject()
 
 void StatisticTableModel::addedProbe(std::shared_ptr< Probe > p, size_t index)
 {
+    this->rangeChanged();
 }
 void StatisticTableModel::updatedProbe(std::shared_ptr< Probe > p, size_t index)
 {
+    this->rangeChanged();
 }
 void StatisticTableModel::removedProbe(std::shared_ptr< Probe > p, size_t index)
 {
+    this->rangeChanged();
+}
+
+void StatisticTableModel::setWindow(double begin, double end)
+{
+    this->_window_begin = begin;
+    this->_window_end = end;
+    if (!this->rangeFromProbes()) {
+        this->rangeChanged();
+    }
+}
+
+bool StatisticTableModel::rangeFromProbes() const
+{
+    return this->_project->probes.size() >= 2;
+}
+
+std::pair< double, double > StatisticTableModel::range() const
+{
+    if (!this->rangeFromProbes()) {
+        return { this->_window_begin, this->_window_end };
+    }
+    auto time = std::minmax_element(this->_project->probes.begin(),
+        this->_project->probes.end(),
+        [](const std::shared_ptr< Probe >& a,
+            const std::shared_ptr< Probe >& b) { return a->time < b->time; });
+    return { (*time.first)->time, (*time.second)->time };
+}
+
+void StatisticTableModel::rangeChanged()
+{
+    // Only the range columns, the rows and whole file figures stay
+    this->dropRanges();
+    emit this->dataChanged(this->index(0, 6),
+        this->index(this->rowCount() - 1, this->columnCount() - 1));
+    emit this->headerDataChanged(Qt::Horizontal, 6, this->columnCount() - 1);
+}
+
+void StatisticTableModel::dropRanges() const
+{
+    std::lock_guard< std::mutex > lock(this->_mutex);
+    ++this->_generation;
+    this->_ranges.clear();
+    this->_pending.clear();
+}
+
+void StatisticTableModel::updateRows() const
+{
+    if (this->_rows_valid) {
+        return;
+    }
+    this->_rows.clear();
+    this->dropRanges();
+    std::set< const rlib::common::reader* > readers;
+    for (auto& measurement : this->_project->measurements) {
+        auto sensors = measurement->reader->sensors();
+        for (size_t i = 0; i < sensors.size(); ++i) {
+            this->_rows.push_back({ measurement, i,
+                QString::fromStdString(sensors[ i ].unit),
+                double(measurement->unitFactor.at(i)) });
+        }
+        readers.insert(measurement->reader.get());
+    }
+    // Forget the readers of removed measurements, their address may be
+    // taken by the next one
+    std::lock_guard< std::mutex > lock(this->_mutex);
+    for (auto it = this->_reader_statistics.begin();
+         it != this->_reader_statistics.end();) {
+        if (readers.count(it->first) == 0) {
+            it = this->_reader_statistics.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+    for (auto it = this->_pending_readers.begin();
+         it != this->_pending_readers.end();) {
+        if (readers.count(*it) == 0) {
+            it = this->_pending_readers.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+    this->_rows_valid = true;
+}
+
+QVariant StatisticTableModel::statistic(const Row& row, int column) const
+{
+    SensorStatistic statistic;
+
+    auto pyramid = row.measurement->pyramid;
+    auto statistics =
+        pyramid ? pyramid->statistics() : std::experimental::nullopt;
+    if (pyramid && pyramid->live() && !this->_refresh.isActive()) {
+        // Figures of everything received so far, look again in a moment
+        this->_refresh.start();
+    }
+    if (statistics) {
+        if (row.sensor >= statistics->size() ||
+            (*statistics)[ row.sensor ].count == 0) {
+            return QVariant("");
+        }
+        statistic = (*statistics)[ row.sensor ];
+    }
+    else if (pyramid && pyramid->building()) {
+        // Gathered by the pyramid build, look again in a moment
+        if (!this->_refresh.isActive()) {
+            this->_refresh.start();
+        }
+        return QVariant("...");
+    }
+    else {
+        // Readers without a fixed sampling interval are not indexed, they
+        // are asked on the worker as well
+        auto reader = row.measurement->reader;
+        std::lock_guard< std::mutex > lock(this->_mutex);
+        auto found = this->_reader_statistics.find(reader.get());
+        if (found == this->_reader_statistics.end()) {
+            if (this->_pending_readers.insert(reader.get()).second) {
+                auto source = row.measurement->source;
+                auto sensors = reader->sensors().size();
+                // reader is held until the figures arrive, so its address
+                // stays unique
+                this->_pool.start(
+                    new StatisticTask([this, reader, source, sensors]() {
+                        auto statistics = readerStatistics(source, sensors);
+                        std::lock_guard< std::mutex > lock(this->_mutex);
+                        if (this->_pending_readers.erase(reader.get()) == 0) {
+                            // Removed meanwhile
+                            return;
+                        }
+                        this->_reader_statistics[ reader.get() ] =
+                            std::move(statistics);
+                        emit this->statisticLoaded();
+                    }));
+            }
+            return QVariant("...");
+        }
+        if (row.sensor >= found->second.size()) {
+            return QVariant("");
+        }
+        statistic = found->second[ row.sensor ];
+    }
+
+    // Values as the trace draws them, scaled by the unit factor. offsetY
+    // only moves the trace on the plot and is left out.
+    auto factor = row.factor;
+    double value;
+    switch (column) {
+        case 1:
+            value = (factor < 0.0 ? statistic.max : statistic.min) * factor;
+            break;
+        case 2:
+            value = (factor < 0.0 ? statistic.min : statistic.max) * factor;
+            break;
+        case 3:
+            value = statistic.mean * factor;
+            break;
+        case 4:
+            value = statistic.median * factor;
+            break;
+        case 5:
+            value = statistic.variance * factor * factor;
+            break;
+        default:
+            return QVariant("");
+    }
+    if (std::isnan(value)) {
+        return QVariant("");
+    }
+    return QVariant(util::format_number(value, row.unit));
+}
+
+QVariant StatisticTableModel::rangeStatistic(size_t row, int column) const
+{
+    auto& measurement = this->_rows[ row ].measurement;
+    auto sensor = this->_rows[ row ].sensor;
+    auto pyramid = measurement->pyramid;
+    if (!pyramid) {
+        // Readers without a fixed sampling interval are not indexed
+        return QVariant("");
+    }
+    if (!pyramid->ready()) {
+        if (pyramid->building() && !this->_refresh.isActive()) {
+            this->_refresh.start();
+        }
+        return QVariant(pyramid->building() ? "..." : "");
+    }
+    if (pyramid->live() && !this->_refresh.isActive()) {
+        this->_refresh.start();
+    }
+
+    std::experimental::optional< SamplePyramid::RangeStatistic > figures;
+    {
+        std::lock_guard< std::mutex > lock(this->_mutex);
+        auto found = this->_ranges.find(row);
+        if (found == this->_ranges.end()) {
+            if (this->_pending.insert(row).second) {
+                // Range is given in plot time, samples are drawn shifted by
+                // offsetX
+                auto range = this->range();
+                auto offsetX = measurement->offsetX.at(sensor);
+                auto begin = range.first - offsetX;
+                auto end = range.second - offsetX;
+                auto generation = this->_generation;
+                this->_pool.start(new StatisticTask(
+                    [this, pyramid, sensor, begin, end, row, generation]() {
+                        {
+                            // Skip requests the range moved away from
+                            std::lock_guard< std::mutex > lock(this->_mutex);
+                            if (generation != this->_generation) {
+                                return;
+                            }
+                        }
+                        auto statistic = pyramid->range(sensor, begin, end);
+                        std::lock_guard< std::mutex > lock(this->_mutex);
+                        if (generation != this->_generation) {
+                            return;
+                        }
+                        this->_ranges[ row ] = statistic;
+                        this->_pending.erase(row);
+                        emit this->statisticLoaded();
+                    }));
+            }
+            return QVariant("...");
+        }
+        figures = found->second;
+    }
+    if (!figures || figures->count == 0) {
+        return QVariant("");
+    }
+
+    // Scaled by the unit factor like the whole file figures
+    auto& statistic = *figures;
+    auto& unit = this->_rows[ row ].unit;
+    auto factor = this->_rows[ row ].factor;
+    switch (column) {
+        case 6:
+            return QVariant(util::format_number(
+                (factor < 0.0 ? statistic.max : statistic.min) * factor,
+                unit));
+        case 7:
+            return QVariant(util::format_number(
+                (factor < 0.0 ? statistic.min : statistic.max) * factor,
+                unit));
+        case 8:
+            return QVariant(
+                util::format_number(statistic.mean * factor, unit));
+        case 9:
+            return QVariant(
+                util::format_number(statistic.rms * std::abs(factor), unit));
+        case 10:
+            return QVariant(
+                util::format_number(statistic.energy * factor, unit + "s"));
+        default:
+            return QVariant("");
+    }
 }
 
 QVariant StatisticTableModel::data(const QModelIndex& index, int role) const
@@ -101,53 +420,21 @@ QVariant StatisticTableModel::data(const QModelIndex& index, int role) const
     }
 
     if (role == Qt::DisplayRole) {
-        int row = 0;
-        for (auto& measurement : this->_project->measurements) {
-            if (row + measurement->sensorName.size() > index.row()) {
-                int datumIndex = index.row() - row;
-                if (index.column() == 0) {
-                    return QVariant(measurement->name + " - " +
-                                    measurement->sensorName[ datumIndex ]);
-                }
-
-                rlib::common::statistic_data statisticColumn;
-                switch (index.column()) {
-                    case 1:
-                        statisticColumn =
-                            rlib::common::statistic_data::MIN_VALUE;
-                        break;
-                    case 2:
-                        statisticColumn =
-                            rlib::common::statistic_data::MAX_VALUE;
-                        break;
-                    case 3:
-                        statisticColumn =
-                            rlib::common::statistic_data::AVG_VALUE;
-                        break;
-                    case 4:
-                        statisticColumn =
-                            rlib::common::statistic_data::MEDIAN_VALUE;
-                        break;
-                    case 5:
-                        statisticColumn =
-                            rlib::common::statistic_data::VAR_VALUE;
-                        break;
-                    default:
-                        return QVariant("");
-                }
-                auto statistics =
-                    measurement->reader->statistic(statisticColumn);
-                if (statistics.size() > datumIndex &&
-                    statistics[ datumIndex ]) {
-                    auto value = statistics[ datumIndex ].value();
-                    auto unit = QString::fromStdString(
-                        measurement->reader->sensors()[ datumIndex ].unit);
-                    return QVariant(util::format_number(value, unit));
-                }
-                return QVariant("");
-            }
-            row += measurement->reader->sensors().size();
+        this->updateRows();
+        if (index.row() < 0 ||
+            static_cast< size_t >(index.row()) >= this->_rows.size()) {
+            return QVariant();
+        }
+        auto& row = this->_rows[ static_cast< size_t >(index.row()) ];
+        if (index.column() == 0) {
+            return QVariant(row.measurement->name + " - " +
+                            row.measurement->sensorName[ row.sensor ]);
+        }
+        if (index.column() >= 6) {
+            return this->rangeStatistic(
+                static_cast< size_t >(index.row()), index.column());
         }
+        return this->statistic(row, index.column());
     }
 
     return QVariant();
@@ -185,6 +472,27 @@ QVariant StatisticTableModel::headerData(
             if (section == 5) {
                 QTextStream(&header) << QObject::tr("Var");
             }
+            if (section >= 6) {
+                QTextStream(&header)
+                    << (this->rangeFromProbes() ? QObject::tr("Probes")
+                                                : QObject::tr("View"))
+                    << " ";
+            }
+            if (section == 6) {
+                QTextStream(&header) << QObject::tr("Min");
+            }
+            if (section == 7) {
+                QTextStream(&header) << QObject::tr("Max");
+            }
+            if (section == 8) {
+                QTextStream(&header) << QObject::tr("AVG");
+            }
+            if (section == 9) {
+                QTextStream(&header) << QObject::tr("RMS");
+            }
+            if (section == 10) {
+                QTextStream(&header) << QObject::tr("Energy");
+            }
             return QVariant(header);
         }
     }
@@ -193,14 +501,11 @@ QVariant StatisticTableModel::headerData(
 
 int StatisticTableModel::rowCount(const QModelIndex& parent) const
 {
-    int row = 0;
-    for (auto& measurement : this->_project->measurements) {
-        row += measurement->reader->sensors().size();
-    }
-    return row;
+    this->updateRows();
+    return static_cast< int >(this->_rows.size());
 }
 
 int StatisticTableModel::columnCount(const QModelIndex& parent) const
 {
-    return 7;
+    return 11;
 }
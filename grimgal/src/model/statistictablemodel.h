@@ -27,17 +27,25 @@
 // Qt
 #include <QAbstractItemModel>
 #include <QMap>
+#include <QThreadPool>
+#include <QTimer>
 
 // Own
 #include "data/configuration.h"
 #include "data/measurement.h"
 #include "data/project.h"
+#include "data/sample_statistics.h"
 #include <rlib/common/event_data.h>
 
 // StdLib
+#include <cstdint>
 #include <experimental/optional>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 class StatisticTableModel : public QAbstractTableModel {
@@ -47,10 +55,60 @@ class StatisticTableModel : public QAbstractTableModel {
     std::shared_ptr< Project > _project;
     std::shared_ptr< Configuration > _configuration;
 
+    // Measurement and sensor of each row, rebuilt after a project change
+    struct Row {
+        std::shared_ptr< Measurement > measurement;
+        size_t sensor;
+        QString unit;
+        // unitFactor of the sensor, the figures are scaled by it
+        double factor;
+    };
+    mutable std::vector< Row > _rows;
+    mutable bool _rows_valid = false;
+
+
+    // Visible time window of the plot
+    double _window_begin = 0.0;
+    double _window_end = 0.0;
+
+    // Range figures are taken on a worker, never by the GUI thread. They
+    // are kept per row and dropped whenever the range moves.
+    mutable QThreadPool _pool;
+    mutable std::mutex _mutex;
+    mutable std::map< size_t,
+        std::experimental::optional< SamplePyramid::RangeStatistic > >
+        _ranges;
+    mutable std::set< size_t > _pending;
+    // Bumped whenever the range or the rows change, figures taken for an
+    // older generation are discarded
+    mutable uint64_t _generation = 0;
+
+    // Statistics of readers which are not indexed by a pyramid, asked once
+    // per reader on the same worker
+    mutable std::map< const rlib::common::reader*,
+        std::vector< SensorStatistic > >
+        _reader_statistics;
+    mutable std::set< const rlib::common::reader* > _pending_readers;
+
+    // Repaints while statistics are still being gathered
+    mutable QTimer _refresh;
+
+    void updateRows() const;
+    QVariant statistic(const Row& row, int column) const;
+    QVariant rangeStatistic(size_t row, int column) const;
+
+    // Range of the range columns: between the first and the last probe if
+    // there are at least two, otherwise the visible window
+    bool rangeFromProbes() const;
+    std::pair< double, double > range() const;
+    void rangeChanged();
+    // Forgets all range figures, requested ones are discarded
+    void dropRanges() const;
+
     public:
     StatisticTableModel(std::shared_ptr< Configuration > configuration,
         std::shared_ptr< Project > project, QObject* parent = 0);
-    virtual ~StatisticTableModel() = default;
+    virtual ~StatisticTableModel();
 
     virtual QVariant data(const QModelIndex& index, int role) const override;
     virtual Qt::ItemFlags flags(const QModelIndex& index) const override;
@@ -63,6 +121,7 @@ class StatisticTableModel : public QAbstractTableModel {
 
     public slots:
     void projectChanged();
+    void setWindow(double begin, double end);
 
     // Project / Measurment / Probes Slots
     void addedMeasurement(std::shared_ptr< Measurement > m, size_t index);
@@ -74,6 +133,10 @@ class StatisticTableModel : public QAbstractTableModel {
     void addedProbe(std::shared_ptr< Probe > p, size_t index);
     void updatedProbe(std::shared_ptr< Probe > p, size_t index);
     void removedProbe(std::shared_ptr< Probe > p, size_t index);
+
+    signals:
+    // Emitted by the worker once a figure is known
+    void statisticLoaded() const;
 };
 
 #endif // STATISTICTABLEMODEL_H
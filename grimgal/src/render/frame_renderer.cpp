@@ -0,0 +1,806 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Qt
+#include <QBrush>
+#include <QFont>
+#include <QFontMetrics>
+#include <QMatrix>
+#include <QStringList>
+
+// Own
+#include "render/frame_renderer.h"
+#include "util/decimation.h"
+#include "util/number_format.h"
+#include "util/transform.h"
+
+// StdLib
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+bool render::HoverHit::operator==(const HoverHit& other) const
+{
+    return this->measurement == other.measurement &&
+           this->sensor == other.sensor && this->time == other.time &&
+           this->value == other.value && this->point == other.point;
+}
+
+qreal render::View::timeToX(double time) const
+{
+    return (time / this->time_per_square) * this->square.x();
+}
+
+double render::View::xToTime(qreal x) const
+{
+    return double(x) / double(this->square.x()) * this->time_per_square;
+}
+
+qreal render::View::valueToY(double value) const
+{
+    return value * (this->square.y() * (qreal(1) / this->value_per_square));
+}
+
+qreal render::View::leftWindow() const
+{
+    return (-this->size.width() / (2.0 * this->zoom)) + this->center.x();
+}
+
+qreal render::View::rightWindow() const
+{
+    return this->size.width() / (2.0 * this->zoom) + this->center.x();
+}
+
+qreal render::View::upperWindow() const
+{
+    return this->size.height() / (2.0 * this->zoom) + this->center.y();
+}
+
+qreal render::View::lowerWindow() const
+{
+    return (-this->size.height() / (2.0 * this->zoom)) + this->center.y();
+}
+
+qreal render::View::leftBound() const
+{
+    return this->leftWindow() - this->square.x();
+}
+
+qreal render::View::rightBound() const
+{
+    return this->rightWindow() + this->square.x();
+}
+
+qreal render::View::upperBound() const
+{
+    return this->upperWindow() + this->square.y();
+}
+
+qreal render::View::lowerBound() const
+{
+    return this->lowerWindow() - this->square.y();
+}
+
+QRect render::View::windowRect() const
+{
+    return QRect((-this->size.width() / (2 * this->zoom)) +
+                     static_cast< int >(this->center.x()),
+        (-this->size.height() / (2 * this->zoom)) -
+            static_cast< int >(this->center.y()),
+        this->size.width() / this->zoom, this->size.height() / this->zoom);
+}
+
+qreal render::View::pixelOrigin() const
+{
+    return qreal(this->windowRect().left());
+}
+
+qreal render::View::pixelWidth() const
+{
+    return qreal(this->size.width() / this->zoom) / qreal(this->size.width());
+}
+
+qreal render::View::pixelHeight() const
+{
+    return qreal(this->size.height() / this->zoom) /
+           qreal(this->size.height());
+}
+
+qreal render::View::penWidth() const
+{
+    return qreal(1.0) / qreal(this->zoom);
+}
+
+int_fast32_t render::View::drawResolution() const
+{
+    return static_cast< int_fast32_t >(
+               std::ceil(this->square.x() / this->time_per_square)) *
+           2;
+}
+
+render::FrameRenderer::FrameRenderer(std::shared_ptr< TileLoader > tileLoader)
+    : _tile_loader(tileLoader)
+{
+}
+
+void render::FrameRenderer::setProject(std::shared_ptr< Project > project)
+{
+    this->_project = project;
+}
+
+void render::FrameRenderer::setConfiguration(
+    std::shared_ptr< Configuration > configuration)
+{
+    this->_configuration = configuration;
+}
+
+void render::FrameRenderer::setView(const View& view)
+{
+    this->_view = view;
+}
+
+const render::View& render::FrameRenderer::view() const
+{
+    return this->_view;
+}
+
+void render::FrameRenderer::setDrawSolidTraces(bool draw)
+{
+    this->_draw_solid_traces = draw;
+}
+
+bool render::FrameRenderer::drawSolidTraces() const
+{
+    return this->_draw_solid_traces;
+}
+
+void render::FrameRenderer::setFrameStats(std::shared_ptr< FrameStats > stats)
+{
+    this->_stats = stats;
+}
+
+void render::FrameRenderer::configure(QPainter& painter) const
+{
+    QMatrix matrix;
+    {
+        matrix.scale(1, -1);
+    }
+    painter.setMatrix(matrix);
+    painter.setWindow(this->_view.windowRect());
+}
+
+void render::FrameRenderer::drawLayer(QPainter& painter, const QRect& area)
+{
+    StageTimer layerTimer(this->_stats.get(), FRAME_STAGE::LAYER);
+    painter.save();
+    painter.setClipRect(area);
+
+    // Draw Background
+    painter.fillRect(
+        area, this->_configuration->color[ COLOR_CFG::BACKGROUND ]);
+    this->configure(painter);
+
+    // Draw Grid
+    {
+        StageTimer timer(this->_stats.get(), FRAME_STAGE::GRID);
+        this->drawGrid(painter);
+    }
+
+    // Draw Values and Events
+    Batch batch;
+    for (auto& m : this->_project->measurements) {
+        this->collectMeasurement(batch, m, area);
+    }
+    this->_missing_tiles = batch.placeholders.size();
+    this->submit(painter, batch);
+    painter.restore();
+}
+
+size_t render::FrameRenderer::missingTiles() const
+{
+    return this->_missing_tiles;
+}
+
+std::vector< render::HoverHit > render::FrameRenderer::drawOverlay(
+    QPainter& painter, std::experimental::optional< QPoint > mouse)
+{
+    std::vector< HoverHit > hover;
+    painter.save();
+    this->configure(painter);
+
+    // Draw Probes
+    {
+        StageTimer timer(this->_stats.get(), FRAME_STAGE::PROBES);
+        this->drawProbes(painter);
+    }
+
+    // Draw Grid Labels (X/Y)
+    {
+        StageTimer timer(this->_stats.get(), FRAME_STAGE::LABELS);
+        this->drawGridLables(painter);
+    }
+
+    // Draw Hover, the hit test is part of the stage
+    if (mouse) {
+        StageTimer timer(this->_stats.get(), FRAME_STAGE::HOVER);
+        hover = this->hover(*mouse);
+        for (auto& hit : hover) {
+            this->drawHover(painter, hit);
+        }
+    }
+    painter.restore();
+    return hover;
+}
+
+void render::FrameRenderer::drawEvents(QPainter& painter,
+    std::shared_ptr< Measurement > m,
+    const std::vector< rlib::common::event_data >& events) const
+{
+    Batch batch;
+    this->collectEvents(batch, m, events);
+    this->submit(painter, batch);
+}
+
+void render::FrameRenderer::drawEvents(QPainter& painter,
+    std::shared_ptr< Measurement > m, const QRect& area) const
+{
+    Batch batch;
+    this->collectEvents(batch, m, area);
+    this->submit(painter, batch);
+}
+
+void render::FrameRenderer::drawStats(QPainter& painter) const
+{
+    if (!this->_stats) {
+        return;
+    }
+
+    QStringList lines;
+    lines.push_back(QObject::tr("Frame timing [ms], last %1 frames%2")
+                        .arg(FrameStats::WINDOW)
+                        .arg(this->_stats->logging() ? QObject::tr(", logging")
+                                                     : QString()));
+    lines.push_back(QString("%1%2%3%4%5")
+                        .arg(QObject::tr("Stage"), -16)
+                        .arg("p50", 9)
+                        .arg("p90", 9)
+                        .arg("p99", 9)
+                        .arg("max", 9));
+    for (size_t i = 0; i < FrameStats::STAGES; ++i) {
+        auto stage = static_cast< FRAME_STAGE >(i);
+        auto summary = this->_stats->summary(stage);
+        if (summary.count == 0) {
+            continue;
+        }
+        lines.push_back(QString("%1%2%3%4%5")
+                            .arg(QString::fromStdString(to_string(stage)), -16)
+                            .arg(summary.p50, 9, 'f', 2)
+                            .arg(summary.p90, 9, 'f', 2)
+                            .arg(summary.p99, 9, 'f', 2)
+                            .arg(summary.max, 9, 'f', 2));
+    }
+
+    QFont font("Monospace", 8);
+    font.setStyleHint(QFont::TypeWriter);
+    QFontMetrics metrics(font);
+    int width = 0;
+    for (auto& line : lines) {
+        width = std::max(width, metrics.boundingRect(line).width());
+    }
+    int padding = 4;
+    QRect box(padding, padding, width + 2 * padding,
+        lines.size() * metrics.lineSpacing() + 2 * padding);
+
+    painter.save();
+    painter.fillRect(box, QColor(0, 0, 0, 160));
+    painter.setPen(
+        QPen(this->_configuration->color[ COLOR_CFG::DEFAULT_FONT_COLOR ]));
+    painter.setFont(font);
+    int y = box.top() + padding + metrics.ascent();
+    for (auto& line : lines) {
+        painter.drawText(box.left() + padding, y, line);
+        y += metrics.lineSpacing();
+    }
+    painter.restore();
+}
+
+std::vector< std::shared_ptr< const render::Tile > > render::FrameRenderer::
+    tiles(std::shared_ptr< Measurement > m, const QRect& area,
+        int64_t& firstTile) const
+{
+    auto& view = this->_view;
+    // Time range of area plus a margin of one square
+    auto origin = view.pixelOrigin();
+    auto pixelWidth = view.pixelWidth();
+    double leftBoundTime =
+        view.xToTime(origin + area.left() * pixelWidth - view.square.x());
+    double rightBoundTime = view.xToTime(
+        origin + (area.left() + area.width()) * pixelWidth + view.square.x());
+    auto offsetX = std::minmax_element(m->offsetX.begin(), m->offsetX.end());
+    double minOffsetX = *offsetX.first;
+    double maxOffsetX = *offsetX.second;
+
+    // Samples are drawn at (time + offsetX), so the visible range of the
+    // recording is shifted by the offsets
+    double begin = leftBoundTime - maxOffsetX;
+    double end = rightBoundTime - minOffsetX;
+    if (end < 0) {
+        firstTile = 0;
+        return {};
+    }
+    return this->visibleTiles(m, begin, end, firstTile);
+}
+
+std::vector< std::shared_ptr< const render::Tile > > render::FrameRenderer::
+    visibleTiles(std::shared_ptr< Measurement > m, double begin, double end,
+        int64_t& firstTile) const
+{
+    int_fast32_t resolution = this->_view.drawResolution();
+    auto duration = TileLoader::tileDuration(resolution);
+    firstTile = static_cast< int64_t >(std::floor(begin / duration));
+    auto lastTile = static_cast< int64_t >(std::floor(end / duration));
+
+    // Missing tiles are requested from the loader and stay nullptr until
+    // they arrive
+    std::vector< std::shared_ptr< const Tile > > tiles;
+    for (auto index = firstTile; index <= lastTile; ++index) {
+        tiles.push_back(this->_tile_loader->tile(m, index, resolution));
+    }
+    return tiles;
+}
+
+QPen render::FrameRenderer::sensorPen(
+    std::shared_ptr< Measurement > m, size_t i) const
+{
+    QPen pen(m->color.at(i), this->_view.penWidth());
+    if (m->line_types[ i ] == LINE_TYPE::DASHED) {
+        pen.setStyle(Qt::DashLine);
+    }
+    else if (m->line_types[ i ] == LINE_TYPE::SOLID) {
+        pen.setStyle(Qt::SolidLine);
+    }
+    return pen;
+}
+
+void render::FrameRenderer::collectMeasurement(
+    Batch& batch, std::shared_ptr< Measurement > m, const QRect& area) const
+{
+    bool anyVisible = false;
+    for (const auto visible : m->visible) {
+        anyVisible |= visible;
+    }
+    if (!anyVisible) {
+        return;
+    }
+
+    int64_t firstTile = 0;
+    std::vector< std::shared_ptr< const Tile > > tiles;
+    {
+        StageTimer timer(this->_stats.get(), FRAME_STAGE::TILE_LOOKUP);
+        tiles = this->tiles(m, area, firstTile);
+    }
+    {
+        StageTimer timer(this->_stats.get(), FRAME_STAGE::POLYLINE_BUILD);
+        this->collectTraces(batch, m, tiles, firstTile);
+    }
+    {
+        // The lines are submitted in submit(), collecting them is counted
+        // as drawing
+        StageTimer timer(this->_stats.get(), FRAME_STAGE::EVENT_DRAW);
+        this->collectEvents(batch, m, area);
+    }
+}
+
+void render::FrameRenderer::collectTraces(Batch& batch,
+    std::shared_ptr< Measurement > m,
+    const std::vector< std::shared_ptr< const Tile > >& tiles,
+    int64_t firstTile) const
+{
+    auto& view = this->_view;
+    auto origin = view.pixelOrigin();
+    auto pixelWidth = view.pixelWidth();
+
+    // Placeholder for tiles which are still loading
+    auto duration = TileLoader::tileDuration(view.drawResolution());
+    for (size_t t = 0; t < tiles.size(); ++t) {
+        if (tiles[ t ]) {
+            continue;
+        }
+        double tileBegin = double(firstTile + int64_t(t)) * duration;
+        QPointF p1(view.timeToX(tileBegin), view.lowerBound());
+        QPointF p2(view.timeToX(tileBegin + duration), view.upperBound());
+        batch.placeholders.push_back(QRectF(p1, p2));
+    }
+
+    auto sensorsSize = m->reader->sensors().size();
+    QVector< QPointF > polyline;
+    for (size_t i = 0; i < sensorsSize; ++i) {
+        if (!m->visible[ i ]) {
+            continue;
+        }
+        auto pen = this->sensorPen(m, i);
+        if (pen.style() == Qt::SolidLine && !this->_draw_solid_traces) {
+            continue;
+        }
+        auto& polylines = batch.polylines[ std::make_pair(
+            pen.color().rgba(), static_cast< int >(pen.style())) ];
+        util::ColumnTransform transform{ m->offsetX[ i ], view.timeToX(1.0),
+            double(m->unitFactor[ i ]), m->offsetY[ i ], view.valueToY(1.0) };
+
+        // Collects the polyline, missing tiles split the line
+        auto flushPolyline = [&]() {
+            // Reduce to first/min/max/last per pixel column, the result is
+            // pixel identical but the vertex count only depends on the
+            // widget width
+            QVector< QPointF > decimated;
+            util::m4_decimate(polyline, origin, pixelWidth, decimated);
+            if (!decimated.isEmpty()) {
+                polylines.push_back(std::move(decimated));
+            }
+            polyline.clear();
+        };
+
+        for (auto& tile : tiles) {
+            auto column = tile ? tile->column(i) : std::experimental::nullopt;
+            if (!column) {
+                flushPolyline();
+                continue;
+            }
+            // Whole columns at once, rows with missing values are dropped
+            auto& samples = tile->samples;
+            auto offset = polyline.size();
+            polyline.resize(offset + static_cast< int >(samples.size()));
+            auto count = util::transform_columns(transform, samples.time(),
+                samples.values(*column), samples.size(),
+                polyline.data() + offset);
+            polyline.resize(offset + static_cast< int >(count));
+        }
+        flushPolyline();
+    }
+}
+
+void render::FrameRenderer::collectEvents(Batch& batch,
+    std::shared_ptr< Measurement > m,
+    const std::vector< rlib::common::event_data >& events) const
+{
+    auto& view = this->_view;
+    auto upperBound = view.upperBound();
+    auto lowerBound = view.lowerBound();
+    QRgb globalColor = this->_configuration->color[ COLOR_CFG::EVENT ].rgba();
+
+    for (auto& e : events) {
+        auto eventTime = e.time;
+        QRgb color = globalColor;
+        if (e.origin >= 0) {
+            color = m->color.at(static_cast< size_t >(e.origin)).rgba();
+            eventTime += m->offsetX.at(static_cast< size_t >(e.origin));
+        }
+        auto xpos = view.timeToX(eventTime);
+        batch.events[ color ].push_back(
+            QLineF(xpos, upperBound, xpos, lowerBound));
+    }
+}
+
+void render::FrameRenderer::collectEvents(
+    Batch& batch, std::shared_ptr< Measurement > m, const QRect& area) const
+{
+    if (!m->events) {
+        return;
+    }
+
+    auto& view = this->_view;
+    auto upperBound = view.upperBound();
+    auto lowerBound = view.lowerBound();
+    QRgb globalColor = this->_configuration->color[ COLOR_CFG::EVENT ].rgba();
+
+    // One bin per device pixel column of area plus a margin of one square
+    auto pixelWidth = view.pixelWidth();
+    auto left =
+        view.pixelOrigin() + area.left() * pixelWidth - view.square.x();
+    auto columns = static_cast< size_t >(area.width()) +
+                   static_cast< size_t >(
+                       std::ceil(2.0 * view.square.x() / pixelWidth));
+    double binWidth = view.xToTime(pixelWidth);
+    double leftTime = view.xToTime(left);
+
+    for (auto origin : m->events->origins()) {
+        QRgb color = globalColor;
+        double offset = 0.0;
+        if (origin >= 0) {
+            auto sensor = static_cast< size_t >(origin);
+            if (sensor >= m->color.size() || sensor >= m->offsetX.size()) {
+                continue;
+            }
+            color = m->color[ sensor ].rgba();
+            offset = m->offsetX[ sensor ];
+        }
+        // Dense columns collapse into a single marker at their first event
+        auto bins =
+            m->events->histogram(origin, leftTime - offset, binWidth, columns);
+        auto& lines = batch.events[ color ];
+        for (auto& bin : bins) {
+            auto xpos = view.timeToX(bin.time + offset);
+            lines.push_back(QLineF(xpos, upperBound, xpos, lowerBound));
+        }
+    }
+}
+
+void render::FrameRenderer::submit(QPainter& painter, const Batch& batch) const
+{
+    auto penWidth = this->_view.penWidth();
+
+    // Draw Placeholder for tiles which are still loading
+    if (!batch.placeholders.empty()) {
+        QBrush placeholder(
+            this->_configuration->color[ COLOR_CFG::GRID ], Qt::BDiagPattern);
+        for (auto& rect : batch.placeholders) {
+            painter.fillRect(rect, placeholder);
+        }
+    }
+
+    // Draw Values, one pen change per color and style
+    {
+        StageTimer timer(this->_stats.get(), FRAME_STAGE::TRACE_DRAW);
+        for (auto& group : batch.polylines) {
+            QPen pen(QColor::fromRgba(group.first.first), penWidth);
+            pen.setStyle(static_cast< Qt::PenStyle >(group.first.second));
+            painter.setPen(pen);
+            for (auto& polyline : group.second) {
+                painter.drawPolyline(polyline.data(), polyline.size());
+            }
+        }
+    }
+
+    // Draw Events, one drawLines() per color
+    {
+        StageTimer timer(this->_stats.get(), FRAME_STAGE::EVENT_DRAW);
+        for (auto& group : batch.events) {
+            painter.setPen(QPen(QColor::fromRgba(group.first), penWidth));
+            painter.drawLines(group.second);
+        }
+    }
+}
+
+std::vector< render::HoverHit > render::FrameRenderer::hover(
+    QPoint mouse) const
+{
+    auto& view = this->_view;
+    auto mouseXPos = view.leftWindow() + mouse.x();
+    auto mouseYPos = view.upperWindow() - mouse.y();
+
+    std::vector< HoverHit > hits;
+    for (auto& m : this->_project->measurements) {
+        auto sensorsSize = m->reader->sensors().size();
+        for (size_t i = 0; i < sensorsSize; ++i) {
+            if (!m->visible.at(i)) {
+                continue;
+            }
+            // Only samples within 3 pixel of the cursor can be hit
+            double begin = view.xToTime(mouseXPos - 3) - m->offsetX.at(i);
+            double end = view.xToTime(mouseXPos + 3) - m->offsetX.at(i);
+            if (end < 0) {
+                continue;
+            }
+            int64_t firstTile = 0;
+            auto tiles = this->visibleTiles(m, begin, end, firstTile);
+
+            HoverHit hit;
+            qreal distance = 3;
+            bool found = false;
+            for (auto& tile : tiles) {
+                auto column =
+                    tile ? tile->column(i) : std::experimental::nullopt;
+                if (!column) {
+                    continue;
+                }
+                // Samples of a tile are sorted by time
+                auto& samples = tile->samples;
+                auto time = samples.time();
+                auto values = samples.values(*column);
+                for (auto r = samples.lowerBound(begin);
+                     r < samples.size() && time[ r ] <= end; ++r) {
+                    if (std::isnan(values[ r ])) {
+                        continue;
+                    }
+                    double xTime = time[ r ] + m->offsetX.at(i);
+                    double value = values[ r ] * double(m->unitFactor.at(i)) +
+                                   m->offsetY.at(i);
+                    QPointF point(view.timeToX(xTime), view.valueToY(value));
+                    if (fabs(point.y() - mouseYPos) >= 3) {
+                        continue;
+                    }
+                    // Closest in x wins
+                    auto dx = fabs(point.x() - mouseXPos);
+                    if (dx < distance) {
+                        distance = dx;
+                        hit = { m, i, xTime, value, point };
+                        found = true;
+                    }
+                }
+            }
+            if (found) {
+                hits.push_back(hit);
+            }
+        }
+    }
+    return hits;
+}
+
+void render::FrameRenderer::drawHover(
+    QPainter& painter, const HoverHit& hit) const
+{
+    auto sensors = hit.measurement->reader->sensors();
+
+    painter.setPen(this->sensorPen(hit.measurement, hit.sensor));
+    painter.setBrush(Qt::NoBrush);
+    painter.drawEllipse(hit.point, qreal(5), qreal(5));
+
+    painter.setFont(QFont("Arial", 9, QFont::Bold));
+    painter.setWorldMatrixEnabled(false);
+    auto point = hit.point;
+    {
+        point.rx() += 10;
+        point.ry() = -point.y() - 10;
+    }
+    painter.drawText(point,
+        "Time:" + util::format_time(hit.time) + " Value:" +
+            util::format_number(hit.value,
+                QString::fromStdString(sensors[ hit.sensor ].unit)));
+    painter.setWorldMatrixEnabled(true);
+}
+
+void render::FrameRenderer::drawProbes(QPainter& painter) const
+{
+    auto& view = this->_view;
+    auto penWidth = view.penWidth();
+    qreal upperBound = view.upperBound();
+    qreal lowerBound = view.lowerBound();
+
+    QVector< QLineF > lines;
+    QVector< std::tuple< QPointF, QString > > labels;
+    int i = 0;
+    for (auto& probe : this->_project->probes) {
+        auto xpos = view.timeToX(probe->time);
+        lines.push_back(QLineF(xpos, upperBound, xpos, lowerBound));
+        // Note! Y-Axis is inverted manualy here to prevent text flip!
+        QPointF point(
+            xpos + 5, -view.upperWindow() + double(1.8) * view.square.y());
+        labels.push_back(
+            { point, QObject::tr("Probe ") + QString::number(i++) });
+    }
+    if (lines.isEmpty()) {
+        return;
+    }
+
+    // Draw Lines
+    painter.setPen(
+        QPen(this->_configuration->color[ COLOR_CFG::PROBE ], penWidth));
+    painter.drawLines(lines);
+
+    // Draw Labels
+    painter.setPen(
+        QPen(this->_configuration->color[ COLOR_CFG::DEFAULT_FONT_COLOR ],
+            penWidth));
+    painter.setFont(QFont("Arial", 9, QFont::Bold));
+    painter.setWorldMatrixEnabled(false);
+    for (auto& label : labels) {
+        painter.drawText(
+            std::get< QPointF >(label), std::get< QString >(label));
+    }
+    painter.setWorldMatrixEnabled(true);
+}
+
+void render::FrameRenderer::drawGrid(QPainter& painter) const
+{
+    auto& view = this->_view;
+    auto& square = view.square;
+    auto penWidth = view.penWidth();
+
+    // Build Grid
+    QPen gridPen(this->_configuration->color[ COLOR_CFG::GRID ], penWidth);
+    QVector< QLineF > lines;
+    qreal leftBound = view.leftBound();
+    qreal rightBound = view.rightBound();
+    qreal upperBound = view.upperBound();
+    qreal lowerBound = view.lowerBound();
+
+    for (int i = static_cast< int >(std::ceil(upperBound / square.y())) + 1;
+         i * square.y() > lowerBound; --i) {
+        QLineF line(leftBound, i * square.y(), rightBound, i * square.y());
+        lines.push_back(line);
+    }
+
+    for (int i = static_cast< int >(std::ceil(rightBound / square.x())) + 1;
+         i * square.y() > leftBound; --i) {
+        QLineF line(i * square.x(), upperBound, i * square.x(), lowerBound);
+        lines.push_back(line);
+    }
+
+    // Draw Grid
+    painter.setPen(gridPen);
+    painter.drawLines(lines);
+
+    // Draw Middleline (if visible)
+    if (lowerBound < 0.0 && upperBound > 0.0) {
+        QPen middleLinePen(
+            this->_configuration->color[ COLOR_CFG::ZERO_LINE ], penWidth);
+        painter.setPen(middleLinePen);
+        painter.drawLine(QPointF(leftBound, 0.0), QPointF(rightBound, 0.0));
+    }
+}
+
+void render::FrameRenderer::drawGridLables(QPainter& painter) const
+{
+    auto& view = this->_view;
+    auto& square = view.square;
+    qreal leftBound = view.leftBound();
+    qreal rightBound = view.rightBound();
+    qreal upperBound = view.upperBound();
+    qreal lowerBound = view.lowerBound();
+
+    {
+        painter.setPen(
+            { this->_configuration->color[ COLOR_CFG::DEFAULT_FONT_COLOR ],
+                view.penWidth() });
+        painter.setFont(this->_configuration->font[ FONT_CFG::DEFAULT_FONT ]);
+    }
+
+    QVector< std::tuple< QPointF, QString > > labels;
+
+    // Collect Labels (Y)
+    for (int i = static_cast< int >(std::ceil(upperBound / square.y())) + 1;
+         i * square.y() > lowerBound; --i) {
+        // Note! Y-Axis is inverted manualy here to prevent text flip!
+        auto point =
+            QPointF(leftBound + double(1.1) * square.x(), -i * square.y());
+        QString string;
+        if (i % 2 != 0) {
+            string = util::format_number(static_cast< double >(i) *
+                                         static_cast< double >(
+                                             view.value_per_square));
+        }
+        labels.push_back({ point, string });
+    }
+    // Collect Labels (X)
+    for (int i = static_cast< int >(std::ceil(rightBound / square.x())) + 1;
+         i * square.y() > leftBound; --i) {
+        // Note! Y-Axis is inverted manualy here to prevent text flip!
+        auto point =
+            QPointF(i * square.x(), -lowerBound - double(1.1) * square.y());
+        double time = (i * square.x() * view.time_per_square) / square.y();
+        QString string;
+        if (i % 4 == 0) {
+            string = util::format_time(time);
+        }
+        labels.push_back({ point, string });
+    }
+
+    // Draw Labels
+    painter.setWorldMatrixEnabled(false);
+    for (auto& label : labels) {
+        auto point = std::get< QPointF >(label);
+        auto string = std::get< QString >(label);
+        painter.drawText(point, string);
+    }
+    painter.setWorldMatrixEnabled(true);
+}
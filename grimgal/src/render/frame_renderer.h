@@ -0,0 +1,209 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#ifndef RENDER_FRAMERENDERER_H
+#define RENDER_FRAMERENDERER_H
+
+// Qt
+#include <QColor>
+#include <QLineF>
+#include <QPainter>
+#include <QPen>
+#include <QPoint>
+#include <QPointF>
+#include <QRect>
+#include <QRectF>
+#include <QSize>
+#include <QString>
+#include <QVector>
+
+// Own
+#include "data/configuration.h"
+#include "data/measurement.h"
+#include "data/probe.h"
+#include "data/project.h"
+#include "render/frame_stats.h"
+#include "render/tile_loader.h"
+#include <rlib/common/event_data.h>
+
+// StdLib
+#include <cstdint>
+#include <experimental/optional>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace render {
+    // Position and scale of the plot, all coordinates are painter
+    // coordinates (y axis pointing up) unless stated otherwise
+    struct View {
+        QSize size;
+        QPointF center = QPointF(0.0, 0.0);
+        QPointF square = QPointF(64.0, 64.0);
+        qreal time_per_square = 0.5;
+        int zoom = 1;
+        qreal value_per_square = 1.0;
+
+        qreal timeToX(double time) const;
+        double xToTime(qreal x) const;
+        qreal valueToY(double value) const;
+
+        qreal leftWindow() const;
+        qreal rightWindow() const;
+        qreal upperWindow() const;
+        qreal lowerWindow() const;
+
+        // Window plus a margin of one square
+        qreal leftBound() const;
+        qreal rightBound() const;
+        qreal upperBound() const;
+        qreal lowerBound() const;
+
+        // Window as passed to QPainter::setWindow() (y axis pointing down)
+        QRect windowRect() const;
+
+        // Left edge and size of a device pixel in painter coordinates
+        qreal pixelOrigin() const;
+        qreal pixelWidth() const;
+        qreal pixelHeight() const;
+
+        qreal penWidth() const;
+        int_fast32_t drawResolution() const;
+    };
+
+    // Sample of a sensor under the mouse
+    struct HoverHit {
+        std::shared_ptr< Measurement > measurement;
+        size_t sensor;
+        // Including the unit factor and offsets of the sensor
+        double time;
+        double value;
+        QPointF point;
+
+        bool operator==(const HoverHit& other) const;
+    };
+
+    // Draws a frame of the plot with a single painter. Primitives are
+    // collected over all measurements first and submitted grouped by pen,
+    // i.e. one drawLines() per event color instead of one drawLine() (and
+    // pen change) per event.
+    class FrameRenderer {
+        private:
+        std::shared_ptr< Project > _project;
+        std::shared_ptr< Configuration > _configuration;
+        std::shared_ptr< TileLoader > _tile_loader;
+        View _view;
+        bool _draw_solid_traces = true;
+        std::shared_ptr< FrameStats > _stats;
+        // Placeholders drawn by the last drawLayer()
+        size_t _missing_tiles = 0;
+
+        // Primitives of one frame, grouped by pen
+        struct Batch {
+            std::vector< QRectF > placeholders;
+            // Keyed by color and pen style, a trace split by missing tiles
+            // contributes several polylines
+            std::map< std::pair< QRgb, int >,
+                std::vector< QVector< QPointF > > >
+                polylines;
+            std::map< QRgb, QVector< QLineF > > events;
+        };
+
+        std::vector< std::shared_ptr< const Tile > > visibleTiles(
+            std::shared_ptr< Measurement > m, double begin, double end,
+            int64_t& firstTile) const;
+        QPen sensorPen(std::shared_ptr< Measurement > m, size_t i) const;
+
+        void collectMeasurement(Batch& batch, std::shared_ptr< Measurement > m,
+            const QRect& area) const;
+        void collectTraces(Batch& batch, std::shared_ptr< Measurement > m,
+            const std::vector< std::shared_ptr< const Tile > >& tiles,
+            int64_t firstTile) const;
+        void collectEvents(Batch& batch, std::shared_ptr< Measurement > m,
+            const std::vector< rlib::common::event_data >& events) const;
+        // One marker per pixel column holding events of an origin, from the
+        // event index of m
+        void collectEvents(Batch& batch, std::shared_ptr< Measurement > m,
+            const QRect& area) const;
+        void submit(QPainter& painter, const Batch& batch) const;
+
+        void drawGrid(QPainter& painter) const;
+        void drawGridLables(QPainter& painter) const;
+        void drawProbes(QPainter& painter) const;
+        void drawHover(QPainter& painter, const HoverHit& hit) const;
+
+        public:
+        FrameRenderer(std::shared_ptr< TileLoader > tileLoader);
+
+        void setProject(std::shared_ptr< Project > project);
+        void setConfiguration(std::shared_ptr< Configuration > configuration);
+        void setView(const View& view);
+        const View& view() const;
+
+        // Solid traces may be drawn by another renderer (see GlTraceRenderer)
+        void setDrawSolidTraces(bool draw);
+        bool drawSolidTraces() const;
+
+        // Stage times are added to stats (if set)
+        void setFrameStats(std::shared_ptr< FrameStats > stats);
+
+        // Flips the y axis and maps the view onto the painter
+        void configure(QPainter& painter) const;
+
+        // Draws background, grid, values and events within area (in widget
+        // pixels) with an unconfigured painter
+        void drawLayer(QPainter& painter, const QRect& area);
+        // Tiles which were still loading during the last drawLayer(), an
+        // offscreen render is complete once this is 0
+        size_t missingTiles() const;
+        // Samples within 3 pixel of mouse (in widget pixels), at most one per
+        // visible sensor. Only looks at resident tiles.
+        std::vector< HoverHit > hover(QPoint mouse) const;
+
+        // Draws probes, grid labels and the hover hits of mouse (see
+        // hover()) with an unconfigured painter, returns the hits
+        std::vector< HoverHit > drawOverlay(QPainter& painter,
+            std::experimental::optional< QPoint > mouse);
+
+        // Draws the rolling stage times of the stats as a table in the upper
+        // left corner with an unconfigured painter
+        void drawStats(QPainter& painter) const;
+
+        // Tiles of m covering area (in widget pixels) plus a margin of one
+        // square, missing tiles are requested and returned as nullptr
+        std::vector< std::shared_ptr< const Tile > > tiles(
+            std::shared_ptr< Measurement > m, const QRect& area,
+            int64_t& firstTile) const;
+
+        // Draws the given events of m with a configured painter
+        void drawEvents(QPainter& painter, std::shared_ptr< Measurement > m,
+            const std::vector< rlib::common::event_data >& events) const;
+        // Draws the indexed events of m within area (in widget pixels) with
+        // a configured painter
+        void drawEvents(QPainter& painter, std::shared_ptr< Measurement > m,
+            const QRect& area) const;
+    };
+}
+
+#endif // RENDER_FRAMERENDERER_H
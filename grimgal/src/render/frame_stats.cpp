@@ -0,0 +1,200 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Own
+#include "render/frame_stats.h"
+
+// StdLib
+#include <algorithm>
+#include <cmath>
+
+constexpr size_t render::FrameStats::STAGES;
+constexpr size_t render::FrameStats::WINDOW;
+
+render::FrameStats::FrameStats()
+    : _start(std::chrono::steady_clock::now())
+{
+    this->_current.fill(0.0);
+    this->_touched.fill(false);
+    this->_next.fill(0);
+}
+
+void render::FrameStats::add(FRAME_STAGE stage, double milliseconds)
+{
+    auto index = static_cast< size_t >(stage);
+    std::lock_guard< std::mutex > lock(this->_mutex);
+    if (is_per_load(stage)) {
+        // Finishes whenever, crediting it to the open frame would say
+        // nothing about either
+        this->push(index, milliseconds);
+        if (this->_load_log.is_open()) {
+            this->_load_log << this->elapsed() << "," << to_key(stage) << ","
+                            << milliseconds << "\n";
+        }
+        return;
+    }
+    this->_current[ index ] += milliseconds;
+    this->_touched[ index ] = true;
+}
+
+void render::FrameStats::push(size_t stage, double milliseconds)
+{
+    auto& window = this->_window[ stage ];
+    if (window.size() < WINDOW) {
+        window.push_back(milliseconds);
+    }
+    else {
+        window[ this->_next[ stage ] ] = milliseconds;
+    }
+    this->_next[ stage ] = (this->_next[ stage ] + 1) % WINDOW;
+}
+
+double render::FrameStats::elapsed() const
+{
+    return std::chrono::duration< double, std::milli >(
+        std::chrono::steady_clock::now() - this->_start)
+        .count();
+}
+
+void render::FrameStats::endFrame()
+{
+    std::lock_guard< std::mutex > lock(this->_mutex);
+    for (size_t i = 0; i < STAGES; ++i) {
+        if (this->_touched[ i ]) {
+            this->push(i, this->_current[ i ]);
+        }
+    }
+
+    if (this->_log.is_open()) {
+        this->_log << this->_frames << "," << this->elapsed();
+        for (size_t i = 0; i < STAGES; ++i) {
+            if (is_per_load(static_cast< FRAME_STAGE >(i))) {
+                continue;
+            }
+            this->_log << ",";
+            if (this->_touched[ i ]) {
+                this->_log << this->_current[ i ];
+            }
+        }
+        this->_log << "\n";
+    }
+
+    ++this->_frames;
+    this->_current.fill(0.0);
+    this->_touched.fill(false);
+}
+
+render::FrameStats::Summary render::FrameStats::summary(
+    FRAME_STAGE stage) const
+{
+    std::vector< double > values;
+    {
+        std::lock_guard< std::mutex > lock(this->_mutex);
+        values = this->_window[ static_cast< size_t >(stage) ];
+    }
+    Summary summary;
+    if (values.empty()) {
+        return summary;
+    }
+    std::sort(values.begin(), values.end());
+
+    // Nearest rank
+    auto percentile = [&values](double p) {
+        auto rank = static_cast< size_t >(
+            std::ceil(p * static_cast< double >(values.size())));
+        return values[ std::max(rank, size_t(1)) - 1 ];
+    };
+    summary.count = values.size();
+    summary.p50 = percentile(0.50);
+    summary.p90 = percentile(0.90);
+    summary.p99 = percentile(0.99);
+    summary.max = values.back();
+    return summary;
+}
+
+bool render::FrameStats::setLogFile(QString filename)
+{
+    std::lock_guard< std::mutex > lock(this->_mutex);
+    if (this->_log.is_open()) {
+        this->_log.close();
+    }
+    if (this->_load_log.is_open()) {
+        this->_load_log.close();
+    }
+    if (filename.isEmpty()) {
+        return true;
+    }
+
+    this->_log.open(filename.toStdString(), std::ios::out | std::ios::trunc);
+    this->_load_log.open(loadLogFile(filename).toStdString(),
+        std::ios::out | std::ios::trunc);
+    if (!this->_log.is_open() || !this->_load_log.is_open()) {
+        this->_log.close();
+        this->_load_log.close();
+        return false;
+    }
+    this->_load_log << "time,stage,ms\n";
+    // Header, all times in milliseconds, empty if the stage did not run.
+    // The column names do not depend on the language.
+    this->_log << "index,time";
+    for (size_t i = 0; i < STAGES; ++i) {
+        auto stage = static_cast< FRAME_STAGE >(i);
+        if (!is_per_load(stage)) {
+            this->_log << "," << to_key(stage);
+        }
+    }
+    this->_log << "\n";
+    return true;
+}
+
+QString render::FrameStats::loadLogFile(QString filename)
+{
+    // frames.csv -> frames_loads.csv
+    if (filename.endsWith(".csv", Qt::CaseInsensitive)) {
+        filename.chop(4);
+    }
+    return filename + "_loads.csv";
+}
+
+bool render::FrameStats::logging() const
+{
+    std::lock_guard< std::mutex > lock(this->_mutex);
+    return this->_log.is_open();
+}
+
+render::StageTimer::StageTimer(FrameStats* stats, FRAME_STAGE stage)
+    : _stats(stats)
+    , _stage(stage)
+    , _begin(std::chrono::steady_clock::now())
+{
+}
+
+render::StageTimer::~StageTimer()
+{
+    if (this->_stats) {
+        this->_stats->add(this->_stage,
+            std::chrono::duration< double, std::milli >(
+                std::chrono::steady_clock::now() - this->_begin)
+                .count());
+    }
+}
@@ -0,0 +1,206 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#ifndef RENDER_FRAMESTATS_H
+#define RENDER_FRAMESTATS_H
+
+// Qt
+#include <QObject>
+#include <QString>
+
+// StdLib
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace render {
+    enum class FRAME_STAGE : int {
+        FRAME,
+        LAYER,
+        GRID,
+        TILE_LOOKUP,
+        POLYLINE_BUILD,
+        TRACE_DRAW,
+        EVENT_DRAW,
+        GL_TRACES,
+        PROBES,
+        LABELS,
+        HOVER,
+        // Background thread (TileLoader), measured per tile load instead of
+        // per frame
+        SAMPLE_FETCH,
+
+        __FRAME_STAGE_COUNT
+    };
+
+    // True for the stages which run outside of the frames, each run is a
+    // measurement of its own
+    inline bool is_per_load(FRAME_STAGE s)
+    {
+        return s == FRAME_STAGE::SAMPLE_FETCH;
+    }
+
+    // Fixed ASCII name of s, e.g. for the columns of the log file
+    inline std::string to_key(FRAME_STAGE s)
+    {
+        switch (s) {
+            case FRAME_STAGE::FRAME:
+                return "frame";
+            case FRAME_STAGE::LAYER:
+                return "layer";
+            case FRAME_STAGE::GRID:
+                return "grid";
+            case FRAME_STAGE::TILE_LOOKUP:
+                return "tile_lookup";
+            case FRAME_STAGE::POLYLINE_BUILD:
+                return "polyline_build";
+            case FRAME_STAGE::TRACE_DRAW:
+                return "trace_draw";
+            case FRAME_STAGE::EVENT_DRAW:
+                return "event_draw";
+            case FRAME_STAGE::GL_TRACES:
+                return "gl_traces";
+            case FRAME_STAGE::PROBES:
+                return "probes";
+            case FRAME_STAGE::LABELS:
+                return "labels";
+            case FRAME_STAGE::HOVER:
+                return "hover";
+            case FRAME_STAGE::SAMPLE_FETCH:
+                return "sample_fetch";
+            case FRAME_STAGE::__FRAME_STAGE_COUNT:
+                break;
+        }
+        return "";
+    }
+
+    // Translated name of s, for display
+    inline std::string to_string(FRAME_STAGE s)
+    {
+        switch (s) {
+            case FRAME_STAGE::FRAME:
+                return QObject::tr("Frame").toStdString();
+            case FRAME_STAGE::LAYER:
+                return QObject::tr("Layer").toStdString();
+            case FRAME_STAGE::GRID:
+                return QObject::tr("Grid").toStdString();
+            case FRAME_STAGE::TILE_LOOKUP:
+                return QObject::tr("Tile lookup").toStdString();
+            case FRAME_STAGE::POLYLINE_BUILD:
+                return QObject::tr("Polyline build").toStdString();
+            case FRAME_STAGE::TRACE_DRAW:
+                return QObject::tr("Trace draw").toStdString();
+            case FRAME_STAGE::EVENT_DRAW:
+                return QObject::tr("Event draw").toStdString();
+            case FRAME_STAGE::GL_TRACES:
+                return QObject::tr("GL traces").toStdString();
+            case FRAME_STAGE::PROBES:
+                return QObject::tr("Probes").toStdString();
+            case FRAME_STAGE::LABELS:
+                return QObject::tr("Labels").toStdString();
+            case FRAME_STAGE::HOVER:
+                return QObject::tr("Hover").toStdString();
+            case FRAME_STAGE::SAMPLE_FETCH:
+                return QObject::tr("Fetch per tile").toStdString();
+            case FRAME_STAGE::__FRAME_STAGE_COUNT:
+                break;
+        }
+        return "";
+    }
+
+    // Time spent per stage and frame. Keeps the last WINDOW measurements of
+    // each stage for rolling percentiles and optionally appends every frame
+    // as a CSV line to a log file. Stages which did not run in a frame (e.g.
+    // the layer while it is reused) are not counted for that frame. Per load
+    // stages (see is_per_load()) are not tied to a frame, every load is a
+    // measurement and a line of a second log file.
+    class FrameStats {
+        public:
+        static constexpr size_t STAGES =
+            static_cast< size_t >(FRAME_STAGE::__FRAME_STAGE_COUNT);
+        static constexpr size_t WINDOW = 256;
+
+        struct Summary {
+            size_t count = 0;
+            double p50 = 0.0;
+            double p90 = 0.0;
+            double p99 = 0.0;
+            double max = 0.0;
+        };
+
+        private:
+        mutable std::mutex _mutex;
+
+        // Current frame
+        std::array< double, STAGES > _current;
+        std::array< bool, STAGES > _touched;
+
+        // Ring buffers of the last WINDOW frames a stage ran in
+        std::array< std::vector< double >, STAGES > _window;
+        std::array< size_t, STAGES > _next;
+
+        uint64_t _frames = 0;
+        std::chrono::steady_clock::time_point _start;
+        std::ofstream _log;
+        std::ofstream _load_log;
+
+        // Adds a measurement to the window of a stage
+        void push(size_t stage, double milliseconds);
+        double elapsed() const;
+
+        public:
+        FrameStats();
+
+        // Adds to the time of stage in the current frame, a per load stage
+        // is recorded at once instead. Thread safe.
+        void add(FRAME_STAGE stage, double milliseconds);
+        // Closes the current frame
+        void endFrame();
+
+        Summary summary(FRAME_STAGE stage) const;
+
+        // Starts logging the frames to filename and the loads to
+        // loadLogFile(filename), an empty filename stops logging
+        bool setLogFile(QString filename);
+        static QString loadLogFile(QString filename);
+        bool logging() const;
+    };
+
+    // Adds the lifetime of the timer to stage, does nothing without stats
+    class StageTimer {
+        private:
+        FrameStats* _stats;
+        FRAME_STAGE _stage;
+        std::chrono::steady_clock::time_point _begin;
+
+        public:
+        StageTimer(FrameStats* stats, FRAME_STAGE stage);
+        ~StageTimer();
+    };
+}
+
+#endif // RENDER_FRAMESTATS_H
@@ -0,0 +1,306 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Qt
+#include <QColor>
+#include <QPointF>
+#include <QRect>
+#include <QVector2D>
+#include <QVector>
+
+// Own
+#include "render/gl_trace_renderer.h"
+#include "render/tile_loader.h"
+#include "util/decimation.h"
+
+// StdLib
+#include <cmath>
+
+namespace {
+    // Plain GLSL 1.10 / ES 2.0, Qt defines the precision qualifiers away on
+    // desktop OpenGL
+    const char* const VERTEX_SHADER =
+        "attribute highp vec2 a_sample;\n"
+        "uniform highp vec2 u_scale;\n"
+        "uniform highp vec2 u_offset;\n"
+        "uniform highp vec2 u_window;\n"
+        "void main()\n"
+        "{\n"
+        "    highp vec2 p = a_sample * u_scale + u_offset;\n"
+        "    gl_Position = vec4(p / u_window * 2.0 - 1.0, 0.0, 1.0);\n"
+        "}\n";
+
+    const char* const FRAGMENT_SHADER =
+        "uniform lowp vec4 u_color;\n"
+        "void main()\n"
+        "{\n"
+        "    gl_FragColor = u_color;\n"
+        "}\n";
+}
+
+render::GlTraceRenderer::~GlTraceRenderer()
+{
+    this->release();
+}
+
+bool render::GlTraceRenderer::initialize()
+{
+    this->initializeOpenGLFunctions();
+    this->_valid =
+        this->_program.addShaderFromSourceCode(
+            QOpenGLShader::Vertex, VERTEX_SHADER) &&
+        this->_program.addShaderFromSourceCode(
+            QOpenGLShader::Fragment, FRAGMENT_SHADER) &&
+        this->_program.link();
+    if (this->_valid) {
+        this->_sample_location = this->_program.attributeLocation("a_sample");
+        this->_scale_location = this->_program.uniformLocation("u_scale");
+        this->_offset_location = this->_program.uniformLocation("u_offset");
+        this->_window_location = this->_program.uniformLocation("u_window");
+        this->_color_location = this->_program.uniformLocation("u_color");
+    }
+    return this->_valid;
+}
+
+bool render::GlTraceRenderer::isValid() const
+{
+    return this->_valid;
+}
+
+void render::GlTraceRenderer::release()
+{
+    for (auto& entry : this->_buffers) {
+        entry.second->vbo.destroy();
+    }
+    this->_buffers.clear();
+}
+
+render::GlTraceRenderer::Buffer& render::GlTraceRenderer::buffer(
+    const TileKey& key, std::shared_ptr< const Tile > tile, double tileBegin,
+    size_t sensors)
+{
+    auto it = this->_buffers.find(key);
+    if (it != this->_buffers.end()) {
+        if (it->second->tile.lock() == tile) {
+            return *it->second;
+        }
+        // Tile was reloaded (e.g. the reader changed)
+        it->second->vbo.destroy();
+        this->_buffers.erase(it);
+    }
+
+    auto buffer = std::make_unique< Buffer >();
+    buffer->tile = tile;
+    // Same reduction as the FrameRenderer, but in columns of one sample of
+    // the tile resolution instead of one pixel, so the buffer stays valid
+    // while panning and zooming
+    auto columnWidth = 1.0 / double(key.resolution);
+    std::vector< GLfloat > vertices;
+    QVector< QPointF > polyline;
+    QVector< QPointF > decimated;
+    for (size_t i = 0; i < sensors; ++i) {
+        auto first = static_cast< GLint >(vertices.size() / 2);
+        auto column = tile->column(i);
+        if (column) {
+            auto& samples = tile->samples;
+            auto time = samples.time();
+            auto values = samples.values(*column);
+            polyline.clear();
+            for (size_t r = 0; r < samples.size(); ++r) {
+                if (std::isnan(values[ r ])) {
+                    continue;
+                }
+                polyline.push_back(QPointF(time[ r ] - tileBegin, values[ r ]));
+            }
+            util::m4_decimate(polyline, 0.0, columnWidth, decimated);
+            for (auto& point : decimated) {
+                vertices.push_back(static_cast< GLfloat >(point.x()));
+                vertices.push_back(static_cast< GLfloat >(point.y()));
+            }
+        }
+        buffer->first.push_back(first);
+        buffer->count.push_back(
+            static_cast< GLsizei >(vertices.size() / 2) - first);
+        buffer->joined.push_back(false);
+        // Reserved for join()
+        vertices.push_back(0.0f);
+        vertices.push_back(0.0f);
+    }
+
+    buffer->vbo = QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
+    buffer->vbo.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    buffer->vbo.create();
+    buffer->vbo.bind();
+    buffer->vbo.allocate(vertices.data(),
+        static_cast< int >(vertices.size() * sizeof(GLfloat)));
+    buffer->vbo.release();
+
+    auto& result = *buffer;
+    this->_buffers[ key ] = std::move(buffer);
+    return result;
+}
+
+void render::GlTraceRenderer::join(
+    Buffer& buffer, std::shared_ptr< const Tile > next, double tileBegin)
+{
+    // Without a resident successor the previous join (if any) stays, it was
+    // read from the same recording
+    if (!next || buffer.next.lock() == next) {
+        return;
+    }
+    buffer.next = next;
+    buffer.vbo.bind();
+    for (size_t i = 0; i < buffer.count.size(); ++i) {
+        buffer.joined[ i ] = false;
+        auto column = next->column(i);
+        if (buffer.count[ i ] == 0 || !column) {
+            continue;
+        }
+        auto& samples = next->samples;
+        auto values = samples.values(*column);
+        for (size_t r = 0; r < samples.size(); ++r) {
+            if (std::isnan(values[ r ])) {
+                continue;
+            }
+            GLfloat vertex[ 2 ] = { static_cast< GLfloat >(
+                                        samples.time()[ r ] - tileBegin),
+                static_cast< GLfloat >(values[ r ]) };
+            auto index = buffer.first[ i ] + buffer.count[ i ];
+            buffer.vbo.write(static_cast< int >(index * 2 * sizeof(GLfloat)),
+                vertex, sizeof(vertex));
+            buffer.joined[ i ] = true;
+            break;
+        }
+    }
+    buffer.vbo.release();
+}
+
+void render::GlTraceRenderer::draw(
+    const FrameRenderer& frame, const Project& project, qreal devicePixelRatio)
+{
+    if (!this->_valid) {
+        return;
+    }
+    ++this->_frame;
+
+    auto& view = frame.view();
+    auto window = view.windowRect();
+    // Painter coordinates of the lower left corner (y axis pointing up)
+    double left = window.left();
+    double bottom = -(window.top() + window.height());
+    double scaleX = view.square.x() / view.time_per_square;
+    double scaleY = view.square.y() / view.value_per_square;
+
+    auto size = view.size * devicePixelRatio;
+    this->glViewport(0, 0, size.width(), size.height());
+    this->glDisable(GL_DEPTH_TEST);
+    this->glDisable(GL_SCISSOR_TEST);
+    this->glEnable(GL_BLEND);
+    this->glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    // Same width as the pen of the FrameRenderer, one device pixel
+    this->glLineWidth(static_cast< GLfloat >(devicePixelRatio));
+
+    this->_program.bind();
+    this->_program.setUniformValue(this->_window_location,
+        QVector2D(static_cast< float >(window.width()),
+            static_cast< float >(window.height())));
+    this->_program.enableAttributeArray(this->_sample_location);
+
+    auto resolution = view.drawResolution();
+    auto duration = TileLoader::tileDuration(resolution);
+    QRect area(QPoint(0, 0), view.size);
+    for (auto& m : project.measurements) {
+        bool anyVisible = false;
+        for (size_t i = 0; i < m->visible.size(); ++i) {
+            anyVisible |=
+                m->visible[ i ] && m->line_types[ i ] == LINE_TYPE::SOLID;
+        }
+        if (!anyVisible) {
+            continue;
+        }
+        auto sensorsSize = m->reader->sensors().size();
+
+        int64_t firstTile = 0;
+        auto tiles = frame.tiles(m, area, firstTile);
+        for (size_t t = 0; t < tiles.size(); ++t) {
+            auto& tile = tiles[ t ];
+            if (!tile) {
+                continue;
+            }
+            auto index = firstTile + int64_t(t);
+            double tileBegin = double(index) * duration;
+            // The tile identity is checked by buffer(), the channel mask is
+            // not needed in the key
+            auto& buffer = this->buffer({ m.get(), index, resolution, {} },
+                tile, tileBegin, sensorsSize);
+            buffer.frame = this->_frame;
+            this->join(buffer,
+                t + 1 < tiles.size() ? tiles[ t + 1 ] : nullptr, tileBegin);
+
+            buffer.vbo.bind();
+            this->_program.setAttributeBuffer(
+                this->_sample_location, GL_FLOAT, 0, 2);
+            for (size_t i = 0; i < sensorsSize && i < m->visible.size(); ++i) {
+                if (!m->visible[ i ] ||
+                    m->line_types[ i ] != LINE_TYPE::SOLID) {
+                    continue;
+                }
+                auto count = buffer.count[ i ] + (buffer.joined[ i ] ? 1 : 0);
+                if (count < 2) {
+                    continue;
+                }
+                // Offsets relative to the window in double precision, the
+                // vertices only hold the small tile relative values
+                double offsetX = (tileBegin + m->offsetX[ i ]) * scaleX - left;
+                double offsetY = m->offsetY[ i ] * scaleY - bottom;
+                // The unit factor only scales the values
+                this->_program.setUniformValue(this->_scale_location,
+                    QVector2D(static_cast< float >(scaleX),
+                        static_cast< float >(
+                            scaleY * double(m->unitFactor[ i ]))));
+                this->_program.setUniformValue(this->_offset_location,
+                    QVector2D(static_cast< float >(offsetX),
+                        static_cast< float >(offsetY)));
+                this->_program.setUniformValue(
+                    this->_color_location, m->color[ i ]);
+                this->glDrawArrays(GL_LINE_STRIP, buffer.first[ i ], count);
+            }
+            buffer.vbo.release();
+        }
+    }
+
+    this->_program.disableAttributeArray(this->_sample_location);
+    this->_program.release();
+
+    // Release buffers of evicted tiles and of tiles not drawn for a while
+    for (auto it = this->_buffers.begin(); it != this->_buffers.end();) {
+        if (it->second->tile.expired() ||
+            this->_frame - it->second->frame > KEEP_FRAMES) {
+            it->second->vbo.destroy();
+            it = this->_buffers.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
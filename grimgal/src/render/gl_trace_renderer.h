@@ -0,0 +1,105 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#ifndef RENDER_GLTRACERENDERER_H
+#define RENDER_GLTRACERENDERER_H
+
+// Qt
+#include <QOpenGLBuffer>
+#include <QOpenGLFunctions>
+#include <QOpenGLShaderProgram>
+
+// Own
+#include "data/project.h"
+#include "render/frame_renderer.h"
+#include "render/tile_cache.h"
+
+// StdLib
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace render {
+    // Draws the solid traces with OpenGL. The samples of each resident tile
+    // are M4-decimated (see util::m4_decimate()) in data units and uploaded
+    // once into a vertex buffer, position, scale and offsets are shader
+    // uniforms so panning and zooming never re-upload any data. Only
+    // needs OpenGL 2.0 (e.g. Mesa llvmpipe), if initialize() fails the
+    // traces stay with the FrameRenderer.
+    //
+    // All methods (including the destructor) require the context passed to
+    // initialize() to be current.
+    class GlTraceRenderer : protected QOpenGLFunctions {
+        public:
+        // Frames the buffer of a no longer drawn tile is kept
+        static constexpr uint64_t KEEP_FRAMES = 120;
+
+        private:
+        // Per sensor a run of (time - tile begin, value) vertices followed by
+        // one reserved vertex, the first sample of the next tile, which
+        // joins the line strips of adjacent tiles
+        struct Buffer {
+            std::weak_ptr< const Tile > tile;
+            std::weak_ptr< const Tile > next;
+            QOpenGLBuffer vbo;
+            std::vector< GLint > first;
+            std::vector< GLsizei > count;
+            std::vector< bool > joined;
+            uint64_t frame = 0;
+        };
+
+        QOpenGLShaderProgram _program;
+        bool _valid = false;
+        int _sample_location = -1;
+        int _scale_location = -1;
+        int _offset_location = -1;
+        int _window_location = -1;
+        int _color_location = -1;
+
+        std::map< TileKey, std::unique_ptr< Buffer > > _buffers;
+        uint64_t _frame = 0;
+
+        Buffer& buffer(const TileKey& key, std::shared_ptr< const Tile > tile,
+            double tileBegin, size_t sensors);
+        void join(Buffer& buffer, std::shared_ptr< const Tile > next,
+            double tileBegin);
+        void release();
+
+        public:
+        GlTraceRenderer() = default;
+        ~GlTraceRenderer();
+
+        // Compiles the shaders, returns false if the context is not
+        // sufficient
+        bool initialize();
+        bool isValid() const;
+
+        // Draws the visible solid traces of the frame, to be called between
+        // QPainter::beginNativePainting() and endNativePainting()
+        void draw(const FrameRenderer& frame, const Project& project,
+            qreal devicePixelRatio);
+    };
+}
+
+#endif // RENDER_GLTRACERENDERER_H
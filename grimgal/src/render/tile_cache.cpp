@@ -0,0 +1,163 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Qt
+
+// Own
+#include "render/tile_cache.h"
+
+// StdLib
+#include <algorithm>
+
+constexpr size_t render::TileCache::DEFAULT_CAPACITY;
+
+std::experimental::optional< size_t > render::Tile::column(
+    size_t sensor) const
+{
+    return this->samples.column(sensor);
+}
+
+size_t render::Tile::bytes() const
+{
+    return sizeof(Tile) + this->samples.bytes();
+}
+
+render::TileCache::TileCache(size_t capacity)
+    : _capacity(capacity)
+{
+}
+
+std::shared_ptr< const render::Tile > render::TileCache::get(
+    const TileKey& key)
+{
+    auto found = this->_index.find(key);
+    if (found == this->_index.end()) {
+        return nullptr;
+    }
+    // Move to front (most recently used)
+    this->_entries.splice(
+        this->_entries.begin(), this->_entries, found->second);
+    return found->second->tile;
+}
+
+std::shared_ptr< const render::Tile > render::TileCache::covering(
+    const TileKey& key)
+{
+    auto tile = this->get(key);
+    if (tile) {
+        return tile;
+    }
+
+    // All channel masks of the time range follow each other in the index
+    TileKey first = { key.measurement, key.index, key.resolution, {} };
+    for (auto it = this->_index.lower_bound(first);
+         it != this->_index.end() && it->first.measurement == key.measurement &&
+         it->first.index == key.index && it->first.resolution == key.resolution;
+         ++it) {
+        auto& channels = it->first.channels;
+        bool covers = true;
+        for (size_t i = 0; i < key.channels.size() && covers; ++i) {
+            covers = !key.channels[ i ] ||
+                     (i < channels.size() && channels[ i ]);
+        }
+        if (covers) {
+            this->_entries.splice(
+                this->_entries.begin(), this->_entries, it->second);
+            return it->second->tile;
+        }
+    }
+    return nullptr;
+}
+
+void render::TileCache::put(
+    const TileKey& key, std::shared_ptr< const Tile > tile)
+{
+    auto found = this->_index.find(key);
+    if (found != this->_index.end()) {
+        this->_bytes -= found->second->bytes;
+        this->_entries.erase(found->second);
+        this->_index.erase(found);
+    }
+    auto bytes = tile->bytes();
+    this->_bytes += bytes;
+    this->_entries.push_front({ key, tile, bytes });
+    this->_index[ key ] = this->_entries.begin();
+    this->evict();
+}
+
+void render::TileCache::remove(const Measurement* measurement)
+{
+    for (auto it = this->_entries.begin(); it != this->_entries.end();) {
+        if (it->key.measurement == measurement) {
+            this->_bytes -= it->bytes;
+            this->_index.erase(it->key);
+            it = this->_entries.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+void render::TileCache::removeIf(
+    std::function< bool(const TileKey&) > match)
+{
+    for (auto it = this->_entries.begin(); it != this->_entries.end();) {
+        if (match(it->key)) {
+            this->_bytes -= it->bytes;
+            this->_index.erase(it->key);
+            it = this->_entries.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+void render::TileCache::clear()
+{
+    this->_entries.clear();
+    this->_index.clear();
+    this->_bytes = 0;
+}
+
+size_t render::TileCache::bytes() const
+{
+    return this->_bytes;
+}
+
+size_t render::TileCache::size() const
+{
+    return this->_entries.size();
+}
+
+void render::TileCache::evict()
+{
+    // Always keep the most recent tile, even if it exceeds the budget alone
+    while (this->_bytes > this->_capacity && this->_entries.size() > 1) {
+        auto& last = this->_entries.back();
+        this->_bytes -= last.bytes;
+        this->_index.erase(last.key);
+        this->_entries.pop_back();
+    }
+}
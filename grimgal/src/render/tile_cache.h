@@ -0,0 +1,121 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#ifndef RENDER_TILECACHE_H
+#define RENDER_TILECACHE_H
+
+// Qt
+
+// Own
+#include "data/measurement.h"
+#include "data/sample_block.h"
+
+// StdLib
+#include <cstdint>
+#include <experimental/optional>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+namespace render {
+    // Sensors to load, indexed like Measurement::visible
+    typedef std::vector< bool > ChannelMask;
+
+    // Identifies the samples of one measurement in the time range
+    // [index * duration, (index + 1) * duration) at a given resolution,
+    // restricted to the sensors of the channel mask
+    struct TileKey {
+        const Measurement* measurement;
+        int64_t index;
+        int_fast32_t resolution;
+        ChannelMask channels;
+
+        bool operator<(const TileKey& other) const
+        {
+            return std::tie(this->measurement, this->index, this->resolution,
+                       this->channels) < std::tie(other.measurement,
+                                             other.index, other.resolution,
+                                             other.channels);
+        }
+    };
+
+    struct Tile {
+        // Columns of the loaded sensors only (NaN if a sample had no value)
+        SampleBlock samples;
+
+        // Column of sensor within the values (if loaded)
+        std::experimental::optional< size_t > column(size_t sensor) const;
+
+        // Approximate heap usage, used for the cache budget
+        size_t bytes() const;
+    };
+
+    // Least recently used cache of loaded tiles with a memory budget. Tiles
+    // of every measurement and resolution live side by side, so zooming back
+    // or panning over known ground never asks a reader again. Not thread
+    // safe, the owner has to serialise access.
+    class TileCache {
+        public:
+        // Default memory budget of all resident tiles
+        static constexpr size_t DEFAULT_CAPACITY = size_t(256) << 20;
+
+        private:
+        struct Entry {
+            TileKey key;
+            std::shared_ptr< const Tile > tile;
+            size_t bytes;
+        };
+
+        size_t _capacity;
+        size_t _bytes = 0;
+        // Most recently used entry first
+        std::list< Entry > _entries;
+        std::map< TileKey, std::list< Entry >::iterator > _index;
+
+        void evict();
+
+        public:
+        TileCache(size_t capacity = DEFAULT_CAPACITY);
+
+        // Returns the tile (and marks it as recently used) or nullptr
+        std::shared_ptr< const Tile > get(const TileKey& key);
+        // Like get(), but also accepts a tile of the same time range whose
+        // channels are a superset of the requested ones
+        std::shared_ptr< const Tile > covering(const TileKey& key);
+        void put(const TileKey& key, std::shared_ptr< const Tile > tile);
+
+        // Drops all tiles of one measurement
+        void remove(const Measurement* measurement);
+        // Drops every tile whose key matches
+        void removeIf(std::function< bool(const TileKey&) > match);
+        void clear();
+
+        size_t bytes() const;
+        size_t size() const;
+    };
+}
+
+#endif // RENDER_TILECACHE_H
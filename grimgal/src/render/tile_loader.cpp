@@ -0,0 +1,211 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Qt
+#include <QRunnable>
+#include <QThreadPool>
+
+// Own
+#include "data/sample_block.h"
+#include "render/tile_loader.h"
+
+// StdLib
+#include <algorithm>
+#include <functional>
+
+namespace {
+    class LoadTask : public QRunnable {
+        private:
+        std::function< void() > _task;
+
+        public:
+        LoadTask(std::function< void() > task)
+            : _task(task)
+        {
+        }
+
+        virtual void run() override
+        {
+            this->_task();
+        }
+    };
+}
+
+constexpr int_fast32_t render::TileLoader::TILE_SAMPLES;
+
+render::TileLoader::TileLoader(int threads, QObject* parent)
+    : QObject(parent)
+{
+    // Readers are not thread safe, a single thread serialises all requests
+    // unless the thread safe sources are read
+    this->_pool.setMaxThreadCount(std::max(threads, 1));
+}
+
+render::TileLoader::~TileLoader()
+{
+    this->_pool.clear();
+    this->_pool.waitForDone();
+}
+
+void render::TileLoader::setFrameStats(std::shared_ptr< FrameStats > stats)
+{
+    this->_stats = stats;
+}
+
+double render::TileLoader::tileDuration(int_fast32_t resolution)
+{
+    return double(TILE_SAMPLES) /
+           double(std::max(resolution, int_fast32_t(1)));
+}
+
+void render::TileLoader::beginFrame()
+{
+    this->_pool.clear();
+
+    std::lock_guard< std::mutex > lock(this->_mutex);
+    this->_queued.clear();
+}
+
+std::shared_ptr< const render::Tile > render::TileLoader::tile(
+    std::shared_ptr< Measurement > m, int64_t index, int_fast32_t resolution)
+{
+    TileKey key = { m.get(), index, resolution, m->visible };
+    std::vector< size_t > channels;
+    for (size_t i = 0; i < m->visible.size(); ++i) {
+        if (m->visible[ i ]) {
+            channels.push_back(i);
+        }
+    }
+
+    std::lock_guard< std::mutex > lock(this->_mutex);
+    auto tile = this->_cache.covering(key);
+    if (tile) {
+        return tile;
+    }
+    if (this->_queued.count(key) > 0 || this->_running.count(key) > 0) {
+        return nullptr;
+    }
+
+    this->_queued.insert(key);
+    auto generation = this->_generation[ key.measurement ];
+    auto reader = this->_pool.maxThreadCount() > 1 ? m->source : m->reader;
+    auto pyramid = m->pyramid;
+    this->_pool.start(
+        new LoadTask([this, key, channels, generation, reader, pyramid]() {
+            this->load(key, channels, generation, reader, pyramid);
+        }));
+    return nullptr;
+}
+
+void render::TileLoader::remove(const Measurement* measurement)
+{
+    std::lock_guard< std::mutex > lock(this->_mutex);
+    this->_cache.remove(measurement);
+    ++this->_generation[ measurement ];
+}
+
+void render::TileLoader::invalidate(
+    const Measurement* measurement, double time)
+{
+    std::lock_guard< std::mutex > lock(this->_mutex);
+    this->_cache.removeIf([measurement, time](const TileKey& key) {
+        auto end = double(key.index + 1) * tileDuration(key.resolution);
+        return key.measurement == measurement && end > time;
+    });
+    // Loads in flight may have read the old end, they are discarded
+    ++this->_generation[ measurement ];
+}
+
+void render::TileLoader::clear()
+{
+    this->_pool.clear();
+
+    std::lock_guard< std::mutex > lock(this->_mutex);
+    this->_cache.clear();
+    this->_queued.clear();
+    for (auto& generation : this->_generation) {
+        ++generation.second;
+    }
+}
+
+void render::TileLoader::load(TileKey key, std::vector< size_t > channels,
+    uint64_t generation,
+    std::shared_ptr< rlib::common::reader > reader,
+    std::shared_ptr< SamplePyramid > pyramid)
+{
+    {
+        std::lock_guard< std::mutex > lock(this->_mutex);
+        // Dropped by beginFrame() or clear() while waiting in the pool
+        if (this->_queued.erase(key) == 0) {
+            return;
+        }
+        this->_running.insert(key);
+    }
+
+    auto duration = tileDuration(key.resolution);
+    double begin = double(key.index) * duration;
+    double end = begin + duration;
+
+    std::experimental::optional< SampleBlock > data;
+    {
+        StageTimer timer(this->_stats.get(), FRAME_STAGE::SAMPLE_FETCH);
+        if (pyramid) {
+            data = pyramid->samples(begin, end, key.resolution, channels);
+        }
+        // Readers decode all sensors, only the requested ones are kept
+        if (!data) {
+            data = readSamples(*reader, begin, end, key.resolution, channels);
+        }
+    }
+
+    // Tiles are half open, otherwise borders would be drawn twice
+    auto tile = std::make_shared< Tile >();
+    tile->samples = std::move(*data);
+    tile->samples.crop(begin, end);
+
+    {
+        std::lock_guard< std::mutex > lock(this->_mutex);
+        this->_running.erase(key);
+        ++this->_finished;
+        this->_finished_changed.notify_all();
+        if (generation != this->_generation[ key.measurement ]) {
+            return;
+        }
+        this->_cache.put(key, tile);
+    }
+    emit this->tileLoaded();
+}
+
+uint64_t render::TileLoader::finishedLoads()
+{
+    std::lock_guard< std::mutex > lock(this->_mutex);
+    return this->_finished;
+}
+
+bool render::TileLoader::waitForLoads(
+    uint64_t finished, std::chrono::steady_clock::time_point deadline)
+{
+    std::unique_lock< std::mutex > lock(this->_mutex);
+    return this->_finished_changed.wait_until(lock, deadline,
+        [this, finished]() { return this->_finished > finished; });
+}
@@ -0,0 +1,124 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#ifndef RENDER_TILELOADER_H
+#define RENDER_TILELOADER_H
+
+// Qt
+#include <QObject>
+#include <QThreadPool>
+
+// Own
+#include "data/measurement.h"
+#include "render/frame_stats.h"
+#include "render/tile_cache.h"
+
+// StdLib
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+
+namespace render {
+    // Loads tiles on a background thread. The GUI thread only ever looks up
+    // resident tiles and never waits for a reader, tileLoaded() is emitted
+    // (and delivered queued) once a requested tile became resident. Callers
+    // without an event loop wait with waitForLoads() instead.
+    class TileLoader : public QObject {
+        Q_OBJECT
+
+        public:
+        // Number of samples (at the requested resolution) per tile
+        static constexpr int_fast32_t TILE_SAMPLES = 1024;
+
+        private:
+        QThreadPool _pool;
+
+        std::mutex _mutex;
+        TileCache _cache;
+        std::set< TileKey > _queued;
+        std::set< TileKey > _running;
+        // Loads finished so far, see waitForLoads()
+        uint64_t _finished = 0;
+        std::condition_variable _finished_changed;
+        // Bumped whenever the tiles of a measurement become invalid, loads
+        // started for an older generation are discarded
+        std::map< const Measurement*, uint64_t > _generation;
+
+        std::shared_ptr< FrameStats > _stats;
+
+        void load(TileKey key, std::vector< size_t > channels,
+            uint64_t generation,
+            std::shared_ptr< rlib::common::reader > reader,
+            std::shared_ptr< SamplePyramid > pyramid);
+
+        public:
+        // More than one thread reads Measurement::source, which is thread
+        // safe, instead of the (possibly caching) Measurement::reader
+        TileLoader(int threads = 1, QObject* parent = Q_NULLPTR);
+        virtual ~TileLoader();
+
+        // Reports the reader time to stats, must be set before the first tile
+        // is requested
+        void setFrameStats(std::shared_ptr< FrameStats > stats);
+
+        // Time covered by a single tile at the given resolution
+        static double tileDuration(int_fast32_t resolution);
+
+        // Drops all queued but not yet started requests, should be called
+        // once per frame before the visible tiles are requested again
+        void beginFrame();
+
+        // Returns the tile if it is resident, otherwise schedules it for
+        // loading (unless already scheduled) and returns nullptr. Only the
+        // visible sensors of m are loaded, a resident tile holding more
+        // sensors is returned as well.
+        std::shared_ptr< const Tile > tile(
+            std::shared_ptr< Measurement > m, int64_t index,
+            int_fast32_t resolution);
+
+        // Forgets the resident tiles of one measurement
+        void remove(const Measurement* measurement);
+        // Forgets the resident tiles of one measurement which end after
+        // time, the older ones stay valid. Used while a live measurement
+        // grows, only the tiles at its end have to be loaded again.
+        void invalidate(const Measurement* measurement, double time);
+        // Forgets all resident tiles, e.g. after the readers changed
+        void clear();
+
+        // Number of loads finished so far
+        uint64_t finishedLoads();
+        // Blocks until more than finished loads are done or the deadline
+        // passed, returns false in the latter case
+        bool waitForLoads(uint64_t finished,
+            std::chrono::steady_clock::time_point deadline);
+
+        signals:
+        void tileLoaded();
+    };
+}
+
+#endif // RENDER_TILELOADER_H
@@ -0,0 +1,90 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Qt
+#include <QPointF>
+#include <QVector>
+
+// Own
+#include "util/decimation.h"
+
+// StdLib
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+void util::m4_decimate(const QVector< QPointF >& polyline, qreal origin,
+    qreal columnWidth, QVector< QPointF >& result)
+{
+    result.clear();
+    if (polyline.size() <= 4 || columnWidth <= qreal(0)) {
+        result = polyline;
+        return;
+    }
+    result.reserve(std::min(polyline.size(),
+        4 * static_cast< int >(
+                std::ceil((polyline.last().x() - polyline.first().x()) /
+                          columnWidth) +
+                1)));
+
+    auto column = [&](const QPointF& p) {
+        return static_cast< long long >(
+            std::floor((p.x() - origin) / columnWidth));
+    };
+
+    int first = 0;
+    int min = 0;
+    int max = 0;
+    long long currentColumn = column(polyline[ 0 ]);
+
+    auto flush = [&](int last) {
+        std::array< int, 4 > indices = { { first, min, max, last } };
+        std::sort(indices.begin(), indices.end());
+        int previous = -1;
+        for (auto index : indices) {
+            if (index != previous) {
+                result.push_back(polyline[ index ]);
+                previous = index;
+            }
+        }
+    };
+
+    for (int i = 1; i < polyline.size(); ++i) {
+        auto c = column(polyline[ i ]);
+        if (c != currentColumn) {
+            flush(i - 1);
+            currentColumn = c;
+            first = i;
+            min = i;
+            max = i;
+            continue;
+        }
+        if (polyline[ i ].y() < polyline[ min ].y()) {
+            min = i;
+        }
+        if (polyline[ i ].y() > polyline[ max ].y()) {
+            max = i;
+        }
+    }
+    flush(polyline.size() - 1);
+}
@@ -0,0 +1,199 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Qt
+#include <QPointF>
+#include <QtGlobal>
+
+// Own
+#include "util/transform.h"
+
+// StdLib
+#include <cmath>
+#include <type_traits>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define UTIL_TRANSFORM_AVX2
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define UTIL_TRANSFORM_NEON
+#include <arm_neon.h>
+#endif
+
+namespace {
+    typedef size_t (*Kernel)(const util::ColumnTransform&, const double*,
+        const double*, size_t, QPointF*);
+
+    // The vector kernels store x and y pairwise straight into the points
+    constexpr bool POINTS_ARE_DOUBLES = std::is_same< qreal, double >::value &&
+                                        sizeof(QPointF) == 2 * sizeof(double);
+
+#ifdef UTIL_TRANSFORM_AVX2
+    __attribute__((target("avx2"))) size_t avx2(
+        const util::ColumnTransform& transform, const double* time,
+        const double* values, size_t rows, QPointF* points)
+    {
+        auto offsetX = _mm256_set1_pd(transform.offsetX);
+        auto xScale = _mm256_set1_pd(transform.xScale);
+        auto unitFactor = _mm256_set1_pd(transform.unitFactor);
+        auto offsetY = _mm256_set1_pd(transform.offsetY);
+        auto yScale = _mm256_set1_pd(transform.yScale);
+        auto out = reinterpret_cast< double* >(points);
+
+        size_t count = 0;
+        size_t r = 0;
+        for (; r + 4 <= rows; r += 4) {
+            auto value = _mm256_loadu_pd(values + r);
+            auto x = _mm256_mul_pd(
+                _mm256_add_pd(_mm256_loadu_pd(time + r), offsetX), xScale);
+            auto y = _mm256_mul_pd(
+                _mm256_add_pd(_mm256_mul_pd(value, unitFactor), offsetY),
+                yScale);
+            auto nan = _mm256_movemask_pd(
+                _mm256_cmp_pd(value, value, _CMP_UNORD_Q));
+            if (nan == 0) {
+                // x0 y0 x2 y2 and x1 y1 x3 y3 to x0 y0 x1 y1 and x2 y2 x3 y3
+                auto even = _mm256_unpacklo_pd(x, y);
+                auto odd = _mm256_unpackhi_pd(x, y);
+                _mm256_storeu_pd(
+                    out + 2 * count, _mm256_permute2f128_pd(even, odd, 0x20));
+                _mm256_storeu_pd(out + 2 * count + 4,
+                    _mm256_permute2f128_pd(even, odd, 0x31));
+                count += 4;
+                continue;
+            }
+            // Gaps are rare, the lanes are copied one by one
+            alignas(32) double xs[ 4 ];
+            alignas(32) double ys[ 4 ];
+            _mm256_store_pd(xs, x);
+            _mm256_store_pd(ys, y);
+            for (int lane = 0; lane < 4; ++lane) {
+                if (!(nan & (1 << lane))) {
+                    points[ count++ ] = QPointF(xs[ lane ], ys[ lane ]);
+                }
+            }
+        }
+        return count + util::transform_columns_scalar(transform, time + r,
+                           values + r, rows - r, points + count);
+    }
+#endif
+
+#ifdef UTIL_TRANSFORM_NEON
+    size_t neon(const util::ColumnTransform& transform, const double* time,
+        const double* values, size_t rows, QPointF* points)
+    {
+        auto offsetX = vdupq_n_f64(transform.offsetX);
+        auto xScale = vdupq_n_f64(transform.xScale);
+        auto unitFactor = vdupq_n_f64(transform.unitFactor);
+        auto offsetY = vdupq_n_f64(transform.offsetY);
+        auto yScale = vdupq_n_f64(transform.yScale);
+        auto out = reinterpret_cast< double* >(points);
+
+        size_t count = 0;
+        size_t r = 0;
+        for (; r + 2 <= rows; r += 2) {
+            auto value = vld1q_f64(values + r);
+            float64x2x2_t point;
+            point.val[ 0 ] =
+                vmulq_f64(vaddq_f64(vld1q_f64(time + r), offsetX), xScale);
+            point.val[ 1 ] = vmulq_f64(
+                vaddq_f64(vmulq_f64(value, unitFactor), offsetY), yScale);
+            // All ones in the lanes which are not NaN
+            auto valid = vceqq_f64(value, value);
+            if (vgetq_lane_u64(valid, 0) & vgetq_lane_u64(valid, 1)) {
+                vst2q_f64(out + 2 * count, point);
+                count += 2;
+                continue;
+            }
+            if (vgetq_lane_u64(valid, 0)) {
+                points[ count++ ] = QPointF(vgetq_lane_f64(point.val[ 0 ], 0),
+                    vgetq_lane_f64(point.val[ 1 ], 0));
+            }
+            if (vgetq_lane_u64(valid, 1)) {
+                points[ count++ ] = QPointF(vgetq_lane_f64(point.val[ 0 ], 1),
+                    vgetq_lane_f64(point.val[ 1 ], 1));
+            }
+        }
+        return count + util::transform_columns_scalar(transform, time + r,
+                           values + r, rows - r, points + count);
+    }
+#endif
+
+    struct Selected {
+        Kernel kernel;
+        const char* name;
+    };
+
+    Selected select()
+    {
+        if (!POINTS_ARE_DOUBLES) {
+            return { util::transform_columns_scalar, "scalar" };
+        }
+#if defined(UTIL_TRANSFORM_AVX2)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return { avx2, "avx2" };
+        }
+        return { util::transform_columns_scalar, "scalar" };
+#elif defined(UTIL_TRANSFORM_NEON)
+        // Part of every AArch64 CPU
+        return { neon, "neon" };
+#else
+        return { util::transform_columns_scalar, "scalar" };
+#endif
+    }
+
+    const Selected& selected()
+    {
+        static const Selected result = select();
+        return result;
+    }
+}
+
+size_t util::transform_columns(const ColumnTransform& transform,
+    const double* time, const double* values, size_t rows, QPointF* points)
+{
+    return selected().kernel(transform, time, values, rows, points);
+}
+
+size_t util::transform_columns_scalar(const ColumnTransform& transform,
+    const double* time, const double* values, size_t rows, QPointF* points)
+{
+    size_t count = 0;
+    for (size_t r = 0; r < rows; ++r) {
+        // Missing values are NaN
+        if (std::isnan(values[ r ])) {
+            continue;
+        }
+        points[ count++ ] = QPointF(
+            (time[ r ] + transform.offsetX) * transform.xScale,
+            (values[ r ] * transform.unitFactor + transform.offsetY) *
+                transform.yScale);
+    }
+    return count;
+}
+
+const char* util::transform_kernel()
+{
+    return selected().name;
+}
@@ -0,0 +1,64 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#ifndef UTIL_TRANSFORM_H
+#define UTIL_TRANSFORM_H
+
+// Qt
+#include <QPointF>
+
+// Own
+
+// StdLib
+#include <cstddef>
+
+namespace util {
+    // Maps the time and value column of a sensor to painter coordinates:
+    //   x = (time + offsetX) * xScale
+    //   y = (value * unitFactor + offsetY) * yScale
+    struct ColumnTransform {
+        double offsetX;
+        double xScale;
+        double unitFactor;
+        double offsetY;
+        double yScale;
+    };
+
+    // Writes a point for every row whose value is not NaN into points
+    // (which must have room for rows points) and returns their number. Uses
+    // AVX2 or NEON if the CPU has it, see transform_kernel().
+    size_t transform_columns(const ColumnTransform& transform,
+        const double* time, const double* values, size_t rows,
+        QPointF* points);
+
+    // The same as a plain loop, the reference for the vector kernels
+    size_t transform_columns_scalar(const ColumnTransform& transform,
+        const double* time, const double* values, size_t rows,
+        QPointF* points);
+
+    // Kernel transform_columns() uses on this CPU: "avx2", "neon" or
+    // "scalar"
+    const char* transform_kernel();
+}
+
+#endif // UTIL_TRANSFORM_H
@@ -22,27 +22,26 @@
  **/
 
 // Qt
-#include <QColor>
-#include <QLineF>
+#include <QImage>
+#include <QOpenGLContext>
 #include <QPainter>
-#include <QPen>
 #include <QPointF>
-#include <QVector>
+#include <QtGlobal>
 
 // Own
 #include "data/configuration.h"
-#include "util/number_format.h"
+#include "data/sample_block.h"
 #include "widget/customqglwidget.h"
 
 // StdLib
-#include <chrono>
+#include <algorithm>
 #include <cmath>
-#include <future>
-#include <tuple>
+#include <cstdlib>
+#include <experimental/optional>
+#include <iterator>
+#include <limits>
 
 // Macros
-#define MACRO_PEN_WIDTH() qreal(1.0) / qreal(this->_zoom)
-
 #define MACRO_TIME_TO_X(t) (((t) / this->_time_per_square) * this->_square.x())
 #define MACRO_X_TO_TIME(k)                                                     \
     (double(k) / double(this->_square.x()) * this->_time_per_square)
@@ -50,53 +49,129 @@
     ((-this->size().width() / (2.0 * this->_zoom)) + this->_center.x())
 #define MACRO_RIGHTWINDOW()                                                    \
     (this->size().width() / (2.0 * this->_zoom) + this->_center.x())
-#define MACRO_UPPERWINDOW()                                                    \
-    (this->size().height() / (2.0 * this->_zoom) + this->_center.y())
-#define MACRO_LOWERWINDOW()                                                    \
-    ((-this->size().height() / (2.0 * this->_zoom)) + this->_center.y())
 
 #define MACRO_LEFTBOUND() (MACRO_LEFTWINDOW() - this->_square.x())
 #define MACRO_RIGHTBOUND() (MACRO_RIGHTWINDOW() + this->_square.x())
-#define MACRO_UPPERBOUND() (MACRO_UPPERWINDOW() + this->_square.y())
-#define MACRO_LOWERBOUND() (MACRO_LOWERWINDOW() - this->_square.y())
 
 #define MACRO_LEFTBOUNDTIME()                                                  \
     (MACRO_LEFTBOUND() / this->_square.x()) * this->_time_per_square
 #define MACRO_RIGHTBOUNDTIME()                                                 \
     (MACRO_RIGHTBOUND() / this->_square.x()) * this->_time_per_square
 
-#define MACRO_CONFIG_QPAINTER(p)                                               \
-    {                                                                          \
-        QMatrix matrix;                                                        \
-        {                                                                      \
-            matrix.scale(1, -1);                                               \
-        }                                                                      \
-        p.setMatrix(matrix);                                                   \
-        p.setWindow((-this->size().width() / (2 * this->_zoom)) +              \
-                        static_cast< int >(this->_center.x()),                 \
-            (-this->size().height() / (2 * this->_zoom)) -                     \
-                static_cast< int >(this->_center.y()),                         \
-            this->size().width() / this->_zoom,                                \
-            this->size().height() / this->_zoom);                              \
+namespace {
+    // True if the reader of m keeps growing, e.g. a remote capture
+    bool isGrowing(const Measurement& m)
+    {
+        auto source = dynamic_cast< BlockSource* >(m.reader.get());
+        return source != nullptr && source->growing();
     }
+}
+
+constexpr int CustomQGLWidget::LIVE_INTERVAL;
 
 CustomQGLWidget::CustomQGLWidget(QWidget* parent, Qt::WindowFlags f)
     : QOpenGLWidget(parent, f)
+    , _frame_stats(std::make_shared< render::FrameStats >())
+    , _tile_loader(std::make_shared< render::TileLoader >())
+    , _renderer(_tile_loader)
 {
     this->setFocusPolicy(Qt::StrongFocus);
     this->setContextMenuPolicy(Qt::CustomContextMenu);
     this->setMouseTracking(true);
+
+    this->_tile_loader->setFrameStats(this->_frame_stats);
+    this->_renderer.setFrameStats(this->_frame_stats);
+    QObject::connect(this->_tile_loader.get(), &render::TileLoader::tileLoaded,
+        this, [this]() { this->invalidateLayer(); });
+
+    this->_live_timer.setInterval(LIVE_INTERVAL);
+    QObject::connect(&this->_live_timer, &QTimer::timeout, this,
+        [this]() { this->pollLive(); });
+}
+
+CustomQGLWidget::~CustomQGLWidget()
+{
+    this->releaseGl();
 }
 
 void CustomQGLWidget::setProject(std::shared_ptr< Project > project)
 {
     this->_project = project;
+    this->_renderer.setProject(project);
+    this->_probe_index_valid = false;
 }
 
 void CustomQGLWidget::setConfiguration(
     std::shared_ptr< Configuration > configuration)
 {
     this->_configuration = configuration;
+    this->_renderer.setConfiguration(configuration);
+}
+
+std::shared_ptr< render::FrameStats > CustomQGLWidget::frameStats()
+{
+    return this->_frame_stats;
+}
+
+void CustomQGLWidget::setShowFrameStats(bool show)
+{
+    this->_show_frame_stats = show;
+    this->update();
+}
+
+void CustomQGLWidget::setFollowLive(bool follow)
+{
+    this->_follow_live = follow;
+    if (follow) {
+        this->pollLive();
+    }
+}
+
+void CustomQGLWidget::pollLive()
+{
+    bool live = false;
+    bool changed = false;
+    std::experimental::optional< double > follow;
+    for (auto& m : this->_project->measurements) {
+        if (!isGrowing(*m)) {
+            continue;
+        }
+        live = true;
+        auto newest =
+            dynamic_cast< BlockSource* >(m->reader.get())->newest();
+        if (!newest) {
+            continue;
+        }
+        auto last = this->_live_newest.find(m.get());
+        if (last == this->_live_newest.end() || last->second != *newest) {
+            // Only the tiles behind the previous end can have changed
+            auto from = last == this->_live_newest.end()
+                            ? -std::numeric_limits< double >::infinity()
+                            : last->second;
+            this->_tile_loader->invalidate(m.get(), from);
+            this->_live_newest[ m.get() ] = *newest;
+            changed = true;
+        }
+        // Samples are drawn at (time + offsetX)
+        auto end = *newest;
+        if (!m->offsetX.empty()) {
+            end += *std::max_element(m->offsetX.begin(), m->offsetX.end());
+        }
+        follow = follow ? std::max(*follow, end) : end;
+    }
+    if (!live) {
+        this->_live_timer.stop();
+        return;
+    }
+    if (!changed) {
+        return;
+    }
+    if (this->_follow_live && follow) {
+        // Newest sample at the right border of the window
+        this->_center.rx() = MACRO_TIME_TO_X(*follow) -
+                             this->size().width() / (2.0 * this->_zoom);
+    }
+    this->invalidateLayer();
 }
 
 double CustomQGLWidget::centerAsTime()
@@ -106,11 +181,14 @@ double CustomQGLWidget::centerAsTime()
     return double(leftBoundTime / 2) + double(rightBoundTime / 2);
 }
 
+std::pair< double, double > CustomQGLWidget::timeWindow() const
+{
+    return this->_window;
+}
+
 int_fast32_t CustomQGLWidget::drawResolution()
 {
-    return static_cast< int_fast32_t >(
-               std::ceil(this->_square.x() / this->_time_per_square)) *
-           2;
+    return this->view().drawResolution();
 }
 
 void CustomQGLWidget::goTo(double time)
@@ -122,66 +200,121 @@ void CustomQGLWidget::goTo(double time)
 void CustomQGLWidget::addedMeasurement(
     std::shared_ptr< Measurement > m, size_t index)
 {
-    this->drawMeasurement(m, MACRO_PEN_WIDTH());
+    if (isGrowing(*m)) {
+        this->_live_timer.start();
+    }
+    this->invalidateLayer();
 }
 void CustomQGLWidget::updatedMeasurement(
     std::shared_ptr< Measurement > m, size_t index)
 {
-    this->update();
+    this->invalidateLayer();
 }
 void CustomQGLWidget::removedMeasurement(
     std::shared_ptr< Measurement > m, size_t index)
 {
-    this->update();
+    this->_tile_loader->remove(m.get());
+    this->_live_newest.erase(m.get());
+    this->invalidateLayer();
 }
 
 void CustomQGLWidget::updatedProject()
 {
-    this->update();
+    // Readers may have been replaced (e.g. Settings->Use cached reader)
+    this->_tile_loader->clear();
+    this->_live_newest.clear();
+    for (auto& m : this->_project->measurements) {
+        if (isGrowing(*m)) {
+            this->_live_timer.start();
+        }
+    }
+    this->_probe_index_valid = false;
+    this->invalidateLayer();
 }
 
 void CustomQGLWidget::addedProbe(std::shared_ptr< Probe > p, size_t index)
 {
-    this->drawProbe(p, "Probe " + QString::number(index), MACRO_PEN_WIDTH());
+    this->_probe_index_valid = false;
+    this->update();
 }
 void CustomQGLWidget::updatedProbe(std::shared_ptr< Probe > p, size_t index)
 {
+    this->_probe_index_valid = false;
     this->update();
 }
 void CustomQGLWidget::removedProbe(std::shared_ptr< Probe > p, size_t index)
 {
+    this->_probe_index_valid = false;
     this->update();
 }
 
 void CustomQGLWidget::initializeGL()
 {
+    auto renderer = std::make_unique< render::GlTraceRenderer >();
+    if (renderer->initialize()) {
+        this->_gl_renderer = std::move(renderer);
+    }
+    else {
+        qWarning("OpenGL trace renderer not available, using QPainter");
+    }
+    // The context is recreated e.g. when the widget is reparented
+    QObject::connect(this->context(), &QOpenGLContext::aboutToBeDestroyed,
+        this, [this]() { this->releaseGl(); });
 }
 
-void CustomQGLWidget::paintGL()
+void CustomQGLWidget::releaseGl()
 {
-    qreal penWidth = MACRO_PEN_WIDTH();
+    if (this->_gl_renderer) {
+        this->makeCurrent();
+        this->_gl_renderer.reset();
+        this->doneCurrent();
+    }
+}
 
-    // Draw Background
-    QPainter painter(this);
-    painter.fillRect(0, 0, this->size().width(), this->size().height(),
-        this->_configuration->color[ COLOR_CFG::BACKGROUND ]);
+void CustomQGLWidget::paintGL()
+{
+    bool gl = this->_gl_renderer && this->_configuration->_use_gl_renderer;
+    this->_renderer.setView(this->view());
+    this->_renderer.setDrawSolidTraces(!gl);
 
-    // Draw Grid
-    this->drawGrid(penWidth);
+    QPainter painter;
+    {
+        render::StageTimer timer(
+            this->_frame_stats.get(), render::FRAME_STAGE::FRAME);
+
+        // Draw Background, Grid and Values (retained between frames)
+        this->_tile_loader->beginFrame();
+        this->updateLayer();
+
+        painter.begin(this);
+        painter.drawImage(0, 0, this->_layer);
+
+        // Draw Solid Traces (OpenGL)
+        if (gl) {
+            render::StageTimer glTimer(
+                this->_frame_stats.get(), render::FRAME_STAGE::GL_TRACES);
+            painter.beginNativePainting();
+            this->_gl_renderer->draw(
+                this->_renderer, *this->_project, this->devicePixelRatioF());
+            painter.endNativePainting();
+        }
 
-    // Draw Probes
-    int i = 0;
-    for (auto& probe : this->_project->probes) {
-        this->drawProbe(
-            probe, QObject::tr("Probe ") + QString::number(i++), penWidth);
+        // Draw Probes, Grid Labels and Hover
+        this->_hover =
+            this->_renderer.drawOverlay(painter, this->_mouse_last_position);
     }
+    this->_frame_stats->endFrame();
 
-    // Draw Grid Labels (X/Y)
-    this->drawGridLables(penWidth);
-
-    // Draw Values
-    for (auto& m : this->_project->measurements) {
-        this->drawMeasurement(m, penWidth);
+    // Draw Frame Timing
+    if (this->_show_frame_stats) {
+        this->_renderer.drawStats(painter);
+    }
+    auto view = this->view();
+    std::pair< double, double > window(view.xToTime(view.leftWindow()),
+        view.xToTime(view.rightWindow()));
+    if (window != this->_window) {
+        this->_window = window;
+        emit this->windowChanged(window.first, window.second);
     }
 }
 
@@ -357,17 +490,11 @@ void CustomQGLWidget::mouseMoveEvent(QMouseEvent* event)
         this->_mouse_button_last_position.insert(Qt::LeftButton, event->pos());
     }
 
-    if (this->_mouse_mode == MouseMode::NO_MODE) {
-        bool aboveProbe = false;
-        auto mouseXPos = MACRO_LEFTWINDOW() + event->pos().x();
-        for (auto& probe : this->_project->probes) {
-            auto probeTime = probe->time;
-            if (fabs(mouseXPos - MACRO_TIME_TO_X(probeTime)) < 3) {
-                aboveProbe = true;
-                break;
-            }
-        }
+    this->_mouse_last_position.rx() = event->pos().x();
+    this->_mouse_last_position.ry() = event->pos().y();
 
+    if (this->_mouse_mode == MouseMode::NO_MODE) {
+        bool aboveProbe = this->probeAt(event->pos().x()) != nullptr;
         if (aboveProbe) {
             if (this->cursor().shape() != Qt::SizeHorCursor) {
                 QCursor curser;
@@ -382,10 +509,13 @@ void CustomQGLWidget::mouseMoveEvent(QMouseEvent* event)
                 this->setCursor(curser);
             }
         }
-    }
 
-    this->_mouse_last_position.rx() = event->pos().x();
-    this->_mouse_last_position.ry() = event->pos().y();
+        // Only the hover overlay can change, repaint if it does
+        this->_renderer.setView(this->view());
+        if (this->_renderer.hover(this->_mouse_last_position) == this->_hover) {
+            return;
+        }
+    }
     this->update();
 }
 
@@ -393,15 +523,10 @@ void CustomQGLWidget::mousePressEvent(QMouseEvent* event)
 {
     this->_mouse_button_last_position.insert(event->button(), event->pos());
     if (event->button() == Qt::LeftButton) {
-        auto mouseXPos = MACRO_LEFTWINDOW() + event->pos().x();
-        bool aboveProbe = false;
-        for (auto& probe : this->_project->probes) {
-            auto probeTime = probe->time;
-            if (std::fabs(mouseXPos - MACRO_TIME_TO_X(probeTime)) < 3) {
-                this->_selected_probe = probe;
-                aboveProbe = true;
-                break;
-            }
+        auto probe = this->probeAt(event->pos().x());
+        bool aboveProbe = probe != nullptr;
+        if (aboveProbe) {
+            this->_selected_probe = probe;
         }
         QCursor curser;
         if (aboveProbe) {
@@ -427,292 +552,142 @@ void CustomQGLWidget::mouseReleaseEvent(QMouseEvent* event)
     }
 }
 
-void CustomQGLWidget::drawMeasurement(
-    std::shared_ptr< Measurement > m, qreal penWidth, QPointF offset)
+render::View CustomQGLWidget::view()
 {
-    bool redrawAgain = false;
-    bool anyVisible = false;
-    for (const auto visible : m->visible) {
-        anyVisible |= visible;
-    }
-    if (!anyVisible) {
-        return;
-    }
-    double leftBoundTime = MACRO_LEFTBOUNDTIME();
-    double rightBoundTime = MACRO_RIGHTBOUNDTIME();
-    auto offsetX = std::minmax_element(m->offsetX.begin(), m->offsetX.end());
-    double minOffsetX = *offsetX.first;
-    double maxOffsetX = *offsetX.second;
-
-    auto mouseXPos = MACRO_LEFTWINDOW() + this->_mouse_last_position.x();
-    auto mouseYPos = MACRO_UPPERWINDOW() - this->_mouse_last_position.y();
-    double begin = leftBoundTime + minOffsetX;
-    double end = rightBoundTime + maxOffsetX;
-    if (end < 0) {
-        return;
-    }
-    auto valuePerSquareScale = (qreal(1) / this->_value_per_square);
-    int_fast32_t resolution = this->drawResolution();
+    render::View view;
+    {
+        view.size = this->size();
+        view.center = this->_center;
+        view.square = this->_square;
+        view.time_per_square = this->_time_per_square;
+        view.zoom = this->_zoom;
+        view.value_per_square = this->_value_per_square;
+    }
+    return view;
+}
 
-    std::future< std::vector< rlib::common::sample > > datumFuture =
-        std::async(std::launch::async, [&]() {
-            // Load Data from Reader
-            auto data = m->reader->samples(begin - 1.0, end + 1.0, resolution);
-            return data;
+std::shared_ptr< Probe > CustomQGLWidget::probeAt(int x)
+{
+    if (!this->_probe_index_valid) {
+        this->_probe_index = this->_project->probes;
+        std::sort(this->_probe_index.begin(), this->_probe_index.end(),
+            [](const std::shared_ptr< Probe >& a,
+                const std::shared_ptr< Probe >& b) {
+                return a->time < b->time;
+            });
+        this->_probe_index_valid = true;
+    }
+
+    auto mouseXPos = MACRO_LEFTWINDOW() + x;
+    double time = MACRO_X_TO_TIME(mouseXPos);
+    auto it = std::lower_bound(this->_probe_index.begin(),
+        this->_probe_index.end(), time,
+        [](const std::shared_ptr< Probe >& probe, double t) {
+            return probe->time < t;
         });
-    std::future_status datumStatus =
-        datumFuture.wait_for(std::chrono::microseconds(10000));
-    if (datumStatus == std::future_status::ready) {
-        this->_datum_cache = datumFuture.get();
-    }
-    else {
-        // TODO: Draw load information
-        redrawAgain = true;
-    }
-    auto data = this->_datum_cache;
 
-    auto yTimesValuePerScale = this->_square.y() * valuePerSquareScale;
-
-    auto sensors = m->reader->sensors();
-    auto sensorsSize = sensors.size();
-    for (size_t i = 0; i < sensorsSize; ++i) {
-        if (!m->visible.at(i)) {
-            continue;
+    // Closest of the neighbours
+    std::shared_ptr< Probe > result;
+    double distance = 3;
+    auto check = [&](const std::shared_ptr< Probe >& probe) {
+        auto dx = std::fabs(mouseXPos - MACRO_TIME_TO_X(probe->time));
+        if (dx < distance) {
+            distance = dx;
+            result = probe;
         }
-        QVector< QPointF > polyline;
-        QPointF circle;
-        double circleTime = 0.0;
-        double circleValue = 0.0;
-        bool drawCircle = false;
-        for (auto& datum : data) {
-            // HOTFIX: Somewhere in the codebasis is an error in which case
-            // datum.values.size() != sensorsSize!!!
-            if (datum.values.size() <= i) {
-                continue;
-            }
-
-            double xTime = datum.time + m->offsetX.at(i);
-            double x = MACRO_TIME_TO_X(xTime);
-            double y = 0.0; //(datum.values.at(i) + m->offsetY.at(i)) *
-                            // yTimesValuePerScale;
-            {
-                y += datum.values.at(i);
-                y += m->offsetY.at(i);
-                y *= yTimesValuePerScale;
-            }
-            if (fabs(x - mouseXPos) < 3 && fabs(y - mouseYPos) < 3) {
-                circleTime = xTime;
-                circleValue = datum.values.at(i) + m->offsetY.at(i);
-                drawCircle = true;
-                circle = QPointF(x, y);
-            }
-            QPointF p(x + offset.x(), y + offset.y());
-            polyline.push_back(p);
-        }
-        if (!polyline.isEmpty()) {
-            QPainter painter(this);
-            MACRO_CONFIG_QPAINTER(painter);
-            QPen pen(m->color.at(i), penWidth);
-            if (m->line_types[ i ] == LINE_TYPE::DASHED) {
-                pen.setStyle(Qt::DashLine);
-            }
-            else if (m->line_types[ i ] == LINE_TYPE::SOLID) {
-                pen.setStyle(Qt::SolidLine);
-            }
-            painter.setPen(pen);
-            painter.drawPolyline(polyline.data(), polyline.size());
-            if (drawCircle) {
-                painter.drawEllipse(circle, qreal(5), qreal(5));
-
-                painter.setFont(QFont("Arial", 9, QFont::Bold));
-                painter.setWorldMatrixEnabled(false);
-                auto point = circle;
-                {
-                    point.rx() += 10;
-                    point.ry() = -point.y() - 10;
-                }
-                painter.drawText(point,
-                    "Time:" + util::format_time(circleTime) + " Value:" +
-                        util::format_number(circleValue,
-                            QString::fromStdString(sensors[ i ].unit)));
-                painter.setWorldMatrixEnabled(true);
-            }
-        }
-    }
-
-    // Draw Events
-    std::future< std::vector< rlib::common::event_data > > eventFuture =
-        std::async(std::launch::async, [&]() {
-            // Load Data from Reader
-            return m->reader->events(begin - 1.0, end + 1.0);
-        });
-    std::future_status eventStatus =
-        eventFuture.wait_for(std::chrono::microseconds(1000));
-    if (eventStatus == std::future_status::ready) {
-        this->_event_cache = eventFuture.get();
-    }
-    else {
-        // TODO: Draw load information
-        redrawAgain = true;
-    }
-    auto events = this->_event_cache;
-
-    for (auto& event : events) {
-        this->drawEvent(m, event, penWidth);
+    };
+    if (it != this->_probe_index.end()) {
+        check(*it);
     }
-    if (redrawAgain) {
-        // this->update();
+    if (it != this->_probe_index.begin()) {
+        check(*std::prev(it));
     }
+    return result;
 }
 
-void CustomQGLWidget::drawProbe(
-    std::shared_ptr< Probe > p, QString lable, qreal penWidth, QPointF offset)
+bool CustomQGLWidget::LayerState::operator==(const LayerState& other) const
 {
-    QPainter painter(this);
-    MACRO_CONFIG_QPAINTER(painter);
-
-    qreal leftBound = MACRO_LEFTBOUND();
-    qreal rightBound = MACRO_RIGHTBOUND();
-    qreal upperBound = MACRO_UPPERBOUND();
-    qreal lowerBound = MACRO_LOWERBOUND();
-
-    QPen probePen(this->_configuration->color[ COLOR_CFG::PROBE ], penWidth);
-    QPen fontPan(
-        this->_configuration->color[ COLOR_CFG::DEFAULT_FONT_COLOR ], penWidth);
-
-    painter.setPen(probePen);
-    auto xpos = (p->time / this->_time_per_square) * this->_square.x();
-    QPointF p1(xpos, upperBound);
-    QPointF p2(xpos, lowerBound);
-    painter.drawLine(p1, p2);
-
-    painter.setPen(fontPan);
-    painter.setFont(QFont("Arial", 9, QFont::Bold));
-    painter.setWorldMatrixEnabled(false);
-    QPointF point(xpos + 5 + offset.x(),
-        -MACRO_UPPERWINDOW() + double(1.8) * this->_square.y() + offset.y());
-    painter.drawText(point, lable);
-    painter.setWorldMatrixEnabled(true);
+    return this->size == other.size &&
+           this->devicePixelRatio == other.devicePixelRatio &&
+           this->zoom == other.zoom && this->square == other.square &&
+           this->time_per_square == other.time_per_square &&
+           this->value_per_square == other.value_per_square &&
+           this->color == other.color &&
+           this->solid_traces == other.solid_traces;
 }
 
-void CustomQGLWidget::drawEvent(std::shared_ptr< Measurement > m,
-    rlib::common::event_data& e, qreal penWidth, QPointF offset)
+void CustomQGLWidget::invalidateLayer()
 {
-    QPainter painter(this);
-    MACRO_CONFIG_QPAINTER(painter);
-    auto eventTime = e.time;
-    QPen pen(this->_configuration->color[ COLOR_CFG::EVENT ], penWidth);
-    if (e.origin >= 0) {
-        pen.setColor(m->color.at(static_cast< size_t >(e.origin)));
-        eventTime += m->offsetX.at(static_cast< size_t >(e.origin));
-    }
-    painter.setPen(pen);
-    auto xpos = MACRO_TIME_TO_X(eventTime);
-    QPointF p1(xpos + offset.x(), MACRO_UPPERBOUND() + offset.y());
-    QPointF p2(xpos + offset.x(), MACRO_LOWERBOUND() + offset.y());
-    painter.drawLine(p1, p2);
-}
-
-void CustomQGLWidget::drawGrid(qreal penWidth, QPointF offset)
-{
-    QPainter painter(this);
-    MACRO_CONFIG_QPAINTER(painter);
-
-    // Build Grid
-    QPen gridPen(this->_configuration->color[ COLOR_CFG::GRID ], penWidth);
-    QVector< QLineF > lines;
-    qreal leftBound = MACRO_LEFTBOUND();
-    qreal rightBound = MACRO_RIGHTBOUND();
-    qreal upperBound = MACRO_UPPERBOUND();
-    qreal lowerBound = MACRO_LOWERBOUND();
-
-    for (int i =
-             static_cast< int >(std::ceil(upperBound / this->_square.y())) + 1;
-         i * this->_square.y() > lowerBound; --i) {
-        QLineF line(leftBound, i * this->_square.y(), rightBound,
-            i * this->_square.y());
-        lines.push_back(line);
-    }
-
-    for (int i =
-             static_cast< int >(std::ceil(rightBound / this->_square.x())) + 1;
-         i * this->_square.y() > leftBound; --i) {
-        QLineF line(i * this->_square.x(), upperBound, i * this->_square.x(),
-            lowerBound);
-        lines.push_back(line);
-    }
-
-    // Draw Grid
-    painter.setPen(gridPen);
-    painter.drawLines(lines);
-
-    // Draw Middleline (if visible)
-    if (lowerBound < 0.0 && upperBound > 0.0) {
-        QPen middleLinePen(
-            this->_configuration->color[ COLOR_CFG::ZERO_LINE ], penWidth);
-        painter.setPen(middleLinePen);
-        QPointF p1(leftBound + offset.x(), 0.0 + offset.y());
-        QPointF p2(rightBound + offset.x(), 0.0 + offset.y());
-        painter.drawLine(p1, p2);
-    }
+    this->_layer_valid = false;
+    this->update();
 }
 
-void CustomQGLWidget::drawGridLables(qreal penWidth, QPointF offset)
+void CustomQGLWidget::updateLayer()
 {
-    qreal leftBound = MACRO_LEFTBOUND();
-    qreal rightBound = MACRO_RIGHTBOUND();
-    qreal upperBound = MACRO_UPPERBOUND();
-    qreal lowerBound = MACRO_LOWERBOUND();
-
-    QPainter painter(this);
-    MACRO_CONFIG_QPAINTER(painter);
-    {
-        painter.setPen(
-            { this->_configuration->color[ COLOR_CFG::DEFAULT_FONT_COLOR ],
-                penWidth });
-        painter.setFont(this->_configuration->font[ FONT_CFG::DEFAULT_FONT ]);
-    }
-
-    QVector< std::tuple< QPointF, QString > > labels;
-
-    // Collect Labels (Y)
-    for (int i =
-             static_cast< int >(std::ceil(upperBound / this->_square.y())) + 1;
-         i * this->_square.y() > lowerBound; --i) {
-        // Note! Y-Axis is inverted manualy here to prevent text flip!
-        auto point =
-            QPointF(leftBound + double(1.1) * this->_square.x() + offset.x(),
-                -i * this->_square.y() + offset.y());
-        QString string;
-        if (i % 2 != 0) {
-            string = util::format_number(
-                static_cast< double >(i) *
-                static_cast< double >(this->_value_per_square));
+    LayerState state = { this->size(), this->devicePixelRatioF(), this->_zoom,
+        this->_square, this->_time_per_square, this->_value_per_square,
+        this->_configuration->color, this->_renderer.drawSolidTraces() };
+    QPoint center(static_cast< int >(this->_center.x()),
+        static_cast< int >(this->_center.y()));
+    int width = state.size.width();
+    int height = state.size.height();
+    auto& view = this->_renderer.view();
+
+    // Shift of the content (in widget pixels) since the layer was rendered
+    bool reuse = this->_layer_valid && state == this->_layer_state;
+    int dx = 0;
+    int dy = 0;
+    if (reuse) {
+        qreal shiftX =
+            qreal(center.x() - this->_layer_center.x()) / view.pixelWidth();
+        qreal shiftY =
+            qreal(center.y() - this->_layer_center.y()) / view.pixelHeight();
+        dx = qRound(shiftX);
+        dy = qRound(shiftY);
+        // Only whole pixel shifts keep the pixel grid of the old image
+        reuse = qFuzzyCompare(qreal(1) + shiftX, qreal(1) + qreal(dx)) &&
+                qFuzzyCompare(qreal(1) + shiftY, qreal(1) + qreal(dy)) &&
+                std::abs(dx) < width && std::abs(dy) < height;
+    }
+
+    if (!reuse || dx != 0 || dy != 0) {
+        QImage image(state.size * state.devicePixelRatio,
+            QImage::Format_ARGB32_Premultiplied);
+        image.setDevicePixelRatio(state.devicePixelRatio);
+        if (!reuse) {
+            this->renderLayer(&image, QRect(0, 0, width, height));
         }
-        labels.push_back({ point, string });
-    }
-    // Collect Labels (X)
-    for (int i =
-             static_cast< int >(std::ceil(rightBound / this->_square.x())) + 1;
-         i * this->_square.y() > leftBound; --i) {
-        // Note! Y-Axis is inverted manualy here to prevent text flip!
-        auto point = QPointF(i * this->_square.x() + offset.y(),
-            -lowerBound - double(1.1) * this->_square.y() + offset.y());
-        double time = (i * this->_square.x() * this->_time_per_square) /
-                      this->_square.y();
-        QString string;
-        if (i % 4 == 0) {
-            string = util::format_time(time);
+        else {
+            {
+                QPainter painter(&image);
+                painter.setCompositionMode(QPainter::CompositionMode_Source);
+                painter.drawImage(-dx, dy, this->_layer);
+            }
+            // Rasterise only the newly exposed strips
+            if (dx > 0) {
+                this->renderLayer(
+                    &image, QRect(width - dx, 0, dx, height));
+            }
+            if (dx < 0) {
+                this->renderLayer(&image, QRect(0, 0, -dx, height));
+            }
+            if (dy > 0) {
+                this->renderLayer(&image, QRect(0, 0, width, dy));
+            }
+            if (dy < 0) {
+                this->renderLayer(
+                    &image, QRect(0, height + dy, width, -dy));
+            }
         }
-        labels.push_back({ point, string });
+        this->_layer = image;
     }
+    this->_layer_state = state;
+    this->_layer_center = center;
+    this->_layer_valid = true;
+}
 
-    // Draw Labels
-    painter.setWorldMatrixEnabled(false);
-    for (auto& label : labels) {
-        auto point = std::get< QPointF >(label);
-        auto string = std::get< QString >(label);
-        painter.drawText(point, string);
-    }
-    painter.setWorldMatrixEnabled(true);
+void CustomQGLWidget::renderLayer(QPaintDevice* device, const QRect& area)
+{
+    QPainter painter(device);
+    this->_renderer.drawLayer(painter, area);
 }
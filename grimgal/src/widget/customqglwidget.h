@@ -25,15 +25,19 @@
 #define CUSTOMQGLWIDGET_H
 
 // Qt
+#include <QColor>
+#include <QImage>
 #include <QKeyEvent>
 #include <QMap>
 #include <QMouseEvent>
 #include <QOpenGLWidget>
 #include <QPainter>
 #include <QPair>
-#include <QPen>
 #include <QPoint>
+#include <QRect>
 #include <QSet>
+#include <QSize>
+#include <QTimer>
 #include <QWheelEvent>
 
 // Own
@@ -41,12 +45,20 @@
 #include "data/measurement.h"
 #include "data/probe.h"
 #include "data/project.h"
+#include "render/frame_renderer.h"
+#include "render/frame_stats.h"
+#include "render/gl_trace_renderer.h"
+#include "render/tile_loader.h"
 #include <rlib/common/event_data.h>
 #include <rlib/common/sample.h>
 
 // StdLib
+#include <cstdint>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <utility>
+#include <vector>
 
 enum MouseMode { NO_MODE, MOVE_PROBE, MOVE_COORD };
 
@@ -69,19 +81,65 @@ class CustomQGLWidget : public QOpenGLWidget {
     MouseMode _mouse_mode = MouseMode::NO_MODE;
     std::shared_ptr< Probe > _selected_probe;
 
-    std::vector< rlib::common::sample > _datum_cache;
-    std::vector< rlib::common::event_data > _event_cache;
+    // Probes sorted by time, rebuilt on the next lookup after a change
+    std::vector< std::shared_ptr< Probe > > _probe_index;
+    bool _probe_index_valid = false;
+
+    // Visible time window of the last frame, see windowChanged()
+    std::pair< double, double > _window;
+
+    // Samples under the mouse as drawn by the last frame
+    std::vector< render::HoverHit > _hover;
+
+    std::shared_ptr< render::FrameStats > _frame_stats;
+    bool _show_frame_stats = false;
+
+    // Newest sample time of each live measurement at the last poll, see
+    // pollLive()
+    std::map< const Measurement*, double > _live_newest;
+    QTimer _live_timer;
+    bool _follow_live = true;
+
+    std::shared_ptr< render::TileLoader > _tile_loader;
+    render::FrameRenderer _renderer;
+    // Only set if the context supports it, see initializeGL()
+    std::unique_ptr< render::GlTraceRenderer > _gl_renderer;
+
+    // View parameters the retained layer was rendered with, any change
+    // except of the center requires a full redraw
+    struct LayerState {
+        QSize size;
+        qreal devicePixelRatio;
+        int zoom;
+        QPointF square;
+        qreal time_per_square;
+        qreal value_per_square;
+        std::map< COLOR_CFG, QColor > color;
+        bool solid_traces;
+
+        bool operator==(const LayerState& other) const;
+    };
+
+    // Background, grid, values and events, blitted with an offset while
+    // panning so only the newly exposed strips have to be rendered
+    QImage _layer;
+    LayerState _layer_state;
+    QPoint _layer_center;
+    bool _layer_valid = false;
 
     private:
-    void drawMeasurement(std::shared_ptr< Measurement > m, qreal penWidth,
-        QPointF offset = QPointF(0.0, 0.0));
-    void drawProbe(std::shared_ptr< Probe > p, QString lable, qreal penWidth,
-        QPointF offset = QPointF(0.0, 0.0));
-    void drawEvent(std::shared_ptr< Measurement > m,
-        rlib::common::event_data& e, qreal penWidth,
-        QPointF offset = QPointF(0.0, 0.0));
-    void drawGrid(qreal penWidth, QPointF offset = QPointF(0.0, 0.0));
-    void drawGridLables(qreal penWidth, QPointF offset = QPointF(0.0, 0.0));
+    render::View view();
+    // Probe within 3 pixel of the widget x position (if any)
+    std::shared_ptr< Probe > probeAt(int x);
+    void releaseGl();
+
+    // Reloads the end of live measurements which received new samples and
+    // keeps their newest sample at the right border if following
+    void pollLive();
+
+    void invalidateLayer();
+    void updateLayer();
+    void renderLayer(QPaintDevice* device, const QRect& area);
 
     protected:
     virtual void initializeGL() override final;
@@ -95,18 +153,32 @@ class CustomQGLWidget : public QOpenGLWidget {
     virtual void mouseReleaseEvent(QMouseEvent* event) override final;
 
     public:
+    // Interval at which live measurements are checked for new samples
+    static constexpr int LIVE_INTERVAL = 100;
+
     CustomQGLWidget(
         QWidget* parent = Q_NULLPTR, Qt::WindowFlags f = Qt::WindowFlags());
-    ~CustomQGLWidget() = default;
+    ~CustomQGLWidget();
 
     void setProject(std::shared_ptr< Project > project);
     void setConfiguration(std::shared_ptr< Configuration > configuration);
 
+    // Stage times of paintGL, optionally shown as overlay
+    std::shared_ptr< render::FrameStats > frameStats();
+    void setShowFrameStats(bool show);
+    // Whether the view scrolls along with live measurements
+    void setFollowLive(bool follow);
+
     double centerAsTime();
+    // Visible time window of the last frame
+    std::pair< double, double > timeWindow() const;
     int_fast32_t drawResolution();
 
     signals:
     void resolutionChanged(int_fast32_t newResolution);
+    // Emitted after a frame whose visible time window differs from the
+    // previous one, whatever moved it (pan, zoom, resize or goTo)
+    void windowChanged(double begin, double end);
 
     public slots:
     void goTo(double time);